@@ -708,6 +708,7 @@ static void CG_BuildableParticleEffects( centity_t *cent )
     if( healthFrac < 0.33f && !CG_IsParticleSystemValid( &cent->buildablePS ) )
     {
       cent->buildablePS = CG_SpawnNewParticleSystem( cgs.media.humanBuildableDamagedPS );
+      CG_SetParticleSystemOwner( &cent->buildablePS );
 
       if( CG_IsParticleSystemValid( &cent->buildablePS ) )
       {
@@ -723,6 +724,7 @@ static void CG_BuildableParticleEffects( centity_t *cent )
     if( healthFrac < 0.33f && !CG_IsParticleSystemValid( &cent->buildablePS ) )
     {
       cent->buildablePS = CG_SpawnNewParticleSystem( cgs.media.alienBuildableDamagedPS );
+      CG_SetParticleSystemOwner( &cent->buildablePS );
 
       if( CG_IsParticleSystemValid( &cent->buildablePS ) )
       {
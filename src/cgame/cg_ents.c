@@ -1018,6 +1018,8 @@ static void CG_CEntityPVSEnter( centity_t *cent )
   //when a buildable enters the PVS
   cent->buildableAnim = cent->lerpFrame.animationNumber = BANIM_NONE;
   cent->oldBuildableAnim = es->legsAnim;
+
+  CG_ScannerTrackEntity( cent );
 }
 
 
@@ -1045,6 +1047,8 @@ static void CG_CEntityPVSLeave( centity_t *cent )
       }
       break;
   }
+
+  CG_ScannerForgetEntity( cent );
 }
 
 
@@ -1186,9 +1190,6 @@ void CG_AddPacketEntities( void )
   // lerp the non-predicted value for lightning gun origins
   CG_CalcEntityLerpPositions( &cg_entities[ cg.snap->ps.clientNum ] );
 
-  // scanner
-  CG_UpdateEntityPositions( );
-
   for( num = 0; num < MAX_GENTITIES; num++ )
     cg_entities[ num ].valid = qfalse;
 
@@ -1211,6 +1212,9 @@ void CG_AddPacketEntities( void )
     cent->oldValid = cent->valid;
   }
 
+  // scanner
+  CG_UpdateEntityPositions( );
+
   // add each entity sent over by the server
   for( num = 0; num < cg.snap->numEntities; num++ )
   {
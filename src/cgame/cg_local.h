@@ -61,7 +61,7 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #define MAX_STEP_CHANGE     32
 
 #define MAX_VERTS_ON_POLY   10
-#define MAX_MARK_POLYS      256
+#define MAX_MARK_POLYS      512
 
 #define STAT_MINUS          10  // num frame for '-' stats digit
 
@@ -342,6 +342,8 @@ typedef struct baseParticleSystem_s
 
   qboolean              thirdPersonOnly;
   qboolean              registered; //whether or not the assets for this particle have been loaded
+
+  float                 lodRadius;  //largest particle radius, see CG_EffectLOD
 } baseParticleSystem_t;
 
 
@@ -355,9 +357,17 @@ typedef struct particleSystem_s
   qboolean              valid;
   qboolean              lazyRemove; //mark this system for later removal
 
+  struct particleSystem_s **owner;  //where the owner keeps this system, cleared on eviction
+
   //for PMT_NORMAL
   qboolean              normalValid;
   vec3_t                normal;
+
+  //level of detail, see CG_ParticleSystemLOD
+  int                   lodFrame;
+  float                 lod;
+  qboolean              occluded;
+  int                   nextOcclusionTime;
 } particleSystem_t;
 
 
@@ -373,6 +383,14 @@ typedef struct particleEjector_s
 
   int                   nextEjectionTime;
 
+  int                   liveParticles;  //particles from this ejector still valid
+
+  //a box around the particles known to be clear of world geometry
+  qboolean              clearValid;
+  vec3_t                clearMins;
+  vec3_t                clearMaxs;
+  int                   clearRetryTime;
+
   qboolean              valid;
 } particleEjector_t;
 
@@ -417,6 +435,10 @@ typedef struct particle_s
   int               frameWhenInvalidated;
 
   int               sortKey;
+
+  int               activeIndex;  //position in the active list while valid
+  qboolean          sorted;       //in sortedParticles since the last sort
+  struct particle_s *nextFree;    //free list link while invalid
 } particle_t;
 
 //======================================================================
@@ -523,8 +545,6 @@ typedef struct trailBeamNode_s
 
   struct trailBeamNode_s  *prev;
   struct trailBeamNode_s  *next;
-
-  qboolean                used;
 } trailBeamNode_t;
 
 typedef struct trailBeam_s
@@ -532,7 +552,10 @@ typedef struct trailBeam_s
   baseTrailBeam_t   *class;
   trailSystem_t     *parent;
 
+  //nodes are kept contiguous in a ring starting at firstNode
   trailBeamNode_t   nodePool[ MAX_TRAIL_BEAM_NODES ];
+  int               firstNode;
+  int               numNodes;
   trailBeamNode_t   *nodes;
 
   int               lastEvalTime;
@@ -674,6 +697,9 @@ typedef struct centity_s
 typedef struct markPoly_s
 {
   struct markPoly_s *prevMark, *nextMark;
+  struct markPoly_s *prevInBucket, *nextInBucket;
+  int               bucket;       // -1 if not yet placed
+  vec3_t            mins, maxs;
   int               time;
   qhandle_t         markShader;
   qboolean          alphaFade;    // fade alpha instead of rgb
@@ -1138,6 +1164,12 @@ typedef struct
   int           lastServerTime;
   playerState_t savedPmoveStates[ NUM_SAVED_STATES ];
   int           stateHead, stateTail;
+  unsigned int  solidSignature;       // movers in the solid list, see CG_BuildSolidList
+  unsigned int  lastSolidSignature;   // solidSignature the saved states were predicted with
+  int           predictStatsTime;
+  int           predictReplayed;      // commands run through Pmove since predictStatsTime
+  int           predictReused;        // commands copied from savedPmoveStates
+  int           predictFull;          // full predicts
   int           ping;
 } cg_t;
 
@@ -1364,6 +1396,7 @@ typedef struct
   int           numInlineModels;
   qhandle_t     inlineDrawModel[ MAX_MODELS ];
   vec3_t        inlineModelMidpoints[ MAX_MODELS ];
+  float         inlineModelRadius[ MAX_MODELS ];  //bounding radius around the model origin
 
   clientInfo_t  clientinfo[ MAX_CLIENTS ];
 
@@ -1400,8 +1433,6 @@ extern  upgradeInfo_t   cg_upgrades[ 32 ];
 //TA: buildable infos:
 extern  buildableInfo_t cg_buildables[ BA_NUM_BUILDABLES ];
 
-extern  markPoly_t      cg_markPolys[ MAX_MARK_POLYS ];
-
 extern  vmCvar_t    cg_centertime;
 extern  vmCvar_t    cg_runpitch;
 extern  vmCvar_t    cg_runroll;
@@ -1441,6 +1472,8 @@ extern  vmCvar_t    cg_noPlayerAnims;
 extern  vmCvar_t    cg_showmiss;
 extern  vmCvar_t    cg_footsteps;
 extern  vmCvar_t    cg_addMarks;
+extern  vmCvar_t    cg_cullMarks;
+extern  vmCvar_t    cg_markDistance;
 extern  vmCvar_t    cg_brassTime;
 extern  vmCvar_t    cg_gun_frame;
 extern  vmCvar_t    cg_gun_x;
@@ -1502,6 +1535,9 @@ extern  vmCvar_t    cg_wwFollow;
 extern  vmCvar_t    cg_wwToggle;
 extern  vmCvar_t    cg_depthSortParticles;
 extern  vmCvar_t    cg_bounceParticles;
+extern  vmCvar_t    cg_particleKernel;
+extern  vmCvar_t    cg_particleLOD;
+extern  vmCvar_t    cg_particleBudget;
 extern  vmCvar_t    cg_consoleLatency;
 extern  vmCvar_t    cg_lightFlare;
 extern  vmCvar_t    cg_debugParticles;
@@ -1670,6 +1706,7 @@ void        CG_ModelDoor( centity_t *cent );
 #define MAGIC_TRACE_HACK -2
 
 void        CG_BuildSolidList( void );
+qboolean    CG_SolidEntitiesInBox( const vec3_t mins, const vec3_t maxs, int skipNumber );
 int         CG_PointContents( const vec3_t point, int passEntityNum );
 void        CG_Trace( trace_t *result, const vec3_t start, const vec3_t mins, const vec3_t maxs,
                 const vec3_t end, int skipNumber, int mask );
@@ -1733,6 +1770,8 @@ void        CG_DrawItemSelectText( rectDef_t *rect, float scale, int textStyle )
 //
 // cg_scanner.c
 //
+void        CG_ScannerTrackEntity( centity_t *cent );
+void        CG_ScannerForgetEntity( centity_t *cent );
 void        CG_UpdateEntityPositions( void );
 void        CG_Scanner( rectDef_t *rect, qhandle_t shader, vec4_t color );
 void        CG_AlienSense( rectDef_t *rect );
@@ -1818,10 +1857,12 @@ void                CG_DestroyParticleSystem( particleSystem_t **ps );
 
 qboolean            CG_IsParticleSystemInfinite( particleSystem_t *ps );
 qboolean            CG_IsParticleSystemValid( particleSystem_t **ps );
+void                CG_SetParticleSystemOwner( particleSystem_t **ps );
 
 void                CG_SetParticleSystemNormal( particleSystem_t *ps, vec3_t normal );
 
 void                CG_AddParticles( void );
+float               CG_EffectLOD( attachment_t *a, float radius );
 
 void                CG_ParticleSystemEntity( centity_t *cent );
 
@@ -145,6 +145,8 @@ vmCvar_t  cg_noPlayerAnims;
 vmCvar_t  cg_showmiss;
 vmCvar_t  cg_footsteps;
 vmCvar_t  cg_addMarks;
+vmCvar_t  cg_cullMarks;
+vmCvar_t  cg_markDistance;
 vmCvar_t  cg_brassTime;
 vmCvar_t  cg_viewsize;
 vmCvar_t  cg_drawGun;
@@ -210,6 +212,9 @@ vmCvar_t  cg_wwFollow;
 vmCvar_t  cg_wwToggle;
 vmCvar_t  cg_depthSortParticles;
 vmCvar_t  cg_bounceParticles;
+vmCvar_t  cg_particleKernel;
+vmCvar_t  cg_particleLOD;
+vmCvar_t  cg_particleBudget;
 vmCvar_t  cg_consoleLatency;
 vmCvar_t  cg_lightFlare;
 vmCvar_t  cg_debugParticles;
@@ -280,6 +285,8 @@ static cvarTable_t cvarTable[ ] =
   { &cg_brassTime, "cg_brassTime", "2500", CVAR_ARCHIVE },
   { &cg_simpleItems, "cg_simpleItems", "0", CVAR_ARCHIVE },
   { &cg_addMarks, "cg_marks", "1", CVAR_ARCHIVE },
+  { &cg_cullMarks, "cg_cullMarks", "1", CVAR_ARCHIVE },
+  { &cg_markDistance, "cg_markDistance", "0", CVAR_ARCHIVE },
   { &cg_lagometer, "cg_lagometer", "0", CVAR_ARCHIVE },
   { &cg_teslaTrailTime, "cg_teslaTrailTime", "250", CVAR_ARCHIVE  },
   { &cg_railTrailTime, "cg_railTrailTime", "400", CVAR_ARCHIVE  },
@@ -329,6 +336,9 @@ static cvarTable_t cvarTable[ ] =
   { &cg_unlagged, "cg_unlagged", "1", CVAR_ARCHIVE|CVAR_USERINFO },
   { &cg_depthSortParticles, "cg_depthSortParticles", "1", CVAR_ARCHIVE },
   { &cg_bounceParticles, "cg_bounceParticles", "0", CVAR_ARCHIVE },
+  { &cg_particleKernel, "cg_particleKernel", "1", CVAR_ARCHIVE },
+  { &cg_particleLOD, "cg_particleLOD", "1", CVAR_ARCHIVE },
+  { &cg_particleBudget, "cg_particleBudget", "0", CVAR_ARCHIVE },
   { &cg_consoleLatency, "cg_consoleLatency", "3000", CVAR_ARCHIVE },
   { &cg_lightFlare, "cg_lightFlare", "3", CVAR_ARCHIVE },
   { &cg_debugParticles, "cg_debugParticles", "0", CVAR_CHEAT },
@@ -844,6 +854,8 @@ static void CG_RegisterGraphics( void )
 
     for( j = 0 ; j < 3 ; j++ )
       cgs.inlineModelMidpoints[ i ][ j ] = mins[ j ] + 0.5 * ( maxs[ j ] - mins[ j ] );
+
+    cgs.inlineModelRadius[ i ] = RadiusFromBounds( mins, maxs );
   }
 
   // register all the server specified models
@@ -35,10 +35,56 @@ MARK POLYS
 */
 
 
-markPoly_t  cg_activeMarkPolys;     // double linked list
-markPoly_t  *cg_freeMarkPolys;      // single linked list
-markPoly_t  cg_markPolys[ MAX_MARK_POLYS ];
-static int  markTotal;
+/*
+  Mark polys come from the CG_Alloc pool a chunk at a time as they are
+  needed, up to MAX_MARK_POLYS. Active marks are kept in the order they
+  were made, for expiry and for evicting the oldest when the pool is
+  full. They are also hashed into buckets by the area of the map they
+  are in, so that buckets out of view can be skipped as a whole. A
+  bucket's bounds are shrunk back to its remaining marks when a mark on
+  their edge goes, so they don't keep covering areas long since cleared.
+*/
+
+#define MARK_POLY_CHUNK     64
+#define MARK_BUCKETS        64    // must be a power of two
+#define MARK_BUCKET_SIZE    512   // size of the grid cells hashed to buckets
+
+typedef struct
+{
+  markPoly_t  *marks;             // linked through nextInBucket
+  int         numMarks;
+  vec3_t      mins, maxs;
+  qboolean    dirty;              // bounds may be larger than the marks
+} markBucket_t;
+
+markPoly_t          cg_activeMarkPolys;     // double linked list
+markPoly_t          *cg_freeMarkPolys;      // single linked list
+static markPoly_t   *markChunks[ MAX_MARK_POLYS / MARK_POLY_CHUNK ];
+static int          numMarkChunks;
+static markBucket_t markBuckets[ MARK_BUCKETS ];
+static int          markTotal;
+static vec3_t       markFrustum[ 4 ];
+static float        markFrustumDist[ 4 ];
+
+/*
+===================
+CG_LinkMarkChunk
+
+Put a chunk of mark polys on the free list
+===================
+*/
+static void CG_LinkMarkChunk( markPoly_t *chunk )
+{
+  int   i;
+
+  memset( chunk, 0, MARK_POLY_CHUNK * sizeof( markPoly_t ) );
+
+  for( i = MARK_POLY_CHUNK - 1; i >= 0; i-- )
+  {
+    chunk[ i ].nextMark = cg_freeMarkPolys;
+    cg_freeMarkPolys = &chunk[ i ];
+  }
+}
 
 /*
 ===================
@@ -51,16 +97,97 @@ void CG_InitMarkPolys( void )
 {
   int   i;
 
-  memset( cg_markPolys, 0, sizeof( cg_markPolys ) );
+  memset( markBuckets, 0, sizeof( markBuckets ) );
 
   cg_activeMarkPolys.nextMark = &cg_activeMarkPolys;
   cg_activeMarkPolys.prevMark = &cg_activeMarkPolys;
-  cg_freeMarkPolys = cg_markPolys;
+  cg_freeMarkPolys = NULL;
+  markTotal = 0;
 
-  for( i = 0; i < MAX_MARK_POLYS - 1; i++ )
-    cg_markPolys[ i ].nextMark = &cg_markPolys[ i + 1 ];
+  // chunks from before a restart are reused rather than reallocated
+  for( i = 0; i < numMarkChunks; i++ )
+    CG_LinkMarkChunk( markChunks[ i ] );
 }
 
+/*
+==================
+CG_MarkBucket
+
+Which bucket a point in the map falls in
+==================
+*/
+static int CG_MarkBucket( const vec3_t point )
+{
+  unsigned int  x, y, z;
+
+  x = (int)floor( point[ 0 ] / MARK_BUCKET_SIZE );
+  y = (int)floor( point[ 1 ] / MARK_BUCKET_SIZE );
+  z = (int)floor( point[ 2 ] / MARK_BUCKET_SIZE );
+
+  return ( ( x * 73856093 ) ^ ( y * 19349663 ) ^ ( z * 83492791 ) ) & ( MARK_BUCKETS - 1 );
+}
+
+/*
+==================
+CG_PlaceMarkPoly
+
+Put a mark in the bucket for its bounds
+==================
+*/
+static void CG_PlaceMarkPoly( markPoly_t *mp )
+{
+  vec3_t        center;
+  markBucket_t  *mb;
+
+  VectorAdd( mp->mins, mp->maxs, center );
+  VectorScale( center, 0.5f, center );
+
+  mp->bucket = CG_MarkBucket( center );
+  mb = &markBuckets[ mp->bucket ];
+
+  if( !mb->numMarks )
+  {
+    VectorCopy( mp->mins, mb->mins );
+    VectorCopy( mp->maxs, mb->maxs );
+    mb->dirty = qfalse;
+  }
+  else
+  {
+    AddPointToBounds( mp->mins, mb->mins, mb->maxs );
+    AddPointToBounds( mp->maxs, mb->mins, mb->maxs );
+  }
+
+  mp->prevInBucket = NULL;
+  mp->nextInBucket = mb->marks;
+
+  if( mb->marks )
+    mb->marks->prevInBucket = mp;
+
+  mb->marks = mp;
+  mb->numMarks++;
+}
+
+/*
+==================
+CG_RebuildMarkBucket
+
+Shrink a bucket's bounds to the marks still in it
+==================
+*/
+static void CG_RebuildMarkBucket( markBucket_t *mb )
+{
+  markPoly_t  *mp;
+
+  ClearBounds( mb->mins, mb->maxs );
+
+  for( mp = mb->marks; mp; mp = mp->nextInBucket )
+  {
+    AddPointToBounds( mp->mins, mb->mins, mb->maxs );
+    AddPointToBounds( mp->maxs, mb->mins, mb->maxs );
+  }
+
+  mb->dirty = qfalse;
+}
 
 /*
 ==================
@@ -69,6 +196,9 @@ CG_FreeMarkPoly
 */
 void CG_FreeMarkPoly( markPoly_t *le )
 {
+  int           i;
+  markBucket_t  *mb;
+
   if( !le->prevMark )
     CG_Error( "CG_FreeLocalEntity: not active" );
 
@@ -76,6 +206,33 @@ void CG_FreeMarkPoly( markPoly_t *le )
   le->prevMark->nextMark = le->nextMark;
   le->nextMark->prevMark = le->prevMark;
 
+  // remove from its bucket
+  if( le->bucket >= 0 )
+  {
+    mb = &markBuckets[ le->bucket ];
+
+    if( le->prevInBucket )
+      le->prevInBucket->nextInBucket = le->nextInBucket;
+    else
+      mb->marks = le->nextInBucket;
+
+    if( le->nextInBucket )
+      le->nextInBucket->prevInBucket = le->prevInBucket;
+
+    mb->numMarks--;
+
+    // the bounds only need rebuilding if this mark was on their edge,
+    // which CG_AddMarks does once for all the marks freed in a frame
+    for( i = 0; i < 3 && !mb->dirty; i++ )
+    {
+      if( le->mins[ i ] <= mb->mins[ i ] || le->maxs[ i ] >= mb->maxs[ i ] )
+        mb->dirty = qtrue;
+    }
+  }
+
+  le->prevMark = NULL;
+  markTotal--;
+
   // the free list is only singly linked
   le->nextMark = cg_freeMarkPolys;
   cg_freeMarkPolys = le;
@@ -91,31 +248,75 @@ Will allways succeed, even if it requires freeing an old active mark
 markPoly_t *CG_AllocMark( void )
 {
   markPoly_t  *le;
-  int         time;
 
-  if( !cg_freeMarkPolys )
+  if( !cg_freeMarkPolys && numMarkChunks < MAX_MARK_POLYS / MARK_POLY_CHUNK )
   {
-    // no free entities, so free the one at the end of the chain
-    // remove the oldest active entity
-    time = cg_activeMarkPolys.prevMark->time;
-
-    while( cg_activeMarkPolys.prevMark && time == cg_activeMarkPolys.prevMark->time )
-      CG_FreeMarkPoly( cg_activeMarkPolys.prevMark );
+    markChunks[ numMarkChunks ] = CG_Alloc( MARK_POLY_CHUNK * sizeof( markPoly_t ) );
+    CG_LinkMarkChunk( markChunks[ numMarkChunks ] );
+    numMarkChunks++;
   }
 
+  // no free marks, so free the oldest one at the end of the chain
+  if( !cg_freeMarkPolys )
+    CG_FreeMarkPoly( cg_activeMarkPolys.prevMark );
+
   le = cg_freeMarkPolys;
   cg_freeMarkPolys = cg_freeMarkPolys->nextMark;
 
   memset( le, 0, sizeof( *le ) );
+  le->bucket = -1;
 
   // link into the active list
   le->nextMark = cg_activeMarkPolys.nextMark;
   le->prevMark = &cg_activeMarkPolys;
   cg_activeMarkPolys.nextMark->prevMark = le;
   cg_activeMarkPolys.nextMark = le;
+  markTotal++;
+
   return le;
 }
 
+/*
+===================
+CG_MergeMarkPoly
+
+A new mark landing on an old one of the same kind replaces it
+rather than piling another poly on the same spot
+===================
+*/
+#define MARK_MERGE_FRAC   0.25f
+
+static void CG_MergeMarkPoly( qhandle_t markShader, qboolean alphaFade,
+                              const vec3_t mins, const vec3_t maxs, float radius )
+{
+  vec3_t      center;
+  markPoly_t  *mp;
+  float       epsilon = radius * MARK_MERGE_FRAC;
+  int         i;
+
+  VectorAdd( mins, maxs, center );
+  VectorScale( center, 0.5f, center );
+
+  for( mp = markBuckets[ CG_MarkBucket( center ) ].marks; mp; mp = mp->nextInBucket )
+  {
+    if( mp->markShader != markShader || mp->alphaFade != alphaFade )
+      continue;
+
+    for( i = 0; i < 3; i++ )
+    {
+      if( fabs( mp->mins[ i ] - mins[ i ] ) > epsilon ||
+          fabs( mp->maxs[ i ] - maxs[ i ] ) > epsilon )
+        break;
+    }
+
+    if( i == 3 )
+    {
+      CG_FreeMarkPoly( mp );
+      return;
+    }
+  }
+}
+
 
 
 /*
@@ -152,10 +353,6 @@ void CG_ImpactMark( qhandle_t markShader, const vec3_t origin, const vec3_t dir,
   if( radius <= 0 )
     CG_Error( "CG_ImpactMark called with <= 0 radius" );
 
-  //if ( markTotal >= MAX_MARK_POLYS ) {
-  //  return;
-  //}
-
   // create the texture axis
   VectorNormalize2( dir, axis[ 0 ] );
   PerpendicularVector( axis[ 1 ], axis[ 0 ] );
@@ -189,6 +386,7 @@ void CG_ImpactMark( qhandle_t markShader, const vec3_t origin, const vec3_t dir,
     polyVert_t  *v;
     polyVert_t  verts[ MAX_VERTS_ON_POLY ];
     markPoly_t  *mark;
+    vec3_t      mins, maxs;
 
     // we have an upper limit on the complexity of polygons
     // that we store persistantly
@@ -215,6 +413,13 @@ void CG_ImpactMark( qhandle_t markShader, const vec3_t origin, const vec3_t dir,
     }
 
     // otherwise save it persistantly
+    ClearBounds( mins, maxs );
+
+    for( j = 0; j < mf->numPoints; j++ )
+      AddPointToBounds( verts[ j ].xyz, mins, maxs );
+
+    CG_MergeMarkPoly( markShader, alphaFade, mins, maxs, radius );
+
     mark = CG_AllocMark( );
     mark->time = cg.time;
     mark->alphaFade = alphaFade;
@@ -225,11 +430,80 @@ void CG_ImpactMark( qhandle_t markShader, const vec3_t origin, const vec3_t dir,
     mark->color[ 2 ] = blue;
     mark->color[ 3 ] = alpha;
     memcpy( mark->verts, verts, mf->numPoints * sizeof( verts[ 0 ] ) );
-    markTotal++;
+    VectorCopy( mins, mark->mins );
+    VectorCopy( maxs, mark->maxs );
+    CG_PlaceMarkPoly( mark );
   }
 }
 
 
+/*
+===============
+CG_SetupMarkCulling
+
+Work out the planes of the view frustum
+===============
+*/
+static void CG_SetupMarkCulling( void )
+{
+  int   i;
+  float xs, xc, ys, yc;
+
+  xs = sin( DEG2RAD( cg.refdef.fov_x * 0.5f ) );
+  xc = cos( DEG2RAD( cg.refdef.fov_x * 0.5f ) );
+  ys = sin( DEG2RAD( cg.refdef.fov_y * 0.5f ) );
+  yc = cos( DEG2RAD( cg.refdef.fov_y * 0.5f ) );
+
+  VectorScale( cg.refdef.viewaxis[ 0 ], xs, markFrustum[ 0 ] );
+  VectorMA( markFrustum[ 0 ], xc, cg.refdef.viewaxis[ 1 ], markFrustum[ 0 ] );
+
+  VectorScale( cg.refdef.viewaxis[ 0 ], xs, markFrustum[ 1 ] );
+  VectorMA( markFrustum[ 1 ], -xc, cg.refdef.viewaxis[ 1 ], markFrustum[ 1 ] );
+
+  VectorScale( cg.refdef.viewaxis[ 0 ], ys, markFrustum[ 2 ] );
+  VectorMA( markFrustum[ 2 ], yc, cg.refdef.viewaxis[ 2 ], markFrustum[ 2 ] );
+
+  VectorScale( cg.refdef.viewaxis[ 0 ], ys, markFrustum[ 3 ] );
+  VectorMA( markFrustum[ 3 ], -yc, cg.refdef.viewaxis[ 2 ], markFrustum[ 3 ] );
+
+  for( i = 0; i < 4; i++ )
+    markFrustumDist[ i ] = DotProduct( cg.refdef.vieworg, markFrustum[ i ] );
+}
+
+/*
+===============
+CG_CullMarkBounds
+
+Returns qtrue if nothing within the bounds can be seen
+===============
+*/
+static qboolean CG_CullMarkBounds( const vec3_t mins, const vec3_t maxs )
+{
+  int     i;
+  vec3_t  center, extents;
+  float   radius;
+
+  VectorAdd( mins, maxs, center );
+  VectorScale( center, 0.5f, center );
+  VectorSubtract( maxs, center, extents );
+  radius = VectorLength( extents );
+
+  if( cg_markDistance.value > 0.0f &&
+      Distance( center, cg.refdef.vieworg ) - radius > cg_markDistance.value )
+    return qtrue;
+
+  if( cg_cullMarks.integer )
+  {
+    for( i = 0; i < 4; i++ )
+    {
+      if( DotProduct( center, markFrustum[ i ] ) - markFrustumDist[ i ] < -radius )
+        return qtrue;
+    }
+  }
+
+  return qfalse;
+}
+
 /*
 ===============
 CG_AddMarks
@@ -240,50 +514,63 @@ CG_AddMarks
 
 void CG_AddMarks( void )
 {
-  int         j;
-  markPoly_t  *mp, *next;
-  int         t;
-  int         fade;
+  int           i, j;
+  markPoly_t    *mp;
+  markBucket_t  *mb;
+  int           t;
+  int           fade;
 
   if( !cg_addMarks.integer )
     return;
 
-  mp = cg_activeMarkPolys.nextMark;
-  for ( ; mp != &cg_activeMarkPolys; mp = next )
+  // marks are kept in the order they were made, so the
+  // ones to be completely removed are all at the end
+  while( cg_activeMarkPolys.prevMark != &cg_activeMarkPolys &&
+         cg.time > cg_activeMarkPolys.prevMark->time + MARK_TOTAL_TIME )
+    CG_FreeMarkPoly( cg_activeMarkPolys.prevMark );
+
+  CG_SetupMarkCulling( );
+
+  for( i = 0; i < MARK_BUCKETS; i++ )
   {
-    // grab next now, so if the local entity is freed we
-    // still have it
-    next = mp->nextMark;
+    mb = &markBuckets[ i ];
 
-    // see if it is time to completely remove it
-    if( cg.time > mp->time + MARK_TOTAL_TIME )
-    {
-      CG_FreeMarkPoly( mp );
+    if( !mb->numMarks )
+      continue;
+
+    if( mb->dirty )
+      CG_RebuildMarkBucket( mb );
+
+    if( CG_CullMarkBounds( mb->mins, mb->maxs ) )
       continue;
-    }
 
-    // fade all marks out with time
-    t = mp->time + MARK_TOTAL_TIME - cg.time;
-    if( t < MARK_FADE_TIME )
+    for( mp = mb->marks; mp; mp = mp->nextInBucket )
     {
-      fade = 255 * t / MARK_FADE_TIME;
-      if( mp->alphaFade )
-      {
-        for( j = 0; j < mp->poly.numVerts; j++ )
-          mp->verts[ j ].modulate[ 3 ] = fade;
-      }
-      else
+      if( mb->numMarks > 1 && CG_CullMarkBounds( mp->mins, mp->maxs ) )
+        continue;
+
+      // fade all marks out with time
+      t = mp->time + MARK_TOTAL_TIME - cg.time;
+      if( t < MARK_FADE_TIME )
       {
-        for( j = 0; j < mp->poly.numVerts; j++ )
+        fade = 255 * t / MARK_FADE_TIME;
+        if( mp->alphaFade )
         {
-          mp->verts[ j ].modulate[ 0 ] = mp->color[ 0 ] * fade;
-          mp->verts[ j ].modulate[ 1 ] = mp->color[ 1 ] * fade;
-          mp->verts[ j ].modulate[ 2 ] = mp->color[ 2 ] * fade;
+          for( j = 0; j < mp->poly.numVerts; j++ )
+            mp->verts[ j ].modulate[ 3 ] = fade;
+        }
+        else
+        {
+          for( j = 0; j < mp->poly.numVerts; j++ )
+          {
+            mp->verts[ j ].modulate[ 0 ] = mp->color[ 0 ] * fade;
+            mp->verts[ j ].modulate[ 1 ] = mp->color[ 1 ] * fade;
+            mp->verts[ j ].modulate[ 2 ] = mp->color[ 2 ] * fade;
+          }
         }
       }
-    }
 
-    trap_R_AddPolyToScene( mp->markShader, mp->poly.numVerts, mp->verts );
+      trap_R_AddPolyToScene( mp->markShader, mp->poly.numVerts, mp->verts );
+    }
   }
 }
-
@@ -37,6 +37,35 @@ static particleEjector_t    particleEjectors[ MAX_PARTICLE_EJECTORS ];
 static particle_t           particles[ MAX_PARTICLES ];
 static particle_t           *sortedParticles[ MAX_PARTICLES ];
 static particle_t           *radixBuffer[ MAX_PARTICLES ];
+static particle_t           *newSortedParticles[ MAX_PARTICLES ];
+static int                  numSortedParticles = 0;
+
+//valid particles are kept densely in activeParticles and invalid ones on a
+//FIFO free list, so the oldest invalidated slot is always the next reused
+static particle_t           *activeParticles[ MAX_PARTICLES ];
+static int                  numActiveParticles = 0;
+static particle_t           *freeParticlesHead = NULL;
+static particle_t           *freeParticlesTail = NULL;
+
+//depth sort state, sortedParticles is kept from frame to frame
+#define PARTICLE_SORT_JUMP      128.0f  //view moves that force a full sort
+#define PARTICLE_SORT_MOVES     4       //insertion sort shifts allowed per particle
+#define PARTICLE_SORT_MIN_RADIX 64      //new particles worth radix sorting
+
+static qboolean             sortOrderValid = qfalse;
+static vec3_t               sortOrigin;
+static int                  sortMoves;
+static int                  sortNew;
+static const char           *sortMode = "off";
+
+//batched collision, see CG_ParticleBatchClear
+#define PARTICLE_CLEAR_MARGIN   32.0f   //slack added to boxes tested against the world
+#define PARTICLE_CLEAR_RETRY    250     //ms before retesting an ejector that wasn't clear
+
+static int                  collisionTraces;
+static int                  collisionTracesSaved;
+static int                  collisionContentsSaved;
+static int                  collisionClearTests;
 
 /*
 ===============
@@ -89,6 +118,113 @@ static void CG_SpreadVector( vec3_t v, float spread )
   VectorCopy( r2, v );
 }
 
+/*
+===============
+CG_InitParticlePool
+
+Put every particle slot on the free list
+===============
+*/
+static void CG_InitParticlePool( void )
+{
+  int i;
+
+  memset( particles, 0, sizeof( particles ) );
+  numActiveParticles = numSortedParticles = 0;
+  sortOrderValid = qfalse;
+
+  for( i = 0; i < MAX_PARTICLES - 1; i++ )
+    particles[ i ].nextFree = &particles[ i + 1 ];
+
+  freeParticlesHead = &particles[ 0 ];
+  freeParticlesTail = &particles[ MAX_PARTICLES - 1 ];
+}
+
+/*
+===============
+CG_AllocParticle
+
+Take the oldest free particle slot, provided other
+systems have had time to notice it was invalidated
+===============
+*/
+static particle_t *CG_AllocParticle( void )
+{
+  particle_t *p = freeParticlesHead;
+
+  //FIXME: the + 1 may be unnecessary
+  if( p == NULL || cg.clientFrame <= p->frameWhenInvalidated + 1 )
+    return NULL;
+
+  freeParticlesHead = p->nextFree;
+
+  if( freeParticlesHead == NULL )
+    freeParticlesTail = NULL;
+
+  return p;
+}
+
+/*
+===============
+CG_FreeParticle
+
+Return a slot to the free list, at the front if
+nothing can have seen it so it is reusable now
+===============
+*/
+static void CG_FreeParticle( particle_t *p, qboolean reuseNow )
+{
+  if( reuseNow )
+  {
+    p->nextFree = freeParticlesHead;
+    freeParticlesHead = p;
+
+    if( freeParticlesTail == NULL )
+      freeParticlesTail = p;
+  }
+  else
+  {
+    p->nextFree = NULL;
+
+    if( freeParticlesTail )
+      freeParticlesTail->nextFree = p;
+    else
+      freeParticlesHead = p;
+
+    freeParticlesTail = p;
+  }
+}
+
+/*
+===============
+CG_ReleaseParticle
+
+Remove a particle from the active list without any side effects
+===============
+*/
+static void CG_ReleaseParticle( particle_t *p )
+{
+  particle_t  *last;
+
+  if( !p->valid )
+    return;
+
+  p->valid = qfalse;
+
+  //this gives other systems a couple of
+  //frames to realise the particle is gone
+  p->frameWhenInvalidated = cg.clientFrame;
+
+  p->parent->liveParticles--;
+
+  //move the last active particle into the hole
+  last = activeParticles[ --numActiveParticles ];
+  activeParticles[ p->activeIndex ] = last;
+  last->activeIndex = p->activeIndex;
+
+  CG_FreeParticle( p, qfalse );
+}
+
 /*
 ===============
 CG_DestroyParticle
@@ -98,6 +234,13 @@ Destroy an individual particle
 */
 static void CG_DestroyParticle( particle_t *p, vec3_t impactNormal )
 {
+  if( !p->valid )
+    return;
+
+  //release first so that anything the onDeath system
+  //displaces can't see this particle as still alive
+  CG_ReleaseParticle( p );
+
   //this particle has an onDeath particle system attached
   if( p->class->onDeathSystemName[ 0 ] != '\0' )
   {
@@ -114,12 +257,6 @@ static void CG_DestroyParticle( particle_t *p, vec3_t impactNormal )
       CG_AttachToPoint( &ps->attachment );
     }
   }
-
-  p->valid = qfalse;
-
-  //this gives other systems a couple of
-  //frames to realise the particle is gone
-  p->frameWhenInvalidated = cg.clientFrame;
 }
 
 /*
@@ -131,182 +268,418 @@ Introduce a new particle into the world
 */
 static particle_t *CG_SpawnNewParticle( baseParticle_t *bp, particleEjector_t *parent )
 {
-  int                     i, j;
-  particle_t              *p = NULL;
+  int                     j;
+  particle_t              *p;
   particleEjector_t       *pe = parent;
   particleSystem_t        *ps = parent->parent;
   vec3_t                  attachmentPoint, attachmentVelocity;
   vec3_t                  transform[ 3 ];
 
-  for( i = 0; i < MAX_PARTICLES; i++ )
+  p = CG_AllocParticle( );
+
+  if( p == NULL )
+    return NULL;
+
+  memset( p, 0, sizeof( particle_t ) );
+
+  //found a free slot
+  p->class = bp;
+  p->parent = pe;
+
+  p->birthTime = cg.time;
+  p->lifeTime = (int)CG_RandomiseValue( (float)bp->lifeTime, bp->lifeTimeRandFrac );
+
+  p->radius.delay = (int)CG_RandomiseValue( (float)bp->radius.delay, bp->radius.delayRandFrac );
+  p->radius.initial = CG_RandomiseValue( bp->radius.initial, bp->radius.initialRandFrac );
+  p->radius.final = CG_RandomiseValue( bp->radius.final, bp->radius.finalRandFrac );
+
+  p->alpha.delay = (int)CG_RandomiseValue( (float)bp->alpha.delay, bp->alpha.delayRandFrac );
+  p->alpha.initial = CG_RandomiseValue( bp->alpha.initial, bp->alpha.initialRandFrac );
+  p->alpha.final = CG_RandomiseValue( bp->alpha.final, bp->alpha.finalRandFrac );
+
+  p->rotation.delay = (int)CG_RandomiseValue( (float)bp->rotation.delay, bp->rotation.delayRandFrac );
+  p->rotation.initial = CG_RandomiseValue( bp->rotation.initial, bp->rotation.initialRandFrac );
+  p->rotation.final = CG_RandomiseValue( bp->rotation.final, bp->rotation.finalRandFrac );
+
+  p->dLightRadius.delay =
+    (int)CG_RandomiseValue( (float)bp->dLightRadius.delay, bp->dLightRadius.delayRandFrac );
+  p->dLightRadius.initial =
+    CG_RandomiseValue( bp->dLightRadius.initial, bp->dLightRadius.initialRandFrac );
+  p->dLightRadius.final =
+    CG_RandomiseValue( bp->dLightRadius.final, bp->dLightRadius.finalRandFrac );
+
+  p->colorDelay = CG_RandomiseValue( bp->colorDelay, bp->colorDelayRandFrac );
+
+  p->bounceMarkRadius = CG_RandomiseValue( bp->bounceMarkRadius, bp->bounceMarkRadiusRandFrac );
+  p->bounceMarkCount =
+    rint( CG_RandomiseValue( (float)bp->bounceMarkCount, bp->bounceMarkCountRandFrac ) );
+  p->bounceSoundCount =
+    rint( CG_RandomiseValue( (float)bp->bounceSoundCount, bp->bounceSoundCountRandFrac ) );
+
+  if( bp->numModels )
   {
-    p = &particles[ i ];
+    p->model = bp->models[ rand( ) % bp->numModels ];
 
-    //FIXME: the + 1 may be unnecessary
-    if( !p->valid && cg.clientFrame > p->frameWhenInvalidated + 1 )
+    if( bp->modelAnimation.frameLerp < 0 )
     {
-      memset( p, 0, sizeof( particle_t ) );
-
-      //found a free slot
-      p->class = bp;
-      p->parent = pe;
+      bp->modelAnimation.frameLerp = p->lifeTime / bp->modelAnimation.numFrames;
+      bp->modelAnimation.initialLerp = p->lifeTime / bp->modelAnimation.numFrames;
+    }
+  }
 
-      p->birthTime = cg.time;
-      p->lifeTime = (int)CG_RandomiseValue( (float)bp->lifeTime, bp->lifeTimeRandFrac );
+  if( !CG_AttachmentPoint( &ps->attachment, attachmentPoint ) )
+  {
+    CG_FreeParticle( p, qtrue );
+    return NULL;
+  }
 
-      p->radius.delay = (int)CG_RandomiseValue( (float)bp->radius.delay, bp->radius.delayRandFrac );
-      p->radius.initial = CG_RandomiseValue( bp->radius.initial, bp->radius.initialRandFrac );
-      p->radius.final = CG_RandomiseValue( bp->radius.final, bp->radius.finalRandFrac );
+  VectorCopy( attachmentPoint, p->origin );
 
-      p->alpha.delay = (int)CG_RandomiseValue( (float)bp->alpha.delay, bp->alpha.delayRandFrac );
-      p->alpha.initial = CG_RandomiseValue( bp->alpha.initial, bp->alpha.initialRandFrac );
-      p->alpha.final = CG_RandomiseValue( bp->alpha.final, bp->alpha.finalRandFrac );
+  if( CG_AttachmentAxis( &ps->attachment, transform ) )
+  {
+    vec3_t  transDisplacement;
 
-      p->rotation.delay = (int)CG_RandomiseValue( (float)bp->rotation.delay, bp->rotation.delayRandFrac );
-      p->rotation.initial = CG_RandomiseValue( bp->rotation.initial, bp->rotation.initialRandFrac );
-      p->rotation.final = CG_RandomiseValue( bp->rotation.final, bp->rotation.finalRandFrac );
+    VectorMatrixMultiply( bp->displacement, transform, transDisplacement );
+    VectorAdd( p->origin, transDisplacement, p->origin );
+  }
+  else
+    VectorAdd( p->origin, bp->displacement, p->origin );
 
-      p->dLightRadius.delay =
-        (int)CG_RandomiseValue( (float)bp->dLightRadius.delay, bp->dLightRadius.delayRandFrac );
-      p->dLightRadius.initial =
-        CG_RandomiseValue( bp->dLightRadius.initial, bp->dLightRadius.initialRandFrac );
-      p->dLightRadius.final =
-        CG_RandomiseValue( bp->dLightRadius.final, bp->dLightRadius.finalRandFrac );
+  for( j = 0; j <= 2; j++ )
+    p->origin[ j ] += ( crandom( ) * bp->randDisplacement );
 
-      p->colorDelay = CG_RandomiseValue( bp->colorDelay, bp->colorDelayRandFrac );
+  switch( bp->velMoveType )
+  {
+    case PMT_STATIC:
+      if( bp->velMoveValues.dirType == PMD_POINT )
+        VectorSubtract( bp->velMoveValues.point, p->origin, p->velocity );
+      else if( bp->velMoveValues.dirType == PMD_LINEAR )
+        VectorCopy( bp->velMoveValues.dir, p->velocity );
+      break;
 
-      p->bounceMarkRadius = CG_RandomiseValue( bp->bounceMarkRadius, bp->bounceMarkRadiusRandFrac );
-      p->bounceMarkCount =
-        rint( CG_RandomiseValue( (float)bp->bounceMarkCount, bp->bounceMarkCountRandFrac ) );
-      p->bounceSoundCount =
-        rint( CG_RandomiseValue( (float)bp->bounceSoundCount, bp->bounceSoundCountRandFrac ) );
+    case PMT_STATIC_TRANSFORM:
+      if( !CG_AttachmentAxis( &ps->attachment, transform ) )
+      {
+        CG_FreeParticle( p, qtrue );
+        return NULL;
+      }
 
-      if( bp->numModels )
+      if( bp->velMoveValues.dirType == PMD_POINT )
       {
-        p->model = bp->models[ rand( ) % bp->numModels ];
+        vec3_t transPoint;
 
-        if( bp->modelAnimation.frameLerp < 0 )
+        VectorMatrixMultiply( bp->velMoveValues.point, transform, transPoint );
+        VectorSubtract( transPoint, p->origin, p->velocity );
+      }
+      else if( bp->velMoveValues.dirType == PMD_LINEAR )
+        VectorMatrixMultiply( bp->velMoveValues.dir, transform, p->velocity );
+      break;
+
+    case PMT_TAG:
+    case PMT_CENT_ANGLES:
+      if( bp->velMoveValues.dirType == PMD_POINT )
+        VectorSubtract( attachmentPoint, p->origin, p->velocity );
+      else if( bp->velMoveValues.dirType == PMD_LINEAR )
+      {
+        if( !CG_AttachmentDir( &ps->attachment, p->velocity ) )
         {
-          bp->modelAnimation.frameLerp = p->lifeTime / bp->modelAnimation.numFrames;
-          bp->modelAnimation.initialLerp = p->lifeTime / bp->modelAnimation.numFrames;
+          CG_FreeParticle( p, qtrue );
+          return NULL;
         }
       }
+      break;
 
-      if( !CG_AttachmentPoint( &ps->attachment, attachmentPoint ) )
+    case PMT_NORMAL:
+      if( !ps->normalValid )
+      {
+        CG_Printf( S_COLOR_RED "ERROR: a particle with velocityType "
+            "normal has no normal\n" );
+        CG_FreeParticle( p, qtrue );
         return NULL;
+      }
 
-      VectorCopy( attachmentPoint, p->origin );
+      VectorCopy( ps->normal, p->velocity );
 
-      if( CG_AttachmentAxis( &ps->attachment, transform ) )
-      {
-        vec3_t  transDisplacement;
+      //normal displacement
+      VectorNormalize( p->velocity );
+      VectorMA( p->origin, bp->normalDisplacement, p->velocity, p->origin );
+      break;
+  }
 
-        VectorMatrixMultiply( bp->displacement, transform, transDisplacement );
-        VectorAdd( p->origin, transDisplacement, p->origin );
-      }
-      else
-        VectorAdd( p->origin, bp->displacement, p->origin );
+  VectorNormalize( p->velocity );
+  CG_SpreadVector( p->velocity, bp->velMoveValues.dirRandAngle );
+  VectorScale( p->velocity,
+               CG_RandomiseValue( bp->velMoveValues.mag, bp->velMoveValues.magRandFrac ),
+               p->velocity );
 
-      for( j = 0; j <= 2; j++ )
-        p->origin[ j ] += ( crandom( ) * bp->randDisplacement );
+  if( CG_AttachmentVelocity( &ps->attachment, attachmentVelocity ) )
+  {
+    VectorMA( p->velocity,
+        CG_RandomiseValue( bp->velMoveValues.parentVelFrac,
+          bp->velMoveValues.parentVelFracRandFrac ), attachmentVelocity, p->velocity );
+  }
 
-      switch( bp->velMoveType )
-      {
-        case PMT_STATIC:
-          if( bp->velMoveValues.dirType == PMD_POINT )
-            VectorSubtract( bp->velMoveValues.point, p->origin, p->velocity );
-          else if( bp->velMoveValues.dirType == PMD_LINEAR )
-            VectorCopy( bp->velMoveValues.dir, p->velocity );
-          break;
+  p->lastEvalTime = cg.time;
 
-        case PMT_STATIC_TRANSFORM:
-          if( !CG_AttachmentAxis( &ps->attachment, transform ) )
-            return NULL;
+  p->valid = qtrue;
+  p->activeIndex = numActiveParticles;
+  activeParticles[ numActiveParticles++ ] = p;
+  pe->liveParticles++;
 
-          if( bp->velMoveValues.dirType == PMD_POINT )
-          {
-            vec3_t transPoint;
+  //this particle has a child particle system attached
+  if( bp->childSystemName[ 0 ] != '\0' )
+  {
+    particleSystem_t  *ps = CG_SpawnNewParticleSystem( bp->childSystemHandle );
 
-            VectorMatrixMultiply( bp->velMoveValues.point, transform, transPoint );
-            VectorSubtract( transPoint, p->origin, p->velocity );
-          }
-          else if( bp->velMoveValues.dirType == PMD_LINEAR )
-            VectorMatrixMultiply( bp->velMoveValues.dir, transform, p->velocity );
-          break;
+    if( CG_IsParticleSystemValid( &ps ) )
+    {
+      CG_SetAttachmentParticle( &ps->attachment, p );
+      CG_AttachToParticle( &ps->attachment );
+    }
+  }
 
-        case PMT_TAG:
-        case PMT_CENT_ANGLES:
-          if( bp->velMoveValues.dirType == PMD_POINT )
-            VectorSubtract( attachmentPoint, p->origin, p->velocity );
-          else if( bp->velMoveValues.dirType == PMD_LINEAR )
-          {
-            if( !CG_AttachmentDir( &ps->attachment, p->velocity ) )
-              return NULL;
-          }
-          break;
+  //this particle has a child trail system attached
+  if( bp->childTrailSystemName[ 0 ] != '\0' )
+  {
+    trailSystem_t *ts = CG_SpawnNewTrailSystem( bp->childTrailSystemHandle );
 
-        case PMT_NORMAL:
-          if( !ps->normalValid )
-          {
-            CG_Printf( S_COLOR_RED "ERROR: a particle with velocityType "
-                "normal has no normal\n" );
-            return NULL;
-          }
+    if( CG_IsTrailSystemValid( &ts ) )
+    {
+      CG_SetAttachmentParticle( &ts->frontAttachment, p );
+      CG_AttachToParticle( &ts->frontAttachment );
+    }
+  }
 
-          VectorCopy( ps->normal, p->velocity );
+  return p;
+}
 
-          //normal displacement
-          VectorNormalize( p->velocity );
-          VectorMA( p->origin, bp->normalDisplacement, p->velocity, p->origin );
-          break;
-      }
 
-      VectorNormalize( p->velocity );
-      CG_SpreadVector( p->velocity, bp->velMoveValues.dirRandAngle );
-      VectorScale( p->velocity,
-                   CG_RandomiseValue( bp->velMoveValues.mag, bp->velMoveValues.magRandFrac ),
-                   p->velocity );
+/*
+  effect scheduler
+
+  Effects are given a level of detail from where they sit relative to the
+  view: 1 is full detail, growing with distance and with how little of the
+  screen the effect covers, and doubling when the effect is behind the
+  viewer or occluded. Ejectors thin their ejections
+  by that factor, only effects on the local player keep spawning once
+  cg_particleBudget live particles exist, and when every system slot is
+  taken the least important finite system is dropped to make room.
+*/
 
-      if( CG_AttachmentVelocity( &ps->attachment, attachmentVelocity ) )
-      {
-        VectorMA( p->velocity,
-            CG_RandomiseValue( bp->velMoveValues.parentVelFrac,
-              bp->velMoveValues.parentVelFracRandFrac ), attachmentVelocity, p->velocity );
-      }
+#define EFFECT_LOD_NEAR           256.0f  //never reduce detail closer than this
+#define EFFECT_LOD_DISTANCE       1024.0f //further distance that doubles the lod
+#define EFFECT_OCCLUSION_PERIOD   250     //msec an occlusion test stays valid
+#define EFFECT_LOD_SCREEN_SIZE    0.02f   //radius over half screen height drawn in full
+#define EFFECT_LOD_SCREEN_MAX     4.0f    //most the screen size can raise the lod by
 
-      p->lastEvalTime = cg.time;
+static particleSystem_t *spawningSystem;  //never evicted while it is ejecting
+static int              lodThinned;       //ejections skipped this frame
+static int              lodEvicted;       //systems dropped this frame
+
+/*
+===============
+CG_EffectLOD
 
-      p->valid = qtrue;
+Level of detail for an effect at an attachment, 1 being full detail.
+radius is the effect's size in world units, 0 if it isn't known
+===============
+*/
+float CG_EffectLOD( attachment_t *a, float radius )
+{
+  vec3_t  origin, delta;
+  float   distance, lod;
+  float   screenSize, scale;
 
-      //this particle has a child particle system attached
-      if( bp->childSystemName[ 0 ] != '\0' )
-      {
-        particleSystem_t  *ps = CG_SpawnNewParticleSystem( bp->childSystemHandle );
+  if( !cg_particleLOD.integer || !cg.snap )
+    return 1.0f;
 
-        if( CG_IsParticleSystemValid( &ps ) )
-        {
-          CG_SetAttachmentParticle( &ps->attachment, p );
-          CG_AttachToParticle( &ps->attachment );
-        }
-      }
+  //effects on the local player are always drawn in full
+  if( CG_AttachmentCentNum( a ) == cg.snap->ps.clientNum )
+    return 1.0f;
 
-      //this particle has a child trail system attached
-      if( bp->childTrailSystemName[ 0 ] != '\0' )
-      {
-        trailSystem_t *ts = CG_SpawnNewTrailSystem( bp->childTrailSystemHandle );
+  if( !CG_AttachmentPoint( a, origin ) )
+    return 1.0f;
 
-        if( CG_IsTrailSystemValid( &ts ) )
-        {
-          CG_SetAttachmentParticle( &ts->frontAttachment, p );
-          CG_AttachToParticle( &ts->frontAttachment );
-        }
-      }
+  VectorSubtract( origin, cg.refdef.vieworg, delta );
+  distance = VectorLength( delta );
 
-      break;
+  if( distance < EFFECT_LOD_NEAR )
+    return 1.0f;
+
+  lod = 1.0f + ( distance - EFFECT_LOD_NEAR ) / EFFECT_LOD_DISTANCE;
+
+  //small effects that only cover a few pixels lose more detail
+  if( radius > 0.0f )
+  {
+    screenSize = radius / ( distance * tan( DEG2RAD( cg.refdef.fov_y ) * 0.5f ) );
+
+    if( screenSize < EFFECT_LOD_SCREEN_SIZE )
+    {
+      scale = EFFECT_LOD_SCREEN_SIZE / screenSize;
+
+      if( scale > EFFECT_LOD_SCREEN_MAX )
+        scale = EFFECT_LOD_SCREEN_MAX;
+
+      lod *= scale;
     }
   }
 
-  return p;
+  if( DotProduct( delta, cg.refdef.viewaxis[ 0 ] ) < 0.0f )
+    lod *= 2.0f;
+
+  return lod;
+}
+
+/*
+===============
+CG_ParticleSystemLOD
+
+CG_EffectLOD for a particle system, evaluated once a frame
+and including a periodic occlusion test
+===============
+*/
+static float CG_ParticleSystemLOD( particleSystem_t *ps )
+{
+  vec3_t  origin;
+  trace_t tr;
+
+  if( ps->lodFrame == cg.clientFrame && ps->lod >= 1.0f )
+    return ps->lod;
+
+  ps->lodFrame = cg.clientFrame;
+  ps->lod = CG_EffectLOD( &ps->attachment, ps->class->lodRadius );
+
+  //only bother testing occlusion for effects that are already reduced
+  if( ps->lod > 1.0f )
+  {
+    if( ps->nextOcclusionTime <= cg.time &&
+        CG_AttachmentPoint( &ps->attachment, origin ) )
+    {
+      trap_CM_BoxTrace( &tr, cg.refdef.vieworg, origin,
+                        vec3_origin, vec3_origin, 0, CONTENTS_SOLID );
+      ps->occluded = ( tr.fraction < 1.0f );
+      ps->nextOcclusionTime = cg.time + EFFECT_OCCLUSION_PERIOD;
+    }
+
+    if( ps->occluded )
+      ps->lod *= 2.0f;
+  }
+
+  return ps->lod;
+}
+
+/*
+===============
+CG_ThinEjection
+
+Decide whether the scheduler wants an ejection skipped
+===============
+*/
+static qboolean CG_ThinEjection( particleSystem_t *ps )
+{
+  int   budget = cg_particleBudget.integer;
+
+  if( budget <= 0 || budget > MAX_PARTICLES )
+    budget = MAX_PARTICLES;
+
+  if( CG_AttachmentCentNum( &ps->attachment ) == cg.snap->ps.clientNum )
+    return qfalse;
+
+  if( numActiveParticles >= budget ||
+      random( ) * CG_ParticleSystemLOD( ps ) >= 1.0f )
+  {
+    lodThinned++;
+    return qtrue;
+  }
+
+  return qfalse;
+}
+
+/*
+===============
+CG_EvictParticleSystem
+
+Free the slot of the least important finite particle system. Infinite
+systems are left alone since they only end when their owner destroys
+them. Finite systems can be held too, so an owner registered with
+CG_SetParticleSystemOwner has its pointer cleared before the slot is
+handed to someone else
+===============
+*/
+static particleSystem_t *CG_EvictParticleSystem( void )
+{
+  int               i;
+  qboolean          keep[ MAX_PARTICLE_SYSTEMS ];
+  qboolean          emitting[ MAX_PARTICLE_SYSTEMS ];
+  particleSystem_t  *ps, *victim = NULL;
+  particleEjector_t *pe;
+  float             score, victimScore = 0.0f;
+
+  memset( keep, 0, sizeof( keep ) );
+  memset( emitting, 0, sizeof( emitting ) );
+
+  for( i = 0; i < MAX_PARTICLE_EJECTORS; i++ )
+  {
+    pe = &particleEjectors[ i ];
+
+    if( !pe->valid )
+      continue;
+
+    if( pe->totalParticles == PARTICLES_INFINITE )
+      keep[ pe->parent - particleSystems ] = qtrue;
+    else if( pe->count > 0 )
+      emitting[ pe->parent - particleSystems ] = qtrue;
+  }
+
+  for( i = 0; i < MAX_PARTICLE_SYSTEMS; i++ )
+  {
+    ps = &particleSystems[ i ];
+
+    if( !ps->valid || keep[ i ] || ps == spawningSystem )
+      continue;
+
+    score = 1.0f / CG_ParticleSystemLOD( ps );
+
+    if( cg.snap && CG_AttachmentCentNum( &ps->attachment ) == cg.snap->ps.clientNum )
+      score += 1.0f;
+
+    //systems that have stopped ejecting are mostly spent
+    if( ps->lazyRemove || !emitting[ i ] )
+      score *= 0.5f;
+
+    if( !victim || score < victimScore )
+    {
+      victim = ps;
+      victimScore = score;
+    }
+  }
+
+  if( !victim )
+    return NULL;
+
+  for( i = 0; i < MAX_PARTICLE_EJECTORS; i++ )
+  {
+    if( particleEjectors[ i ].parent == victim )
+      particleEjectors[ i ].valid = qfalse;
+  }
+
+  //releasing swaps from the back, so walk backwards
+  for( i = numActiveParticles - 1; i >= 0; i-- )
+  {
+    if( activeParticles[ i ]->parent->parent == victim )
+      CG_ReleaseParticle( activeParticles[ i ] );
+  }
+
+  if( cg_debugParticles.integer >= 1 )
+    CG_Printf( "PS %s evicted\n", victim->class->name );
+
+  if( victim->owner && *victim->owner == victim )
+    *victim->owner = NULL;
+
+  victim->valid = qfalse;
+  lodEvicted++;
+
+  return victim;
 }
 
 
@@ -321,12 +694,10 @@ introducing new particles
 static void CG_SpawnNewParticles( void )
 {
   int                   i, j;
-  particle_t            *p;
   particleSystem_t      *ps;
   particleEjector_t     *pe;
   baseParticleEjector_t *bpe;
   float                 lerpFrac;
-  int                   count;
 
   for( i = 0; i < MAX_PARTICLE_EJECTORS; i++ )
   {
@@ -344,11 +715,16 @@ static void CG_SpawnNewParticles( void )
       //if this system is scheduled for removal don't make any new particles
       if( !ps->lazyRemove )
       {
+        spawningSystem = ps;
+
         while( pe->nextEjectionTime <= cg.time &&
                ( pe->count > 0 || pe->totalParticles == PARTICLES_INFINITE ) )
         {
-          for( j = 0; j < bpe->numParticles; j++ )
-            CG_SpawnNewParticle( bpe->particles[ j ], pe );
+          if( !CG_ThinEjection( ps ) )
+          {
+            for( j = 0; j < bpe->numParticles; j++ )
+              CG_SpawnNewParticle( bpe->particles[ j ], pe );
+          }
 
           if( pe->count > 0 )
             pe->count--;
@@ -361,24 +737,13 @@ static void CG_SpawnNewParticles( void )
                              lerpFrac ),
               pe->ejectPeriod.randFrac );
         }
-      }
-
-      if( pe->count == 0 || ps->lazyRemove )
-      {
-        count = 0;
 
-        //wait for child particles to die before declaring this pe invalid
-        for( j = 0; j < MAX_PARTICLES; j++ )
-        {
-          p = &particles[ j ];
-
-          if( p->valid && p->parent == pe )
-            count++;
-        }
-
-        if( !count )
-          pe->valid = qfalse;
+        spawningSystem = NULL;
       }
+
+      //wait for child particles to die before declaring this pe invalid
+      if( ( pe->count == 0 || ps->lazyRemove ) && !pe->liveParticles )
+        pe->valid = qfalse;
     }
   }
 }
@@ -453,27 +818,33 @@ particleSystem_t *CG_SpawnNewParticleSystem( qhandle_t psHandle )
 
   for( i = 0; i < MAX_PARTICLE_SYSTEMS; i++ )
   {
+    if( !particleSystems[ i ].valid )
+      break;
+  }
+
+  if( i < MAX_PARTICLE_SYSTEMS )
     ps = &particleSystems[ i ];
+  else if( ( ps = CG_EvictParticleSystem( ) ) == NULL )
+  {
+    if( cg_debugParticles.integer >= 1 )
+      CG_Printf( "PS %s dropped, no free slots\n", bps->name );
 
-    if( !ps->valid )
-    {
-      memset( ps, 0, sizeof( particleSystem_t ) );
+    return NULL;
+  }
 
-      //found a free slot
-      ps->class = bps;
+  memset( ps, 0, sizeof( particleSystem_t ) );
 
-      ps->valid = qtrue;
-      ps->lazyRemove = qfalse;
+  //found a free slot
+  ps->class = bps;
 
-      for( j = 0; j < bps->numEjectors; j++ )
-        CG_SpawnNewParticleEjector( bps->ejectors[ j ], ps );
+  ps->valid = qtrue;
+  ps->lazyRemove = qfalse;
 
-      if( cg_debugParticles.integer >= 1 )
-        CG_Printf( "PS %s created\n", bps->name );
+  for( j = 0; j < bps->numEjectors; j++ )
+    CG_SpawnNewParticleEjector( bps->ejectors[ j ], ps );
 
-      break;
-    }
-  }
+  if( cg_debugParticles.integer >= 1 )
+    CG_Printf( "PS %s created\n", bps->name );
 
   return ps;
 }
@@ -510,6 +881,11 @@ qhandle_t CG_RegisterParticleSystem( char *name )
         {
           bp = bpe->particles[ l ];
 
+          bps->lodRadius = MAX( bps->lodRadius,
+              bp->radius.initial * ( 1.0f + bp->radius.initialRandFrac ) );
+          bps->lodRadius = MAX( bps->lodRadius,
+              bp->radius.final * ( 1.0f + bp->radius.finalRandFrac ) );
+
           for( k = 0; k < bp->numFrames; k++ )
             bp->shaders[ k ] = trap_R_RegisterShader( bp->shaderNames[ k ] );
 
@@ -1700,6 +2076,8 @@ void CG_LoadParticleSystems( void )
   char  *filePtr;
 
   //clear out the old
+  CG_InitParticlePool( );
+
   numBaseParticleSystems = 0;
   numBaseParticleEjectors = 0;
   numBaseParticles = 0;
@@ -1893,6 +2271,20 @@ qboolean CG_IsParticleSystemInfinite( particleSystem_t *ps )
   return qfalse;
 }
 
+/*
+===============
+CG_SetParticleSystemOwner
+
+Note where a particle system is kept beyond the frame it was spawned in,
+so that evicting it leaves NULL there rather than someone else's system
+===============
+*/
+void CG_SetParticleSystemOwner( particleSystem_t **ps )
+{
+  if( CG_IsParticleSystemValid( ps ) )
+    (*ps)->owner = ps;
+}
+
 /*
 ===============
 CG_IsParticleSystemValid
@@ -1983,6 +2375,161 @@ static float CG_CalculateTimeFrac( int birth, int life, int delay )
   return frac;
 }
 
+//the time dependent values used to render a particle
+typedef struct particleLerp_s
+{
+  float timeFrac;
+  float colorFrac;
+  float radius;
+  float alpha;
+  float rotation;
+  float dLightRadius;
+} particleLerp_t;
+
+/*
+===============
+CG_LerpParticle
+
+Evaluate the time dependent values of a particle
+===============
+*/
+static void CG_LerpParticle( particle_t *p, particleLerp_t *lerp )
+{
+  lerp->timeFrac = CG_CalculateTimeFrac( p->birthTime, p->lifeTime, 0 );
+  lerp->colorFrac = CG_CalculateTimeFrac( p->birthTime, p->lifeTime, p->colorDelay );
+
+  lerp->radius = CG_LerpValues( p->radius.initial, p->radius.final,
+      CG_CalculateTimeFrac( p->birthTime, p->lifeTime, p->radius.delay ) );
+  lerp->alpha = CG_LerpValues( p->alpha.initial, p->alpha.final,
+      CG_CalculateTimeFrac( p->birthTime, p->lifeTime, p->alpha.delay ) );
+  lerp->rotation = CG_LerpValues( p->rotation.initial, p->rotation.final,
+      CG_CalculateTimeFrac( p->birthTime, p->lifeTime, p->rotation.delay ) );
+  lerp->dLightRadius = CG_LerpValues( p->dLightRadius.initial, p->dLightRadius.final,
+      CG_CalculateTimeFrac( p->birthTime, p->lifeTime, p->dLightRadius.delay ) );
+}
+
+/*
+===============
+CG_MoveParticle
+
+Move a particle to newOrigin, culling or bouncing it if it runs
+into something on the way. worldClear means the move is already
+known to stay clear of solid and nodrop world geometry.
+===============
+*/
+static void CG_MoveParticle( particle_t *p, vec3_t newOrigin, float radius,
+                             qboolean worldClear )
+{
+  particleSystem_t  *ps = p->parent->parent;
+  baseParticle_t    *bp = p->class;
+  vec3_t            mins, maxs;
+  vec3_t            sweptMins, sweptMaxs;
+  float             bounce, dot;
+  trace_t           trace;
+  int               i;
+
+  VectorSet( mins, -radius, -radius, -radius );
+  VectorSet( maxs, radius, radius, radius );
+
+  bounce = CG_RandomiseValue( bp->bounceFrac, bp->bounceFracRandFrac );
+
+  // we're not doing particle physics, but at least cull them in solids
+  if( !cg_bounceParticles.integer )
+  {
+    int contents;
+
+    if( worldClear )
+    {
+      collisionContentsSaved++;
+      VectorCopy( newOrigin, p->origin );
+      return;
+    }
+
+    contents = trap_CM_PointContents( newOrigin, 0 ); 
+
+    if( ( contents & CONTENTS_SOLID ) || ( contents & CONTENTS_NODROP ) )
+      CG_DestroyParticle( p, NULL );
+    else 
+      VectorCopy( newOrigin, p->origin );
+    return;
+  }
+
+  //non colliders can't do anything with the trace
+  if( bounce == 0.0f )
+  {
+    collisionTracesSaved++;
+    VectorCopy( newOrigin, p->origin );
+    return;
+  }
+
+  if( worldClear )
+  {
+    for( i = 0; i < 3; i++ )
+    {
+      sweptMins[ i ] = MIN( p->origin[ i ], newOrigin[ i ] ) - radius;
+      sweptMaxs[ i ] = MAX( p->origin[ i ], newOrigin[ i ] ) + radius;
+    }
+
+    if( !CG_SolidEntitiesInBox( sweptMins, sweptMaxs,
+                                CG_AttachmentCentNum( &ps->attachment ) ) )
+    {
+      collisionTracesSaved++;
+      VectorCopy( newOrigin, p->origin );
+      return;
+    }
+  }
+
+  collisionTraces++;
+  CG_Trace( &trace, p->origin, mins, maxs, newOrigin,
+      CG_AttachmentCentNum( &ps->attachment ), CONTENTS_SOLID );
+
+  //not hit anything or not a collider
+  if( trace.fraction == 1.0f || bounce == 0.0f )
+  {
+    VectorCopy( newOrigin, p->origin );
+    return;
+  }
+
+  //remove particles that get into a CONTENTS_NODROP brush
+  if( ( trap_CM_PointContents( trace.endpos, 0 ) & CONTENTS_NODROP ) ||
+      ( bp->cullOnStartSolid && trace.startsolid ) )
+  {
+    CG_DestroyParticle( p, NULL );
+    return;
+  }
+  else if( bp->bounceCull )
+  {
+    CG_DestroyParticle( p, trace.plane.normal );
+    return;
+  }
+
+  //reflect the velocity on the trace plane
+  dot = DotProduct( p->velocity, trace.plane.normal );
+  VectorMA( p->velocity, -2.0f * dot, trace.plane.normal, p->velocity );
+
+  VectorScale( p->velocity, bounce, p->velocity );
+
+  if( trace.plane.normal[ 2 ] > 0.5f &&
+      ( p->velocity[ 2 ] < 40.0f ||
+        p->velocity[ 2 ] < -cg.frametime * p->velocity[ 2 ] ) )
+    p->atRest = qtrue;
+
+  if( bp->bounceMarkName[ 0 ] && p->bounceMarkCount > 0 )
+  {
+    CG_ImpactMark( bp->bounceMark, trace.endpos, trace.plane.normal,
+        random( ) * 360, 1, 1, 1, 1, qtrue, bp->bounceMarkRadius, qfalse );
+    p->bounceMarkCount--;
+  }
+
+  if( bp->bounceSoundName[ 0 ] && p->bounceSoundCount > 0 )
+  {
+    trap_S_StartSound( trace.endpos, ENTITYNUM_WORLD, CHAN_AUTO, bp->bounceSound );
+    p->bounceSoundCount--;
+  }
+
+  VectorCopy( trace.endpos, p->origin );
+}
+
 /*
 ===============
 CG_EvaluateParticlePhysics
@@ -1995,9 +2542,7 @@ static void CG_EvaluateParticlePhysics( particle_t *p )
   particleSystem_t  *ps = p->parent->parent;
   baseParticle_t    *bp = p->class;
   vec3_t            acceleration, newOrigin;
-  vec3_t            mins, maxs;
-  float             deltaTime, bounce, radius, dot;
-  trace_t           trace;
+  float             deltaTime, radius;
   vec3_t            transform[ 3 ];
 
   if( p->atRest )
@@ -2092,79 +2637,16 @@ static void CG_EvaluateParticlePhysics( particle_t *p )
                                        p->lifeTime,
                                        p->radius.delay ) );
 
-  VectorSet( mins, -radius, -radius, -radius );
-  VectorSet( maxs, radius, radius, radius );
-
-  bounce = CG_RandomiseValue( bp->bounceFrac, bp->bounceFracRandFrac );
-
   deltaTime = (float)( cg.time - p->lastEvalTime ) * 0.001;
   VectorMA( p->velocity, deltaTime, acceleration, p->velocity );
   VectorMA( p->origin, deltaTime, p->velocity, newOrigin );
   p->lastEvalTime = cg.time;
 
-  // we're not doing particle physics, but at least cull them in solids
-  if( !cg_bounceParticles.integer )
-  {
-    int contents = trap_CM_PointContents( newOrigin, 0 ); 
-
-    if( ( contents & CONTENTS_SOLID ) || ( contents & CONTENTS_NODROP ) )
-      CG_DestroyParticle( p, NULL );
-    else 
-      VectorCopy( newOrigin, p->origin );
-    return;
-  }
-
-  CG_Trace( &trace, p->origin, mins, maxs, newOrigin,
-      CG_AttachmentCentNum( &ps->attachment ), CONTENTS_SOLID );
-
-  //not hit anything or not a collider
-  if( trace.fraction == 1.0f || bounce == 0.0f )
-  {
-    VectorCopy( newOrigin, p->origin );
-    return;
-  }
-
-  //remove particles that get into a CONTENTS_NODROP brush
-  if( ( trap_CM_PointContents( trace.endpos, 0 ) & CONTENTS_NODROP ) ||
-      ( bp->cullOnStartSolid && trace.startsolid ) )
-  {
-    CG_DestroyParticle( p, NULL );
-    return;
-  }
-  else if( bp->bounceCull )
-  {
-    CG_DestroyParticle( p, trace.plane.normal );
-    return;
-  }
-
-  //reflect the velocity on the trace plane
-  dot = DotProduct( p->velocity, trace.plane.normal );
-  VectorMA( p->velocity, -2.0f * dot, trace.plane.normal, p->velocity );
-
-  VectorScale( p->velocity, bounce, p->velocity );
-
-  if( trace.plane.normal[ 2 ] > 0.5f &&
-      ( p->velocity[ 2 ] < 40.0f ||
-        p->velocity[ 2 ] < -cg.frametime * p->velocity[ 2 ] ) )
-    p->atRest = qtrue;
-
-  if( bp->bounceMarkName[ 0 ] && p->bounceMarkCount > 0 )
-  {
-    CG_ImpactMark( bp->bounceMark, trace.endpos, trace.plane.normal,
-        random( ) * 360, 1, 1, 1, 1, qtrue, bp->bounceMarkRadius, qfalse );
-    p->bounceMarkCount--;
-  }
-
-  if( bp->bounceSoundName[ 0 ] && p->bounceSoundCount > 0 )
-  {
-    trap_S_StartSound( trace.endpos, ENTITYNUM_WORLD, CHAN_AUTO, bp->bounceSound );
-    p->bounceSoundCount--;
-  }
-
-  VectorCopy( trace.endpos, p->origin );
+  CG_MoveParticle( p, newOrigin, radius, qfalse );
 }
 
 
+
 #define GETKEY(x,y) (((x)>>y)&0xFF)
 
 /*
@@ -2207,59 +2689,164 @@ static void CG_RadixSort( particle_t **source, particle_t **temp, int size )
   CG_Radix( 24,  size, temp, source );
 }
 
+/*
+===============
+CG_SetParticleSortKeys
+
+Keys sort ascending from the farthest particle to the nearest
+===============
+*/
+static void CG_SetParticleSortKeys( particle_t **list, int size )
+{
+  int     i;
+  vec3_t  delta;
+
+  for( i = 0; i < size; i++ )
+  {
+    VectorSubtract( list[ i ]->origin, cg.refdef.vieworg, delta );
+    list[ i ]->sortKey = 0x7FFFFFFF - (int)DotProduct( delta, delta );
+  }
+}
+
+/*
+===============
+CG_InsertionSortParticles
+
+Sort a list that is nearly in order already, giving up and
+returning qfalse once more than maxMoves shifts are needed
+===============
+*/
+static qboolean CG_InsertionSortParticles( particle_t **list, int size, int maxMoves )
+{
+  int         i, j;
+  particle_t  *p;
+
+  for( i = 1; i < size; i++ )
+  {
+    p = list[ i ];
+
+    for( j = i; j > 0 && list[ j - 1 ]->sortKey > p->sortKey; j-- )
+    {
+      list[ j ] = list[ j - 1 ];
+
+      if( ++sortMoves > maxMoves )
+      {
+        list[ j - 1 ] = p;
+        return qfalse;
+      }
+    }
+
+    list[ j ] = p;
+  }
+
+  return qtrue;
+}
+
 /*
 ===============
 CG_CompactAndSortParticles
 
 Depth sort the particles
+
+The order from the previous frame is kept and patched up with an
+insertion sort, since particles barely move relative to each
+other between frames. New particles are sorted separately and
+merged in. A full radix sort is only done when the view jumps or
+the patch up turns out to be too much work.
 ===============
 */
 static void CG_CompactAndSortParticles( void )
 {
-  int     i, j = 0;
-  int     numParticles;
-  vec3_t  delta;
+  int         i, j, k;
+  int         numOld, numNew;
+  particle_t  *p;
 
-  for( i = 0; i < MAX_PARTICLES; i++ )
-    sortedParticles[ i ] = &particles[ i ];
+  sortMoves = 0;
+  sortNew = 0;
 
   if( !cg_depthSortParticles.integer )
+  {
+    numSortedParticles = numActiveParticles;
+
+    for( i = 0; i < numActiveParticles; i++ )
+      sortedParticles[ i ] = activeParticles[ i ];
+
+    sortOrderValid = qfalse;
+    sortMode = "off";
     return;
+  }
 
-  for( i = MAX_PARTICLES - 1; i >= 0; i-- )
+  if( !sortOrderValid ||
+      Distance( cg.refdef.vieworg, sortOrigin ) > PARTICLE_SORT_JUMP )
   {
-    if( sortedParticles[ i ]->valid )
-    {
-      //find the first hole
-      while( j < MAX_PARTICLES && sortedParticles[ j ]->valid )
-        j++;
+    for( i = 0; i < numActiveParticles; i++ )
+      activeParticles[ i ]->sorted = qfalse;
 
-      //no more holes
-      if( j >= i )
-        break;
+    numSortedParticles = 0;
+  }
 
-      sortedParticles[ j ] = sortedParticles[ i ];
+  //particles still alive from last frame, in last frame's order
+  for( i = numOld = 0; i < numSortedParticles; i++ )
+  {
+    p = sortedParticles[ i ];
+
+    if( p->valid && p->sorted )
+      sortedParticles[ numOld++ ] = p;
+  }
+
+  //particles that weren't sorted last frame
+  for( i = numNew = 0; i < numActiveParticles; i++ )
+  {
+    p = activeParticles[ i ];
+
+    if( !p->sorted )
+    {
+      newSortedParticles[ numNew++ ] = p;
+      p->sorted = qtrue;
     }
   }
 
-  numParticles = i;
+  sortNew = numNew;
+  numSortedParticles = numOld + numNew;
+  VectorCopy( cg.refdef.vieworg, sortOrigin );
+  sortOrderValid = qtrue;
 
-  //set sort keys
-  for( i = 0; i < numParticles; i++ )
+  CG_SetParticleSortKeys( sortedParticles, numOld );
+  CG_SetParticleSortKeys( newSortedParticles, numNew );
+
+  if( numOld == 0 || !CG_InsertionSortParticles( sortedParticles, numOld,
+                                                 numOld * PARTICLE_SORT_MOVES ) )
   {
-    VectorSubtract( sortedParticles[ i ]->origin, cg.refdef.vieworg, delta );
-    sortedParticles[ i ]->sortKey = (int)DotProduct( delta, delta );
+    //start from scratch
+    for( i = 0; i < numNew; i++ )
+      sortedParticles[ numOld + i ] = newSortedParticles[ i ];
+
+    CG_RadixSort( sortedParticles, radixBuffer, numSortedParticles );
+    sortMode = "radix";
+    return;
   }
 
-  CG_RadixSort( sortedParticles, radixBuffer, numParticles );
+  sortMode = "incremental";
+
+  if( numNew == 0 )
+    return;
+
+  if( numNew < PARTICLE_SORT_MIN_RADIX )
+    CG_InsertionSortParticles( newSortedParticles, numNew, MAX_PARTICLES * MAX_PARTICLES );
+  else
+    CG_RadixSort( newSortedParticles, radixBuffer, numNew );
 
-  //FIXME: wtf?
-  //reverse order of particles array
-  for( i = 0; i < numParticles; i++ )
-    radixBuffer[ i ] = sortedParticles[ numParticles - i - 1 ];
+  //merge the new particles in from the back
+  i = numOld - 1;
+  j = numNew - 1;
 
-  for( i = 0; i < numParticles; i++ )
-    sortedParticles[ i ] = radixBuffer[ i ];
+  for( k = numSortedParticles - 1; j >= 0; k-- )
+  {
+    if( i >= 0 && sortedParticles[ i ]->sortKey > newSortedParticles[ j ]->sortKey )
+      sortedParticles[ k ] = sortedParticles[ i-- ];
+    else
+      sortedParticles[ k ] = newSortedParticles[ j-- ];
+  }
 }
 
 /*
@@ -2269,7 +2856,7 @@ CG_RenderParticle
 Actually render a particle
 ===============
 */
-static void CG_RenderParticle( particle_t *p )
+static void CG_RenderParticle( particle_t *p, const particleLerp_t *lerp )
 {
   refEntity_t           re;
   float                 timeFrac, scale;
@@ -2283,13 +2870,8 @@ static void CG_RenderParticle( particle_t *p )
 
   memset( &re, 0, sizeof( refEntity_t ) );
 
-  timeFrac = CG_CalculateTimeFrac( p->birthTime, p->lifeTime, 0 );
-
-  scale = CG_LerpValues( p->radius.initial,
-                    p->radius.final,
-                    CG_CalculateTimeFrac( p->birthTime,
-                                          p->lifeTime,
-                                          p->radius.delay ) );
+  timeFrac = lerp->timeFrac;
+  scale = lerp->radius;
 
   re.shaderTime = p->birthTime / 1000.0f;
 
@@ -2311,27 +2893,14 @@ static void CG_RenderParticle( particle_t *p )
       VectorSubtract( bp->finalColor,
           bp->initialColor, colorRange );
 
-      VectorMA( bp->initialColor,
-          CG_CalculateTimeFrac( p->birthTime,
-            p->lifeTime,
-            p->colorDelay ),
-          colorRange, re.shaderRGBA );
+      VectorMA( bp->initialColor, lerp->colorFrac, colorRange, re.shaderRGBA );
     }
 
-    re.shaderRGBA[ 3 ] = (byte)( (float)0xFF *
-                         CG_LerpValues( p->alpha.initial,
-                               p->alpha.final,
-                               CG_CalculateTimeFrac( p->birthTime,
-                                                     p->lifeTime,
-                                                     p->alpha.delay ) ) );
+    re.shaderRGBA[ 3 ] = (byte)( (float)0xFF * lerp->alpha );
 
     re.radius = scale;
 
-    re.rotation = CG_LerpValues( p->rotation.initial,
-                        p->rotation.final,
-                        CG_CalculateTimeFrac( p->birthTime,
-                                              p->lifeTime,
-                                              p->rotation.delay ) );
+    re.rotation = lerp->rotation;
 
     // if the view would be "inside" the sprite, kill the sprite
     // so it doesn't add too much overdraw
@@ -2408,9 +2977,7 @@ static void CG_RenderParticle( particle_t *p )
 
   if( bp->dynamicLight && !( re.renderfx & RF_THIRD_PERSON ) )
   {
-    trap_R_AddLightToScene( p->origin,
-      CG_LerpValues( p->dLightRadius.initial, p->dLightRadius.final,
-        CG_CalculateTimeFrac( p->birthTime, p->lifeTime, p->dLightRadius.delay ) ),
+    trap_R_AddLightToScene( p->origin, lerp->dLightRadius,
         (float)bp->dLightColor[ 0 ] / (float)0xFF,
         (float)bp->dLightColor[ 1 ] / (float)0xFF,
         (float)bp->dLightColor[ 2 ] / (float)0xFF );
@@ -2421,6 +2988,503 @@ static void CG_RenderParticle( particle_t *p )
   trap_R_AddRefEntityToScene( &re );
 }
 
+/*
+  batched particle kernel
+
+  With cg_particleKernel set the live particles are bucketed by ejector and
+  gathered into structure of arrays form each frame. A particle system's
+  attachment is then queried once per batch rather than once per particle,
+  and the integration and the lerps run as flat loops over the arrays before
+  the results are scattered back for collision and rendering. particle_t
+  stays the authoritative copy since attachments and trails read it.
+  cg_particleKernel 0 runs the original per particle code for comparison.
+*/
+
+typedef enum
+{
+  PK_TIME,
+  PK_COLOR,
+  PK_RADIUS,
+  PK_ALPHA,
+  PK_ROTATION,
+  PK_DLIGHT,
+
+  PK_NUM_LERPS
+} particleKernelLerp_t;
+
+//the attachment of the particle system a batch belongs to
+typedef struct particleKernelBatch_s
+{
+  particleSystem_t  *ps;
+
+  qboolean          pointValid;
+  qboolean          axisValid;
+  qboolean          dirValid;
+
+  vec3_t            point;
+  vec3_t            axis[ 3 ];
+  vec3_t            dir;
+} particleKernelBatch_t;
+
+static particle_t *kernelParticles[ MAX_PARTICLES ];
+static int        kernelIndex[ MAX_PARTICLES ];   //by sortedParticles position, -1 if skipped
+static int        kernelBatchStart[ MAX_PARTICLE_EJECTORS + 1 ];
+static int        kernelBatchFill[ MAX_PARTICLE_EJECTORS ];
+static qboolean   kernelMove[ MAX_PARTICLES ];
+
+static float      kernelOrigin[ 3 ][ MAX_PARTICLES ];
+static float      kernelVelocity[ 3 ][ MAX_PARTICLES ];
+static float      kernelAcceleration[ 3 ][ MAX_PARTICLES ];
+static float      kernelDeltaTime[ MAX_PARTICLES ];
+
+static float      kernelLerpStart[ MAX_PARTICLES ];
+static float      kernelLerpSpan[ MAX_PARTICLES ];
+static float      kernelLerpInitial[ MAX_PARTICLES ];
+static float      kernelLerpFinal[ MAX_PARTICLES ];
+static float      kernelLerp[ PK_NUM_LERPS ][ MAX_PARTICLES ];
+
+/*
+===============
+CG_KernelGatherLerp
+
+Fill the lerp input arrays from one pLerpValues_t of each particle,
+offset is where it lives in particle_t or -1 for a plain 0 to 1 fraction
+===============
+*/
+static void CG_KernelGatherLerp( int n, int offset, int which )
+{
+  int           i, delay;
+  particle_t    *p;
+  pLerpValues_t *lv;
+
+  for( i = 0; i < n; i++ )
+  {
+    p = kernelParticles[ i ];
+
+    if( offset < 0 )
+    {
+      delay = ( which == PK_COLOR ) ? p->colorDelay : 0;
+      kernelLerpInitial[ i ] = 0.0f;
+      kernelLerpFinal[ i ] = 1.0f;
+    }
+    else
+    {
+      lv = (pLerpValues_t *)( (byte *)p + offset );
+      delay = lv->delay;
+      kernelLerpInitial[ i ] = lv->initial;
+
+      if( lv->final == PARTICLES_SAME_AS_INITIAL )
+        kernelLerpFinal[ i ] = lv->initial;
+      else
+        kernelLerpFinal[ i ] = lv->final;
+    }
+
+    kernelLerpStart[ i ] = (float)( p->birthTime + delay );
+    kernelLerpSpan[ i ] = (float)( p->lifeTime - delay );
+  }
+}
+
+/*
+===============
+CG_KernelLerp
+
+The equivalent of CG_LerpValues and CG_CalculateTimeFrac over every
+gathered particle
+===============
+*/
+static void CG_KernelLerp( int n, float *out )
+{
+  int   i;
+  float frac, time = (float)cg.time;
+
+  for( i = 0; i < n; i++ )
+  {
+    frac = ( time - kernelLerpStart[ i ] ) / kernelLerpSpan[ i ];
+
+    if( frac < 0.0f )
+      frac = 0.0f;
+    else if( frac > 1.0f )
+      frac = 1.0f;
+
+    out[ i ] = kernelLerpInitial[ i ] + frac * ( kernelLerpFinal[ i ] - kernelLerpInitial[ i ] );
+  }
+}
+
+/*
+===============
+CG_KernelAccelerationDir
+
+The unscaled acceleration of a particle, qfalse if
+its system's attachment can't provide it
+===============
+*/
+static qboolean CG_KernelAccelerationDir( particleKernelBatch_t *batch, particle_t *p,
+                                          vec3_t acceleration )
+{
+  baseParticle_t  *bp = p->class;
+
+  VectorClear( acceleration );
+
+  switch( bp->accMoveType )
+  {
+    case PMT_STATIC:
+      if( bp->accMoveValues.dirType == PMD_POINT )
+        VectorSubtract( bp->accMoveValues.point, p->origin, acceleration );
+      else if( bp->accMoveValues.dirType == PMD_LINEAR )
+        VectorCopy( bp->accMoveValues.dir, acceleration );
+      break;
+
+    case PMT_STATIC_TRANSFORM:
+      if( !batch->axisValid )
+        return qfalse;
+
+      if( bp->accMoveValues.dirType == PMD_POINT )
+      {
+        vec3_t transPoint;
+
+        VectorMatrixMultiply( bp->accMoveValues.point, batch->axis, transPoint );
+        VectorSubtract( transPoint, p->origin, acceleration );
+      }
+      else if( bp->accMoveValues.dirType == PMD_LINEAR )
+        VectorMatrixMultiply( bp->accMoveValues.dir, batch->axis, acceleration );
+      break;
+
+    case PMT_TAG:
+    case PMT_CENT_ANGLES:
+      if( bp->accMoveValues.dirType == PMD_POINT )
+      {
+        if( !batch->pointValid )
+          return qfalse;
+
+        VectorSubtract( batch->point, p->origin, acceleration );
+      }
+      else if( bp->accMoveValues.dirType == PMD_LINEAR )
+      {
+        if( !batch->dirValid )
+          return qfalse;
+
+        VectorCopy( batch->dir, acceleration );
+      }
+      break;
+
+    case PMT_NORMAL:
+      if( !batch->ps->normalValid )
+        return qfalse;
+
+      VectorCopy( batch->ps->normal, acceleration );
+      break;
+  }
+
+  return qtrue;
+}
+
+/*
+===============
+CG_KernelAccelerate
+
+Work out the acceleration of each particle in a batch,
+which all share the same particle system
+===============
+*/
+static void CG_KernelAccelerate( particleKernelBatch_t *batch, int start, int end )
+{
+  int               i, j;
+  particle_t        *p;
+  baseParticle_t    *bp;
+  vec3_t            acceleration;
+  float             r2, scale;
+
+  for( i = start; i < end; i++ )
+  {
+    p = kernelParticles[ i ];
+    bp = p->class;
+
+    kernelMove[ i ] = qfalse;
+    kernelDeltaTime[ i ] = 0.0f;
+
+    if( p->atRest )
+    {
+      VectorClear( p->velocity );
+      VectorClear( acceleration );
+    }
+    else if( CG_KernelAccelerationDir( batch, p, acceleration ) )
+    {
+      if( bp->accMoveValues.dirType == PMD_POINT )
+      {
+        r2 = DotProduct( acceleration, acceleration );
+        scale = ( MAX_ACC_RADIUS - r2 ) / MAX_ACC_RADIUS;
+
+        if( scale > 1.0f )
+          scale = 1.0f;
+        else if( scale < 0.1f )
+          scale = 0.1f;
+
+        scale *= CG_RandomiseValue( bp->accMoveValues.mag, bp->accMoveValues.magRandFrac );
+
+        VectorNormalize( acceleration );
+        CG_SpreadVector( acceleration, bp->accMoveValues.dirRandAngle );
+        VectorScale( acceleration, scale, acceleration );
+      }
+      else if( bp->accMoveValues.dirType == PMD_LINEAR )
+      {
+        VectorNormalize( acceleration );
+        CG_SpreadVector( acceleration, bp->accMoveValues.dirRandAngle );
+        VectorScale( acceleration,
+                     CG_RandomiseValue( bp->accMoveValues.mag, bp->accMoveValues.magRandFrac ),
+                     acceleration );
+      }
+
+      kernelMove[ i ] = qtrue;
+      kernelDeltaTime[ i ] = (float)( cg.time - p->lastEvalTime ) * 0.001;
+    }
+
+    for( j = 0; j < 3; j++ )
+    {
+      kernelAcceleration[ j ][ i ] = acceleration[ j ];
+
+      if( p->atRest )
+        kernelVelocity[ j ][ i ] = 0.0f;
+    }
+  }
+}
+
+/*
+===============
+CG_KernelIntegrate
+
+Step the velocity and position of every gathered particle
+===============
+*/
+static void CG_KernelIntegrate( int n )
+{
+  int   i, j;
+  float *origin, *velocity, *acceleration;
+
+  for( j = 0; j < 3; j++ )
+  {
+    origin = kernelOrigin[ j ];
+    velocity = kernelVelocity[ j ];
+    acceleration = kernelAcceleration[ j ];
+
+    for( i = 0; i < n; i++ )
+    {
+      velocity[ i ] += kernelDeltaTime[ i ] * acceleration[ i ];
+      origin[ i ] += kernelDeltaTime[ i ] * velocity[ i ];
+    }
+  }
+}
+
+/*
+===============
+CG_ParticleBatchClear
+
+Test whether every move in a batch stays clear of solid and nodrop
+world geometry. The world doesn't change so a box found to be clear
+is kept on the ejector, and while the moves stay inside it no
+world collision queries are needed at all.
+===============
+*/
+static qboolean CG_ParticleBatchClear( particleEjector_t *pe, int start, int end )
+{
+  int       i, j;
+  qboolean  moving = qfalse;
+  vec3_t    mins, maxs, center;
+  float     radius;
+  trace_t   trace;
+
+  ClearBounds( mins, maxs );
+
+  for( i = start; i < end; i++ )
+  {
+    if( !kernelMove[ i ] )
+      continue;
+
+    radius = kernelLerp[ PK_RADIUS ][ i ];
+    moving = qtrue;
+
+    for( j = 0; j < 3; j++ )
+    {
+      mins[ j ] = MIN( mins[ j ], MIN( kernelParticles[ i ]->origin[ j ], kernelOrigin[ j ][ i ] ) - radius );
+      maxs[ j ] = MAX( maxs[ j ], MAX( kernelParticles[ i ]->origin[ j ], kernelOrigin[ j ][ i ] ) + radius );
+    }
+  }
+
+  if( !moving )
+    return qfalse;
+
+  if( pe->clearValid &&
+      mins[ 0 ] >= pe->clearMins[ 0 ] && maxs[ 0 ] <= pe->clearMaxs[ 0 ] &&
+      mins[ 1 ] >= pe->clearMins[ 1 ] && maxs[ 1 ] <= pe->clearMaxs[ 1 ] &&
+      mins[ 2 ] >= pe->clearMins[ 2 ] && maxs[ 2 ] <= pe->clearMaxs[ 2 ] )
+    return qtrue;
+
+  if( pe->clearRetryTime > cg.time )
+    return qfalse;
+
+  for( j = 0; j < 3; j++ )
+  {
+    mins[ j ] -= PARTICLE_CLEAR_MARGIN;
+    maxs[ j ] += PARTICLE_CLEAR_MARGIN;
+    center[ j ] = ( mins[ j ] + maxs[ j ] ) * 0.5f;
+  }
+
+  VectorSubtract( mins, center, mins );
+  VectorSubtract( maxs, center, maxs );
+
+  //a trace that doesn't go anywhere is a test for overlapping brushes
+  collisionClearTests++;
+  trap_CM_BoxTrace( &trace, center, center, mins, maxs, 0, CONTENTS_SOLID|(int)CONTENTS_NODROP );
+
+  if( trace.startsolid || trace.allsolid )
+  {
+    pe->clearRetryTime = cg.time + PARTICLE_CLEAR_RETRY;
+    return qfalse;
+  }
+
+  pe->clearValid = qtrue;
+  VectorAdd( center, mins, pe->clearMins );
+  VectorAdd( center, maxs, pe->clearMaxs );
+
+  return qtrue;
+}
+
+/*
+===============
+CG_RunParticleKernel
+
+Evaluate and render the sorted particles in batches
+===============
+*/
+static void CG_RunParticleKernel( void )
+{
+  int                   i, j, e, n;
+  particle_t            *p;
+  particleKernelBatch_t batch;
+  particleLerp_t        lerp;
+  vec3_t                newOrigin;
+  qboolean              worldClear;
+
+  //bucket the particles by ejector, expired ones are removed here
+  memset( kernelBatchStart, 0, sizeof( kernelBatchStart ) );
+
+  for( i = 0; i < numSortedParticles; i++ )
+  {
+    p = sortedParticles[ i ];
+    kernelIndex[ i ] = -1;
+
+    if( !p->valid )
+      continue;
+
+    if( p->birthTime + p->lifeTime <= cg.time )
+    {
+      CG_DestroyParticle( p, NULL );
+      continue;
+    }
+
+    kernelIndex[ i ] = p->parent - particleEjectors;
+    kernelBatchStart[ kernelIndex[ i ] + 1 ]++;
+  }
+
+  for( e = 0; e < MAX_PARTICLE_EJECTORS; e++ )
+  {
+    kernelBatchStart[ e + 1 ] += kernelBatchStart[ e ];
+    kernelBatchFill[ e ] = kernelBatchStart[ e ];
+  }
+
+  n = kernelBatchStart[ MAX_PARTICLE_EJECTORS ];
+
+  //gather
+  for( i = 0; i < numSortedParticles; i++ )
+  {
+    if( kernelIndex[ i ] < 0 )
+      continue;
+
+    p = sortedParticles[ i ];
+    kernelIndex[ i ] = kernelBatchFill[ kernelIndex[ i ] ]++;
+    kernelParticles[ kernelIndex[ i ] ] = p;
+
+    for( j = 0; j < 3; j++ )
+    {
+      kernelOrigin[ j ][ kernelIndex[ i ] ] = p->origin[ j ];
+      kernelVelocity[ j ][ kernelIndex[ i ] ] = p->velocity[ j ];
+    }
+  }
+
+  CG_KernelGatherLerp( n, -1, PK_TIME );
+  CG_KernelLerp( n, kernelLerp[ PK_TIME ] );
+  CG_KernelGatherLerp( n, -1, PK_COLOR );
+  CG_KernelLerp( n, kernelLerp[ PK_COLOR ] );
+  CG_KernelGatherLerp( n, (byte *)&particles[ 0 ].radius - (byte *)&particles[ 0 ], PK_RADIUS );
+  CG_KernelLerp( n, kernelLerp[ PK_RADIUS ] );
+  CG_KernelGatherLerp( n, (byte *)&particles[ 0 ].alpha - (byte *)&particles[ 0 ], PK_ALPHA );
+  CG_KernelLerp( n, kernelLerp[ PK_ALPHA ] );
+  CG_KernelGatherLerp( n, (byte *)&particles[ 0 ].rotation - (byte *)&particles[ 0 ], PK_ROTATION );
+  CG_KernelLerp( n, kernelLerp[ PK_ROTATION ] );
+  CG_KernelGatherLerp( n, (byte *)&particles[ 0 ].dLightRadius - (byte *)&particles[ 0 ], PK_DLIGHT );
+  CG_KernelLerp( n, kernelLerp[ PK_DLIGHT ] );
+
+  //acceleration, fetching each system's attachment once
+  for( e = 0; e < MAX_PARTICLE_EJECTORS; e++ )
+  {
+    if( kernelBatchStart[ e ] == kernelBatchStart[ e + 1 ] )
+      continue;
+
+    batch.ps = particleEjectors[ e ].parent;
+    batch.pointValid = CG_AttachmentPoint( &batch.ps->attachment, batch.point );
+    batch.axisValid = CG_AttachmentAxis( &batch.ps->attachment, batch.axis );
+    batch.dirValid = CG_AttachmentDir( &batch.ps->attachment, batch.dir );
+
+    CG_KernelAccelerate( &batch, kernelBatchStart[ e ], kernelBatchStart[ e + 1 ] );
+  }
+
+  CG_KernelIntegrate( n );
+
+  //scatter and collide, checking each batch against the world first
+  for( e = 0; e < MAX_PARTICLE_EJECTORS; e++ )
+  {
+    if( kernelBatchStart[ e ] == kernelBatchStart[ e + 1 ] )
+      continue;
+
+    worldClear = CG_ParticleBatchClear( &particleEjectors[ e ],
+                                        kernelBatchStart[ e ], kernelBatchStart[ e + 1 ] );
+
+    for( i = kernelBatchStart[ e ]; i < kernelBatchStart[ e + 1 ]; i++ )
+    {
+      p = kernelParticles[ i ];
+
+      //an onDeath system may have evicted this particle's system
+      if( !kernelMove[ i ] || !p->valid )
+        continue;
+
+      for( j = 0; j < 3; j++ )
+      {
+        p->velocity[ j ] = kernelVelocity[ j ][ i ];
+        newOrigin[ j ] = kernelOrigin[ j ][ i ];
+      }
+
+      p->lastEvalTime = cg.time;
+
+      CG_MoveParticle( p, newOrigin, kernelLerp[ PK_RADIUS ][ i ], worldClear );
+    }
+  }
+
+  //render in sorted order
+  for( i = 0; i < numSortedParticles; i++ )
+  {
+    if( ( j = kernelIndex[ i ] ) < 0 )
+      continue;
+
+    lerp.timeFrac = kernelLerp[ PK_TIME ][ j ];
+    lerp.colorFrac = kernelLerp[ PK_COLOR ][ j ];
+    lerp.radius = kernelLerp[ PK_RADIUS ][ j ];
+    lerp.alpha = kernelLerp[ PK_ALPHA ][ j ];
+    lerp.rotation = kernelLerp[ PK_ROTATION ][ j ];
+    lerp.dLightRadius = kernelLerp[ PK_DLIGHT ][ j ];
+
+    CG_RenderParticle( sortedParticles[ i ], &lerp );
+  }
+}
+
 /*
 ===============
 CG_AddParticles
@@ -2432,8 +3496,12 @@ void CG_AddParticles( void )
 {
   int           i;
   particle_t    *p;
+  particleLerp_t lerp;
   int           numPS = 0, numPE = 0, numP = 0;
 
+  collisionTraces = collisionTracesSaved = 0;
+  collisionContentsSaved = collisionClearTests = 0;
+
   //remove expired particle systems
   CG_GarbageCollectParticleSystems( );
 
@@ -2443,20 +3511,26 @@ void CG_AddParticles( void )
   //sorting
   CG_CompactAndSortParticles( );
 
-  for( i = 0; i < MAX_PARTICLES; i++ )
+  if( cg_particleKernel.integer )
+    CG_RunParticleKernel( );
+  else
   {
-    p = sortedParticles[ i ];
-
-    if( p->valid )
+    for( i = 0; i < numSortedParticles; i++ )
     {
-      if( p->birthTime + p->lifeTime > cg.time )
+      p = sortedParticles[ i ];
+
+      if( p->valid )
       {
-        //particle is active
-        CG_EvaluateParticlePhysics( p );
-        CG_RenderParticle( p );
+        if( p->birthTime + p->lifeTime > cg.time )
+        {
+          //particle is active
+          CG_EvaluateParticlePhysics( p );
+          CG_LerpParticle( p, &lerp );
+          CG_RenderParticle( p, &lerp );
+        }
+        else
+          CG_DestroyParticle( p, NULL );
       }
-      else
-        CG_DestroyParticle( p, NULL );
     }
   }
 
@@ -2470,12 +3544,17 @@ void CG_AddParticles( void )
       if( particleEjectors[ i ].valid )
         numPE++;
 
-    for( i = 0; i < MAX_PARTICLES; i++ )
-      if( particles[ i ].valid )
-        numP++;
+    numP = numActiveParticles;
 
     CG_Printf( "PS: %d  PE: %d  P: %d\n", numPS, numPE, numP );
+    CG_Printf( "sort: %s  new: %d  moves: %d\n", sortMode, sortNew, sortMoves );
+    CG_Printf( "collision: traces: %d  saved: %d  contents saved: %d  clear tests: %d\n",
+               collisionTraces, collisionTracesSaved, collisionContentsSaved,
+               collisionClearTests );
+    CG_Printf( "lod: thinned: %d  evicted: %d\n", lodThinned, lodEvicted );
   }
+
+  lodThinned = lodEvicted = 0;
 }
 
 /*
@@ -2502,6 +3581,7 @@ void CG_ParticleSystemEntity( centity_t *cent )
   if( !CG_IsParticleSystemValid( &cent->entityPS ) && !cent->entityPSMissing )
   {
     cent->entityPS = CG_SpawnNewParticleSystem( cgs.gameParticleSystems[ es->modelindex ] );
+    CG_SetParticleSystemOwner( &cent->entityPS );
 
     if( CG_IsParticleSystemValid( &cent->entityPS ) )
     {
@@ -2554,6 +3634,7 @@ void CG_TestPS_f( void )
     CG_DestroyTestPS_f( );
 
     testPS = CG_SpawnNewParticleSystem( testPSHandle );
+    CG_SetParticleSystemOwner( &testPS );
 
     VectorMA( cg.refdef.vieworg, 100, cg.refdef.viewaxis[ 0 ], origin );
 
@@ -1580,6 +1580,7 @@ static void CG_PlayerUpgrades( centity_t *cent, refEntity_t *torso )
             CG_DestroyParticleSystem( &cent->jetPackPS );
 
           cent->jetPackPS = CG_SpawnNewParticleSystem( cgs.media.jetPackAscendPS );
+          CG_SetParticleSystemOwner( &cent->jetPackPS );
           cent->jetPackState = JPS_ASCENDING;
         }
 
@@ -1594,6 +1595,7 @@ static void CG_PlayerUpgrades( centity_t *cent, refEntity_t *torso )
             CG_DestroyParticleSystem( &cent->jetPackPS );
 
           cent->jetPackPS = CG_SpawnNewParticleSystem( cgs.media.jetPackDescendPS );
+          CG_SetParticleSystemOwner( &cent->jetPackPS );
           cent->jetPackState = JPS_DESCENDING;
         }
 
@@ -1608,6 +1610,7 @@ static void CG_PlayerUpgrades( centity_t *cent, refEntity_t *torso )
             CG_DestroyParticleSystem( &cent->jetPackPS );
 
           cent->jetPackPS = CG_SpawnNewParticleSystem( cgs.media.jetPackHoverPS );
+          CG_SetParticleSystemOwner( &cent->jetPackPS );
           cent->jetPackState = JPS_HOVERING;
         }
 
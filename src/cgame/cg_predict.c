@@ -36,21 +36,27 @@ static  centity_t *cg_solidEntities[MAX_ENTITIES_IN_SNAPSHOT];
 static  int     cg_numTriggerEntities;
 static  centity_t *cg_triggerEntities[MAX_ENTITIES_IN_SNAPSHOT];
 
+//clip models of the SOLID_BMODEL entries in cg_solidEntities
+static  int           cg_solidModelIndex[MAX_ENTITIES_IN_SNAPSHOT];
+static  clipHandle_t  cg_solidModels[MAX_ENTITIES_IN_SNAPSHOT];
+
 /*
 ====================
 CG_BuildSolidList
 
 When a new cg.snap has been set, this function builds a sublist
 of the entities that are actually solid, to make for more
-efficient collision detection
+efficient collision detection. It also sums up the movers in the
+list so that prediction can tell when they have changed
 ====================
 */
 void CG_BuildSolidList( void )
 {
-  int           i;
+  int           i, j;
   centity_t     *cent;
   snapshot_t    *snap;
-  entityState_t *ent;
+  entityState_t *ent, *es;
+  unsigned int  signature = 0;
 
   cg_numSolidEntities = 0;
   cg_numTriggerEntities = 0;
@@ -64,6 +70,7 @@ void CG_BuildSolidList( void )
   {
     cent = &cg_entities[ snap->entities[ i ].number ];
     ent = &cent->currentState;
+    es = &snap->entities[ i ];
 
     if( ent->eType == ET_ITEM || ent->eType == ET_PUSH_TRIGGER || ent->eType == ET_TELEPORT_TRIGGER )
     {
@@ -74,11 +81,119 @@ void CG_BuildSolidList( void )
 
     if( cent->nextState.solid && ent->eType != ET_MISSILE )
     {
+      if( ent->solid == SOLID_BMODEL )
+      {
+        cg_solidModelIndex[ cg_numSolidEntities ] = ent->modelindex;
+        cg_solidModels[ cg_numSolidEntities ] = trap_CM_InlineModel( ent->modelindex );
+
+        signature = signature * 31 + es->number;
+        signature = signature * 31 + es->modelindex;
+        signature = signature * 31 + es->pos.trType;
+        signature = signature * 31 + es->pos.trTime;
+        signature = signature * 31 + es->apos.trType;
+        signature = signature * 31 + es->apos.trTime;
+
+        for( j = 0; j < 3; j++ )
+        {
+          signature = signature * 31 + (int)( es->pos.trBase[ j ] * 8.0f );
+          signature = signature * 31 + (int)( es->pos.trDelta[ j ] * 8.0f );
+          signature = signature * 31 + (int)( es->apos.trBase[ j ] * 8.0f );
+          signature = signature * 31 + (int)( es->apos.trDelta[ j ] * 8.0f );
+        }
+      }
+      else
+        cg_solidModelIndex[ cg_numSolidEntities ] = -1;
+
       cg_solidEntities[ cg_numSolidEntities ] = cent;
       cg_numSolidEntities++;
       continue;
     }
   }
+
+  cg.solidSignature = signature;
+}
+
+/*
+====================
+CG_SolidEntityBounds
+
+Work out the origin and bounds of a solid entity as it is right now,
+along with a world space box it can't reach outside of. Brush models
+are bounded by their radius so that rotation is covered. Returns
+qfalse if the box can't be worked out
+====================
+*/
+static qboolean CG_SolidEntityBounds( centity_t *cent, qboolean predicted,
+    vec3_t origin, vec3_t bmins, vec3_t bmaxs, vec3_t absmin, vec3_t absmax )
+{
+  int           x, zd, zu;
+  entityState_t *ent = &cent->currentState;
+  float         radius;
+
+  if( ent->solid == SOLID_BMODEL )
+  {
+    BG_EvaluateTrajectory( &cent->currentState.pos, cg.physicsTime, origin );
+
+    if( ent->modelindex <= 0 || ent->modelindex >= cgs.numInlineModels )
+      return qfalse;
+
+    radius = cgs.inlineModelRadius[ ent->modelindex ];
+    VectorSet( bmins, -radius, -radius, -radius );
+    VectorSet( bmaxs, radius, radius, radius );
+  }
+  else
+  {
+    // encoded bbox
+    x = ( ent->solid & 255 );
+    zd = ( ( ent->solid >> 8 ) & 255 );
+    zu = ( ( ent->solid >> 16 ) & 255 ) - 32;
+
+    bmins[ 0 ] = bmins[ 1 ] = -x;
+    bmaxs[ 0 ] = bmaxs[ 1 ] = x;
+    bmins[ 2 ] = -zd;
+    bmaxs[ 2 ] = zu;
+
+    if( predicted )
+      BG_FindBBoxForClass( ( ent->powerups >> 8 ) & 0xFF, bmins, bmaxs, NULL, NULL, NULL );
+
+    VectorCopy( cent->lerpOrigin, origin );
+  }
+
+  VectorAdd( origin, bmins, absmin );
+  VectorAdd( origin, bmaxs, absmax );
+
+  return qtrue;
+}
+
+/*
+====================
+CG_SolidEntitiesInBox
+
+Whether any solid entity other than skipNumber might
+reach into a box, for skipping needless entity traces
+====================
+*/
+qboolean CG_SolidEntitiesInBox( const vec3_t mins, const vec3_t maxs, int skipNumber )
+{
+  int     i;
+  vec3_t  origin, bmins, bmaxs, absmin, absmax;
+
+  for( i = 0; i < cg_numSolidEntities; i++ )
+  {
+    if( cg_solidEntities[ i ]->currentState.number == skipNumber )
+      continue;
+
+    if( CG_SolidEntityBounds( cg_solidEntities[ i ], qfalse,
+                              origin, bmins, bmaxs, absmin, absmax ) &&
+        ( mins[ 0 ] > absmax[ 0 ] || maxs[ 0 ] < absmin[ 0 ] ||
+          mins[ 1 ] > absmax[ 1 ] || maxs[ 1 ] < absmin[ 1 ] ||
+          mins[ 2 ] > absmax[ 2 ] || maxs[ 2 ] < absmin[ 2 ] ) )
+      continue;
+
+    return qtrue;
+  }
+
+  return qfalse;
 }
 
 /*
@@ -91,14 +206,48 @@ static void CG_ClipMoveToEntities ( const vec3_t start, const vec3_t mins,
     const vec3_t maxs, const vec3_t end, int skipNumber,
     int mask, trace_t *tr, traceType_t collisionType )
 {
-  int           i, j, x, zd, zu;
+  int           i, j;
   trace_t       trace;
   entityState_t *ent;
   clipHandle_t  cmodel;
   vec3_t        bmins, bmaxs;
   vec3_t        origin, angles;
+  vec3_t        absmin, absmax;
+  vec3_t        sweptMins, sweptMaxs;
+  float         radius;
   centity_t     *cent;
 
+  //the box swept out by the trace, slightly enlarged to stay clear of
+  //the epsilons used by the collision code
+  for( i = 0; i < 3; i++ )
+  {
+    if( start[ i ] < end[ i ] )
+    {
+      sweptMins[ i ] = start[ i ];
+      sweptMaxs[ i ] = end[ i ];
+    }
+    else
+    {
+      sweptMins[ i ] = end[ i ];
+      sweptMaxs[ i ] = start[ i ];
+    }
+
+    if( collisionType == TT_BISPHERE )
+    {
+      radius = MAX( mins[ 0 ], maxs[ 0 ] );
+      sweptMins[ i ] -= radius;
+      sweptMaxs[ i ] += radius;
+    }
+    else if( mins && maxs )
+    {
+      sweptMins[ i ] += mins[ i ];
+      sweptMaxs[ i ] += maxs[ i ];
+    }
+
+    sweptMins[ i ] -= 1.0f;
+    sweptMaxs[ i ] += 1.0f;
+  }
+
   //SUPAR HACK
   //this causes a trace to collide with the local player
   if( skipNumber == MAGIC_TRACE_HACK )
@@ -118,31 +267,28 @@ static void CG_ClipMoveToEntities ( const vec3_t start, const vec3_t mins,
     if( ent->number == skipNumber )
       continue;
 
+    //skip anything the trace can't reach before asking the engine
+    if( CG_SolidEntityBounds( cent, i == cg_numSolidEntities,
+                              origin, bmins, bmaxs, absmin, absmax ) &&
+        ( sweptMins[ 0 ] > absmax[ 0 ] || sweptMaxs[ 0 ] < absmin[ 0 ] ||
+          sweptMins[ 1 ] > absmax[ 1 ] || sweptMaxs[ 1 ] < absmin[ 1 ] ||
+          sweptMins[ 2 ] > absmax[ 2 ] || sweptMaxs[ 2 ] < absmin[ 2 ] ) )
+      continue;
+
     if( ent->solid == SOLID_BMODEL )
     {
       // special value for bmodel
-      cmodel = trap_CM_InlineModel( ent->modelindex );
+      if( i < cg_numSolidEntities && cg_solidModelIndex[ i ] == ent->modelindex )
+        cmodel = cg_solidModels[ i ];
+      else
+        cmodel = trap_CM_InlineModel( ent->modelindex );
+
       VectorCopy( cent->lerpAngles, angles );
-      BG_EvaluateTrajectory( &cent->currentState.pos, cg.physicsTime, origin );
     }
     else
     {
-      // encoded bbox
-      x = ( ent->solid & 255 );
-      zd = ( ( ent->solid >> 8 ) & 255 );
-      zu = ( ( ent->solid >> 16 ) & 255 ) - 32;
-
-      bmins[ 0 ] = bmins[ 1 ] = -x;
-      bmaxs[ 0 ] = bmaxs[ 1 ] = x;
-      bmins[ 2 ] = -zd;
-      bmaxs[ 2 ] = zu;
-
-      if( i == cg_numSolidEntities )
-        BG_FindBBoxForClass( ( ent->powerups >> 8 ) & 0xFF, bmins, bmaxs, NULL, NULL, NULL );
-
       cmodel = trap_CM_TempBoxModel( bmins, bmaxs );
       VectorCopy( vec3_origin, angles );
-      VectorCopy( cent->lerpOrigin, origin );
     }
 
 
@@ -662,14 +808,21 @@ void CG_PredictPlayerState( void )
   // except a frame following a new snapshot in which there was a prediction
   // error.  This yeilds anywhere from a 15% to 40% performance increase,
   // depending on how much of a bottleneck the CPU is.
+  //
+  // Saved states are never reused across a change to the movers in the
+  // solid list, since the commands after the snapshot would have been
+  // predicted against doors and lifts that are no longer where they were.
   if( cg_optimizePrediction.integer )
   {
-    if( cg.nextFrameTeleport || cg.thisFrameTeleport )
+    if( cg.nextFrameTeleport || cg.thisFrameTeleport ||
+        ( cg.physicsTime != cg.lastServerTime &&
+          cg.solidSignature != cg.lastSolidSignature ) )
     {
       // do a full predict
       cg.lastPredictedCommand = 0;
       cg.stateTail = cg.stateHead;
       predictCmd = current - CMD_BACKUP + 1;
+      cg.predictFull++;
     }
     // cg.physicsTime is the current snapshot's serverTime if it's the same
     // as the last one
@@ -727,12 +880,14 @@ void CG_PredictPlayerState( void )
         cg.lastPredictedCommand = 0;
         cg.stateTail = cg.stateHead;
         predictCmd = current - CMD_BACKUP + 1;
+        cg.predictFull++;
       }
     }
 
     // keep track of the server time of the last snapshot so we
     // know when we're starting from a new one in future calls
     cg.lastServerTime = cg.physicsTime;
+    cg.lastSolidSignature = cg.solidSignature;
     stateIndex = cg.stateHead;
   }
 
@@ -832,11 +987,13 @@ void CG_PredictPlayerState( void )
     if( !cg_optimizePrediction.integer )
     {
       Pmove( &cg_pmove );
+      cg.predictReplayed++;
     }
     else if( cg_optimizePrediction.integer && ( cmdNum >= predictCmd ||
       ( stateIndex + 1 ) % NUM_SAVED_STATES == cg.stateHead ) )
     {
       Pmove( &cg_pmove );
+      cg.predictReplayed++;
       // record the last predicted command
       cg.lastPredictedCommand = cmdNum;
 
@@ -854,6 +1011,7 @@ void CG_PredictPlayerState( void )
     {
       *cg_pmove.ps = cg.savedPmoveStates[ stateIndex ];
       stateIndex = ( stateIndex + 1 ) % NUM_SAVED_STATES;
+      cg.predictReused++;
     }
 
     moved = qtrue;
@@ -874,5 +1032,17 @@ void CG_PredictPlayerState( void )
   // fire events and other transition triggered things
   CG_TransitionPlayerState( &cg.predictedPlayerState, &oldPlayerState );
 
+  if( cg.time - cg.predictStatsTime >= 1000 || cg.time < cg.predictStatsTime )
+  {
+    if( cg_showmiss.integer >= 2 )
+    {
+      CG_Printf( "prediction: %d replayed  %d reused  %d full\n",
+                 cg.predictReplayed, cg.predictReused, cg.predictFull );
+    }
+
+    cg.predictReplayed = cg.predictReused = cg.predictFull = 0;
+    cg.predictStatsTime = cg.time;
+  }
+
 
 }
@@ -27,81 +27,225 @@ static entityPos_t   entityPositions;
 
 #define HUMAN_SCANNER_UPDATE_PERIOD 700
 
+/*
+  scanner entities
+
+  The entities the scanner can show are kept in a list per kind, updated
+  as entities enter and leave the PVS or change between snapshots, so
+  updating the scanner only looks at the entities it will draw. Each
+  update also keeps the blips within range of the scanner along with
+  their offsets from the viewer, which stay the same until the next
+  update and so are only worked out once.
+*/
+
+typedef enum
+{
+  SCANNER_NONE,
+  SCANNER_HUMAN_BUILDABLE,
+  SCANNER_ALIEN_BUILDABLE,
+  SCANNER_HUMAN_CLIENT,
+  SCANNER_ALIEN_CLIENT,
+
+  SCANNER_NUM_KINDS
+} scannerKind_t;
+
+typedef struct
+{
+  vec3_t        relOrigin;    //offset from entityPositions.origin
+  float         distance;
+  vec3_t        drawOrigin;   //relOrigin turned to the scanner, see CG_Scanner
+} scannerBlip_t;
+
+static int            scannerEntities[ SCANNER_NUM_KINDS ][ MAX_GENTITIES ];
+static int            numScannerEntities[ SCANNER_NUM_KINDS ];
+static int            scannerKind[ MAX_GENTITIES ];   //scannerKind_t of each entity
+static int            scannerSlot[ MAX_GENTITIES ];   //index into scannerEntities
+
+static scannerBlip_t  scannerBlips[ MAX_GENTITIES ];
+static int            blipStart[ SCANNER_NUM_KINDS + 1 ];
+static qboolean       blipsTurned;
+
 /*
 =============
-CG_UpdateEntityPositions
+CG_ScannerKind
 
-Update this client's perception of entity positions
+Which scanner list an entity belongs in
 =============
 */
-void CG_UpdateEntityPositions( void )
+static scannerKind_t CG_ScannerKind( centity_t *cent )
 {
-  centity_t *cent = NULL;
-  int       i;
+  entityState_t *es = &cent->currentState;
+  int           team;
 
-  if( cg.predictedPlayerState.stats[ STAT_PTEAM ] == PTE_HUMANS )
+  if( es->eType == ET_BUILDABLE )
   {
-    if( entityPositions.lastUpdateTime + HUMAN_SCANNER_UPDATE_PERIOD > cg.time )
-      return;
+    if( es->modelindex2 == BIT_ALIENS )
+      return SCANNER_ALIEN_BUILDABLE;
+    else if( es->modelindex2 == BIT_HUMANS )
+      return SCANNER_HUMAN_BUILDABLE;
   }
+  else if( es->eType == ET_PLAYER )
+  {
+    team = es->powerups & 0x00FF;
 
-  VectorCopy( cg.refdef.vieworg, entityPositions.origin );
-  VectorCopy( cg.refdefViewAngles, entityPositions.vangles );
-  entityPositions.lastUpdateTime = cg.time;
+    if( team == PTE_ALIENS )
+      return SCANNER_ALIEN_CLIENT;
+    else if( team == PTE_HUMANS )
+      return SCANNER_HUMAN_CLIENT;
+  }
+
+  return SCANNER_NONE;
+}
 
-  entityPositions.numAlienBuildables = 0;
-  entityPositions.numHumanBuildables = 0;
-  entityPositions.numAlienClients = 0;
-  entityPositions.numHumanClients = 0;
+/*
+=============
+CG_SetScannerKind
+
+Move an entity between scanner lists
+=============
+*/
+static void CG_SetScannerKind( int num, scannerKind_t kind )
+{
+  int old = scannerKind[ num ];
+  int last;
 
-  for( i = 0; i < cg.snap->numEntities; i++ )
+  if( old == kind )
+    return;
+
+  if( old != SCANNER_NONE )
   {
-    cent = &cg_entities[ cg.snap->entities[ i ].number ];
+    last = scannerEntities[ old ][ --numScannerEntities[ old ] ];
+    scannerEntities[ old ][ scannerSlot[ num ] ] = last;
+    scannerSlot[ last ] = scannerSlot[ num ];
+  }
 
-    if( cent->currentState.eType == ET_BUILDABLE )
-    {
-      //TA: add to list of item positions (for creep)
-      if( cent->currentState.modelindex2 == BIT_ALIENS )
-      {
-        VectorCopy( cent->lerpOrigin, entityPositions.alienBuildablePos[
-            entityPositions.numAlienBuildables ] );
-        entityPositions.alienBuildableTimes[
-            entityPositions.numAlienBuildables ] = cent->miscTime;
+  if( kind != SCANNER_NONE )
+  {
+    scannerSlot[ num ] = numScannerEntities[ kind ];
+    scannerEntities[ kind ][ numScannerEntities[ kind ]++ ] = num;
+  }
 
-        if( entityPositions.numAlienBuildables < MAX_GENTITIES )
-          entityPositions.numAlienBuildables++;
-      }
-      else if( cent->currentState.modelindex2 == BIT_HUMANS )
-      {
-        VectorCopy( cent->lerpOrigin, entityPositions.humanBuildablePos[
-            entityPositions.numHumanBuildables ] );
+  scannerKind[ num ] = kind;
+}
 
-        if( entityPositions.numHumanBuildables < MAX_GENTITIES )
-          entityPositions.numHumanBuildables++;
-      }
-    }
-    else if( cent->currentState.eType == ET_PLAYER )
-    {
-      int team = cent->currentState.powerups & 0x00FF;
+/*
+=============
+CG_ScannerTrackEntity
 
-      if( team == PTE_ALIENS )
-      {
-        VectorCopy( cent->lerpOrigin, entityPositions.alienClientPos[
-            entityPositions.numAlienClients ] );
+Called when an entity enters the PVS or its state changes
+=============
+*/
+void CG_ScannerTrackEntity( centity_t *cent )
+{
+  CG_SetScannerKind( cent - cg_entities, CG_ScannerKind( cent ) );
+}
 
-        if( entityPositions.numAlienClients < MAX_CLIENTS )
-          entityPositions.numAlienClients++;
-      }
-      else if( team == PTE_HUMANS )
-      {
-        VectorCopy( cent->lerpOrigin, entityPositions.humanClientPos[
-            entityPositions.numHumanClients ] );
+/*
+=============
+CG_ScannerForgetEntity
 
-        if( entityPositions.numHumanClients < MAX_CLIENTS )
-          entityPositions.numHumanClients++;
-      }
-    }
+Called when an entity leaves the PVS
+=============
+*/
+void CG_ScannerForgetEntity( centity_t *cent )
+{
+  CG_SetScannerKind( cent - cg_entities, SCANNER_NONE );
+}
+
+/*
+=============
+CG_CopyScannerPositions
+
+Fill one of the entityPositions lists from a scanner list
+=============
+*/
+static int CG_CopyScannerPositions( scannerKind_t kind, vec3_t *pos, int *times, int max )
+{
+  int       i, num = 0;
+  centity_t *cent;
+
+  for( i = 0; i < numScannerEntities[ kind ] && num < max; i++ )
+  {
+    cent = &cg_entities[ scannerEntities[ kind ][ i ] ];
+
+    VectorCopy( cent->lerpOrigin, pos[ num ] );
+
+    if( times )
+      times[ num ] = cent->miscTime;
+
+    num++;
+  }
+
+  return num;
+}
+
+/*
+=============
+CG_AddScannerBlips
+
+Keep the positions in range of the scanner as blips
+=============
+*/
+static void CG_AddScannerBlips( scannerKind_t kind, vec3_t *pos, int num )
+{
+  int           i, numBlips = blipStart[ kind ];
+  scannerBlip_t *blip;
+  float         range = MAX( HELMET_RANGE, ALIENSENSE_RANGE );
+
+  for( i = 0; i < num; i++ )
+  {
+    blip = &scannerBlips[ numBlips ];
+
+    VectorSubtract( pos[ i ], entityPositions.origin, blip->relOrigin );
+    blip->distance = VectorLength( blip->relOrigin );
+
+    if( blip->distance < range )
+      numBlips++;
+  }
+
+  blipStart[ kind + 1 ] = numBlips;
+}
+
+/*
+=============
+CG_UpdateEntityPositions
+
+Update this client's perception of entity positions
+=============
+*/
+void CG_UpdateEntityPositions( void )
+{
+  if( cg.predictedPlayerState.stats[ STAT_PTEAM ] == PTE_HUMANS )
+  {
+    if( entityPositions.lastUpdateTime + HUMAN_SCANNER_UPDATE_PERIOD > cg.time )
+      return;
   }
+
+  VectorCopy( cg.refdef.vieworg, entityPositions.origin );
+  VectorCopy( cg.refdefViewAngles, entityPositions.vangles );
+  entityPositions.lastUpdateTime = cg.time;
+
+  //TA: alien buildable positions are also used for creep
+  entityPositions.numAlienBuildables = CG_CopyScannerPositions( SCANNER_ALIEN_BUILDABLE,
+      entityPositions.alienBuildablePos, entityPositions.alienBuildableTimes, MAX_GENTITIES );
+  entityPositions.numHumanBuildables = CG_CopyScannerPositions( SCANNER_HUMAN_BUILDABLE,
+      entityPositions.humanBuildablePos, NULL, MAX_GENTITIES );
+  entityPositions.numAlienClients = CG_CopyScannerPositions( SCANNER_ALIEN_CLIENT,
+      entityPositions.alienClientPos, NULL, MAX_CLIENTS );
+  entityPositions.numHumanClients = CG_CopyScannerPositions( SCANNER_HUMAN_CLIENT,
+      entityPositions.humanClientPos, NULL, MAX_CLIENTS );
+
+  blipStart[ SCANNER_HUMAN_BUILDABLE ] = 0;
+  CG_AddScannerBlips( SCANNER_HUMAN_BUILDABLE, entityPositions.humanBuildablePos,
+                      entityPositions.numHumanBuildables );
+  CG_AddScannerBlips( SCANNER_ALIEN_BUILDABLE, entityPositions.alienBuildablePos,
+                      entityPositions.numAlienBuildables );
+  CG_AddScannerBlips( SCANNER_HUMAN_CLIENT, entityPositions.humanClientPos,
+                      entityPositions.numHumanClients );
+  CG_AddScannerBlips( SCANNER_ALIEN_CLIENT, entityPositions.alienClientPos,
+                      entityPositions.numAlienClients );
+
+  blipsTurned = qfalse;
 }
 
 #define STALKWIDTH  2.0f
@@ -120,7 +264,6 @@ Draw blips and stalks for the human scanner
 static void CG_DrawBlips( rectDef_t *rect, vec3_t origin, vec4_t colour )
 {
   vec3_t  drawOrigin;
-  vec3_t  up = { 0, 0, 1 };
   float   alphaMod = 1.0f;
   float   timeFractionSinceRefresh = 1.0f -
     ( (float)( cg.time - entityPositions.lastUpdateTime ) /
@@ -129,7 +272,7 @@ static void CG_DrawBlips( rectDef_t *rect, vec3_t origin, vec4_t colour )
 
   Vector4Copy( colour, localColour );
 
-  RotatePointAroundVector( drawOrigin, up, origin, -entityPositions.vangles[ 1 ] - 90 );
+  VectorCopy( origin, drawOrigin );
   drawOrigin[ 0 ] /= ( 2 * HELMET_RANGE / rect->w );
   drawOrigin[ 1 ] /= ( 2 * HELMET_RANGE / rect->h );
   drawOrigin[ 2 ] /= ( 2 * HELMET_RANGE / rect->w );
@@ -172,33 +315,18 @@ CG_DrawDir
 Draw dot marking the direction to an enemy
 =============
 */
-static void CG_DrawDir( rectDef_t *rect, vec3_t origin, vec4_t colour )
+static void CG_DrawDir( rectDef_t *rect, vec3_t origin, vec3_t normal,
+                        vec3_t noZview, vec4_t colour )
 {
   vec3_t  drawOrigin;
   vec3_t  noZOrigin;
-  vec3_t  normal, antinormal, normalDiff;
-  vec3_t  view, noZview;
+  vec3_t  antinormal, normalDiff;
   vec3_t  up  = { 0.0f, 0.0f,   1.0f };
   vec3_t  top = { 0.0f, -1.0f,  0.0f };
   float   angle;
-  playerState_t *ps = &cg.snap->ps;
-
-  if( ps->stats[ STAT_STATE ] & SS_WALLCLIMBING )
-  {
-    if( ps->stats[ STAT_STATE ] & SS_WALLCLIMBINGCEILING )
-      VectorSet( normal, 0.0f, 0.0f, -1.0f );
-    else
-      VectorCopy( ps->grapplePoint, normal );
-  }
-  else
-    VectorSet( normal, 0.0f, 0.0f, 1.0f );
-
-  AngleVectors( entityPositions.vangles, view, NULL, NULL );
 
   ProjectPointOnPlane( noZOrigin, origin, normal );
-  ProjectPointOnPlane( noZview, view, normal );
   VectorNormalize( noZOrigin );
-  VectorNormalize( noZview );
 
   //calculate the angle between the images of the blip and the view
   angle = RAD2DEG( acos( DotProduct( noZOrigin, noZview ) ) );
@@ -226,32 +354,70 @@ CG_AlienSense
 */
 void CG_AlienSense( rectDef_t *rect )
 {
-  int     i;
-  vec3_t  origin;
-  vec3_t  relOrigin;
-  vec4_t  buildable = { 1.0f, 0.0f, 0.0f, 0.7f };
-  vec4_t  client    = { 0.0f, 0.0f, 1.0f, 0.7f };
+  int           i;
+  vec3_t        normal, view, noZview;
+  vec4_t        buildable = { 1.0f, 0.0f, 0.0f, 0.7f };
+  vec4_t        client    = { 0.0f, 0.0f, 1.0f, 0.7f };
+  playerState_t *ps = &cg.snap->ps;
 
-  VectorCopy( entityPositions.origin, origin );
+  if( ps->stats[ STAT_STATE ] & SS_WALLCLIMBING )
+  {
+    if( ps->stats[ STAT_STATE ] & SS_WALLCLIMBINGCEILING )
+      VectorSet( normal, 0.0f, 0.0f, -1.0f );
+    else
+      VectorCopy( ps->grapplePoint, normal );
+  }
+  else
+    VectorSet( normal, 0.0f, 0.0f, 1.0f );
+
+  AngleVectors( entityPositions.vangles, view, NULL, NULL );
+  ProjectPointOnPlane( noZview, view, normal );
+  VectorNormalize( noZview );
 
   //draw human buildables
-  for( i = 0; i < entityPositions.numHumanBuildables; i++ )
+  for( i = blipStart[ SCANNER_HUMAN_BUILDABLE ]; i < blipStart[ SCANNER_HUMAN_BUILDABLE + 1 ]; i++ )
   {
-    VectorClear( relOrigin );
-    VectorSubtract( entityPositions.humanBuildablePos[ i ], origin, relOrigin );
-
-    if( VectorLength( relOrigin ) < ALIENSENSE_RANGE )
-      CG_DrawDir( rect, relOrigin, buildable );
+    if( scannerBlips[ i ].distance < ALIENSENSE_RANGE )
+      CG_DrawDir( rect, scannerBlips[ i ].relOrigin, normal, noZview, buildable );
   }
 
   //draw human clients
-  for( i = 0; i < entityPositions.numHumanClients; i++ )
+  for( i = blipStart[ SCANNER_HUMAN_CLIENT ]; i < blipStart[ SCANNER_HUMAN_CLIENT + 1 ]; i++ )
   {
-    VectorClear( relOrigin );
-    VectorSubtract( entityPositions.humanClientPos[ i ], origin, relOrigin );
+    if( scannerBlips[ i ].distance < ALIENSENSE_RANGE )
+      CG_DrawDir( rect, scannerBlips[ i ].relOrigin, normal, noZview, client );
+  }
+}
+
+/*
+=============
+CG_DrawScannerBlips
+
+Draw the scanner blips on one side of the scanner plane
+=============
+*/
+static void CG_DrawScannerBlips( rectDef_t *rect, qboolean above,
+                                 vec4_t human, vec4_t alien )
+{
+  int           i, kind;
+  scannerBlip_t *blip;
+
+  for( kind = SCANNER_HUMAN_BUILDABLE; kind < SCANNER_NUM_KINDS; kind++ )
+  {
+    for( i = blipStart[ kind ]; i < blipStart[ kind + 1 ]; i++ )
+    {
+      blip = &scannerBlips[ i ];
 
-    if( VectorLength( relOrigin ) < ALIENSENSE_RANGE )
-      CG_DrawDir( rect, relOrigin, client );
+      if( blip->distance >= HELMET_RANGE )
+        continue;
+
+      if( above ? ( blip->relOrigin[ 2 ] > 0 ) : ( blip->relOrigin[ 2 ] < 0 ) )
+      {
+        CG_DrawBlips( rect, blip->drawOrigin,
+          ( kind == SCANNER_HUMAN_BUILDABLE || kind == SCANNER_HUMAN_CLIENT ) ?
+          human : alien );
+      }
+    }
   }
 }
 
@@ -263,8 +429,7 @@ CG_Scanner
 void CG_Scanner( rectDef_t *rect, qhandle_t shader, vec4_t color )
 {
   int     i;
-  vec3_t  origin;
-  vec3_t  relOrigin;
+  vec3_t  up = { 0, 0, 1 };
   vec4_t  hIabove;
   vec4_t  hIbelow;
   vec4_t  aIabove = { 1.0f, 0.0f, 0.0f, 0.75f };
@@ -274,47 +439,20 @@ void CG_Scanner( rectDef_t *rect, qhandle_t shader, vec4_t color )
   hIabove[ 3 ] *= 1.5f;
   Vector4Copy( color, hIbelow );
 
-  VectorCopy( entityPositions.origin, origin );
-
-  //draw human buildables below scanner plane
-  for( i = 0; i < entityPositions.numHumanBuildables; i++ )
-  {
-    VectorClear( relOrigin );
-    VectorSubtract( entityPositions.humanBuildablePos[ i ], origin, relOrigin );
-
-    if( VectorLength( relOrigin ) < HELMET_RANGE && ( relOrigin[ 2 ] < 0 ) )
-      CG_DrawBlips( rect, relOrigin, hIbelow );
-  }
-
-  //draw alien buildables below scanner plane
-  for( i = 0; i < entityPositions.numAlienBuildables; i++ )
-  {
-    VectorClear( relOrigin );
-    VectorSubtract( entityPositions.alienBuildablePos[ i ], origin, relOrigin );
-
-    if( VectorLength( relOrigin ) < HELMET_RANGE && ( relOrigin[ 2 ] < 0 ) )
-      CG_DrawBlips( rect, relOrigin, aIbelow );
-  }
-
-  //draw human clients below scanner plane
-  for( i = 0; i < entityPositions.numHumanClients; i++ )
+  //turn the blips to face the way the viewer was looking at the last update
+  if( !blipsTurned )
   {
-    VectorClear( relOrigin );
-    VectorSubtract( entityPositions.humanClientPos[ i ], origin, relOrigin );
+    for( i = 0; i < blipStart[ SCANNER_NUM_KINDS ]; i++ )
+    {
+      RotatePointAroundVector( scannerBlips[ i ].drawOrigin, up,
+                               scannerBlips[ i ].relOrigin, -entityPositions.vangles[ 1 ] - 90 );
+    }
 
-    if( VectorLength( relOrigin ) < HELMET_RANGE && ( relOrigin[ 2 ] < 0 ) )
-      CG_DrawBlips( rect, relOrigin, hIbelow );
+    blipsTurned = qtrue;
   }
 
-  //draw alien buildables below scanner plane
-  for( i = 0; i < entityPositions.numAlienClients; i++ )
-  {
-    VectorClear( relOrigin );
-    VectorSubtract( entityPositions.alienClientPos[ i ], origin, relOrigin );
-
-    if( VectorLength( relOrigin ) < HELMET_RANGE && ( relOrigin[ 2 ] < 0 ) )
-      CG_DrawBlips( rect, relOrigin, aIbelow );
-  }
+  //draw blips below scanner plane
+  CG_DrawScannerBlips( rect, qfalse, hIbelow, aIbelow );
 
   if( !cg_disableScannerPlane.integer )
   {
@@ -323,43 +461,6 @@ void CG_Scanner( rectDef_t *rect, qhandle_t shader, vec4_t color )
     trap_R_SetColor( NULL );
   }
 
-  //draw human buildables above scanner plane
-  for( i = 0; i < entityPositions.numHumanBuildables; i++ )
-  {
-    VectorClear( relOrigin );
-    VectorSubtract( entityPositions.humanBuildablePos[ i ], origin, relOrigin );
-
-    if( VectorLength( relOrigin ) < HELMET_RANGE && ( relOrigin[ 2 ] > 0 ) )
-      CG_DrawBlips( rect, relOrigin, hIabove );
-  }
-
-  //draw alien buildables above scanner plane
-  for( i = 0; i < entityPositions.numAlienBuildables; i++ )
-  {
-    VectorClear( relOrigin );
-    VectorSubtract( entityPositions.alienBuildablePos[ i ], origin, relOrigin );
-
-    if( VectorLength( relOrigin ) < HELMET_RANGE && ( relOrigin[ 2 ] > 0 ) )
-      CG_DrawBlips( rect, relOrigin, aIabove );
-  }
-
-  //draw human clients above scanner plane
-  for( i = 0; i < entityPositions.numHumanClients; i++ )
-  {
-    VectorClear( relOrigin );
-    VectorSubtract( entityPositions.humanClientPos[ i ], origin, relOrigin );
-
-    if( VectorLength( relOrigin ) < HELMET_RANGE && ( relOrigin[ 2 ] > 0 ) )
-      CG_DrawBlips( rect, relOrigin, hIabove );
-  }
-
-  //draw alien clients above scanner plane
-  for( i = 0; i < entityPositions.numAlienClients; i++ )
-  {
-    VectorClear( relOrigin );
-    VectorSubtract( entityPositions.alienClientPos[ i ], origin, relOrigin );
-
-    if( VectorLength( relOrigin ) < HELMET_RANGE && ( relOrigin[ 2 ] > 0 ) )
-      CG_DrawBlips( rect, relOrigin, aIabove );
-  }
+  //draw blips above scanner plane
+  CG_DrawScannerBlips( rect, qtrue, hIabove, aIabove );
 }
@@ -945,8 +945,13 @@ static void CG_ServerCommand( void )
     if( CG_IsParticleSystemValid( &cg.poisonCloudPS ) )
     {
       cg.poisonCloudPS = CG_SpawnNewParticleSystem( cgs.media.poisonCloudPS );
-      CG_SetAttachmentCent( &cg.poisonCloudPS->attachment, &cg.predictedPlayerEntity );
-      CG_AttachToCent( &cg.poisonCloudPS->attachment );
+      CG_SetParticleSystemOwner( &cg.poisonCloudPS );
+
+      if( CG_IsParticleSystemValid( &cg.poisonCloudPS ) )
+      {
+        CG_SetAttachmentCent( &cg.poisonCloudPS->attachment, &cg.predictedPlayerEntity );
+        CG_AttachToCent( &cg.poisonCloudPS->attachment );
+      }
     }
 
     return;
@@ -60,6 +60,10 @@ static void CG_TransitionEntity( centity_t *cent )
   cent->currentState = cent->nextState;
   cent->currentValid = qtrue;
 
+  // the entity may have changed team or type without leaving the PVS
+  if( cent->oldValid )
+    CG_ScannerTrackEntity( cent );
+
   // reset if the entity wasn't in the last frame or was teleported
   if( !cent->interpolate )
     CG_ResetEntity( cent );
@@ -112,6 +116,9 @@ void CG_SetInitialSnapshot( snapshot_t *snap )
     cent->interpolate = qfalse;
     cent->currentValid = qtrue;
 
+    if( cent->oldValid )
+      CG_ScannerTrackEntity( cent );
+
     CG_ResetEntity( cent );
 
     // check for events
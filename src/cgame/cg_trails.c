@@ -130,11 +130,45 @@ static void CG_LightVertex( vec3_t point, byte alpha, byte *rgba )
   rgba[ 3 ] = alpha;
 }
 
+/*
+  beam batching
+
+  Beams are drawn in shader order and consecutive beams sharing a shader
+  are submitted to the renderer together. A batch never holds more than
+  one full length beam, so it can't overflow the renderer's poly limits
+  any sooner than submitting beams one by one did.
+*/
+
+#define TRAIL_BATCH_VERTS ( ( MAX_TRAIL_BEAM_NODES - 1 ) * 4 )
+
+static polyVert_t   batchVerts[ TRAIL_BATCH_VERTS ];
+static int          numBatchVerts;
+static qhandle_t    batchShader;
+static int          numBatches;
+
+/*
+===============
+CG_FlushBeamBatch
+
+Submits the beam polys collected so far
+===============
+*/
+static void CG_FlushBeamBatch( void )
+{
+  if( numBatchVerts )
+  {
+    trap_R_AddPolysToScene( batchShader, 4, &batchVerts[ 0 ], numBatchVerts / 4 );
+    numBatches++;
+  }
+
+  numBatchVerts = 0;
+}
+
 /*
 ===============
 CG_RenderBeam
 
-Renders a beam
+Adds a beam to the current batch
 ===============
 */
 static void CG_RenderBeam( trailBeam_t *tb )
@@ -143,8 +177,8 @@ static void CG_RenderBeam( trailBeam_t *tb )
   trailBeamNode_t   *prev = NULL;
   trailBeamNode_t   *next = NULL;
   vec3_t            up;
-  polyVert_t        verts[ ( MAX_TRAIL_BEAM_NODES - 1 ) * 4 ];
-  int               numVerts = 0;
+  polyVert_t        *verts = batchVerts;
+  int               numVerts;
   baseTrailBeam_t   *btb;
   trailSystem_t     *ts;
   baseTrailSystem_t *bts;
@@ -164,6 +198,14 @@ static void CG_RenderBeam( trailBeam_t *tb )
 
   CG_CalculateBeamNodeProperties( tb );
 
+  if( btb->shader != batchShader ||
+      numBatchVerts + ( tb->numNodes - 1 ) * 4 > TRAIL_BATCH_VERTS )
+  {
+    CG_FlushBeamBatch( );
+    batchShader = btb->shader;
+  }
+
+  numVerts = numBatchVerts;
   i = tb->nodes;
 
   do
@@ -254,80 +296,27 @@ static void CG_RenderBeam( trailBeam_t *tb )
     i = i->next;
   } while( i );
 
-  trap_R_AddPolysToScene( tb->class->shader, 4, &verts[ 0 ], numVerts / 4 );
-}
-
-/*
-===============
-CG_AllocateBeamNode
-
-Allocates a trailBeamNode_t from a trailBeam_t's nodePool
-===============
-*/
-static trailBeamNode_t *CG_AllocateBeamNode( trailBeam_t *tb )
-{
-  baseTrailBeam_t *btb = tb->class;
-  int             i;
-  trailBeamNode_t *tbn;
-
-  for( i = 0; i < MAX_TRAIL_BEAM_NODES; i++ )
-  {
-    tbn = &tb->nodePool[ i ];
-    if( !tbn->used )
-    {
-      tbn->timeLeft = btb->segmentTime;
-      tbn->prev = NULL;
-      tbn->next = NULL;
-      tbn->used = qtrue;
-      return tbn;
-    }
-  }
-
-  // no space left
-  return NULL;
+  numBatchVerts = numVerts;
 }
 
 /*
 ===============
-CG_DestroyBeamNode
+CG_InitBeamNode
 
-Removes a node from a beam
-Returns the new head
+Claims a slot of a trailBeam_t's nodePool
 ===============
 */
-static trailBeamNode_t *CG_DestroyBeamNode( trailBeamNode_t *tbn )
+static trailBeamNode_t *CG_InitBeamNode( trailBeam_t *tb, int index )
 {
-  trailBeamNode_t *newHead = NULL;
-
-  if( tbn->prev )
-  {
-    if( tbn->next )
-    {
-      // node is in the middle
-      tbn->prev->next = tbn->next;
-      tbn->next->prev = tbn->prev;
-    }
-    else // node is at the back
-      tbn->prev->next = NULL;
-
-    // find the new head (shouldn't have changed)
-    newHead = tbn->prev;
-
-    while( newHead->prev )
-      newHead = newHead->prev;
-  }
-  else if( tbn->next )
-  {
-    //node is at the front
-    tbn->next->prev = NULL;
-    newHead = tbn->next;
-  }
+  trailBeamNode_t *tbn = &tb->nodePool[ index ];
 
+  tbn->timeLeft = tb->class->segmentTime;
   tbn->prev = NULL;
   tbn->next = NULL;
-  tbn->used = qfalse;
 
-  return newHead;
+  tb->numNodes++;
+
+  return tbn;
 }
 
 /*
@@ -339,12 +328,10 @@ Returns the last beam node in a beam
 */
 static trailBeamNode_t *CG_FindLastBeamNode( trailBeam_t *tb )
 {
-  trailBeamNode_t *i = tb->nodes;
-
-  while( i && i->next )
-    i = i->next;
+  if( !tb->numNodes )
+    return NULL;
 
-  return i;
+  return &tb->nodePool[ ( tb->firstNode + tb->numNodes - 1 ) % MAX_TRAIL_BEAM_NODES ];
 }
 
 /*
@@ -356,16 +343,30 @@ Returns the number of nodes in a beam
 */
 static int CG_CountBeamNodes( trailBeam_t *tb )
 {
-  trailBeamNode_t *i = tb->nodes;
-  int             numNodes = 0;
+  return tb->numNodes;
+}
 
-  while( i )
-  {
-    numNodes++;
-    i = i->next;
-  }
+/*
+===============
+CG_DestroyLastBeamNode
+
+Removes the last node from a beam
+===============
+*/
+static void CG_DestroyLastBeamNode( trailBeam_t *tb )
+{
+  trailBeamNode_t *last = CG_FindLastBeamNode( tb );
+
+  if( !last )
+    return;
+
+  if( last->prev )
+    last->prev->next = NULL;
 
-  return numNodes;
+  last->prev = NULL;
+
+  if( !--tb->numNodes )
+    tb->nodes = NULL;
 }
 
 /*
@@ -380,25 +381,21 @@ static trailBeamNode_t *CG_PrependBeamNode( trailBeam_t *tb )
 {
   trailBeamNode_t *i;
 
+  // no space left
+  if( tb->numNodes >= MAX_TRAIL_BEAM_NODES )
+    return NULL;
+
+  tb->firstNode = ( tb->firstNode + MAX_TRAIL_BEAM_NODES - 1 ) % MAX_TRAIL_BEAM_NODES;
+  i = CG_InitBeamNode( tb, tb->firstNode );
+
   if( tb->nodes )
   {
     // prepend another node
-    i = CG_AllocateBeamNode( tb );
-
-    if( i )
-    {
-      i->next = tb->nodes;
-      tb->nodes->prev = i;
-      tb->nodes = i;
-    }
+    i->next = tb->nodes;
+    tb->nodes->prev = i;
   }
-  else //add first node
-  {
-    i = CG_AllocateBeamNode( tb );
 
-    if( i )
-      tb->nodes = i;
-  }
+  tb->nodes = i;
 
   return i;
 }
@@ -415,26 +412,21 @@ static trailBeamNode_t *CG_AppendBeamNode( trailBeam_t *tb )
 {
   trailBeamNode_t *last, *i;
 
-  if( tb->nodes )
+  // no space left
+  if( tb->numNodes >= MAX_TRAIL_BEAM_NODES )
+    return NULL;
+
+  last = CG_FindLastBeamNode( tb );
+  i = CG_InitBeamNode( tb, ( tb->firstNode + tb->numNodes ) % MAX_TRAIL_BEAM_NODES );
+
+  if( last )
   {
     // append another node
-    last = CG_FindLastBeamNode( tb );
-    i = CG_AllocateBeamNode( tb );
-
-    if( i )
-    {
-      last->next = i;
-      i->prev = last;
-      i->next = NULL;
-    }
+    last->next = i;
+    i->prev = last;
   }
   else //add first node
-  {
-    i = CG_AllocateBeamNode( tb );
-
-    if( i )
-      tb->nodes = i;
-  }
+    tb->nodes = i;
 
   return i;
 }
@@ -622,7 +614,7 @@ static void CG_UpdateBeam( trailBeam_t *tb )
 
       if( i->timeLeft < 0 )
       {
-        tb->nodes = CG_DestroyBeamNode( i );
+        CG_DestroyLastBeamNode( tb );
 
         if( !tb->nodes )
         {
@@ -1259,6 +1251,56 @@ static trailBeam_t *CG_SpawnNewTrailBeam( baseTrailBeam_t *btb,
 }
 
 
+static int trailsEvicted; //systems dropped since the last CG_AddTrails
+
+/*
+===============
+CG_EvictTrailSystem
+
+Free the slot of the least important trail system that has already
+been destroyed by its owner and is only fading out
+===============
+*/
+static trailSystem_t *CG_EvictTrailSystem( void )
+{
+  int           i;
+  trailSystem_t *ts, *victim = NULL;
+  float         lod, victimLOD = 0.0f;
+
+  for( i = 0; i < MAX_TRAIL_SYSTEMS; i++ )
+  {
+    ts = &trailSystems[ i ];
+
+    if( !ts->valid || ts->destroyTime < 0 )
+      continue;
+
+    lod = CG_EffectLOD( &ts->frontAttachment, 0.0f );
+
+    if( !victim || lod > victimLOD )
+    {
+      victim = ts;
+      victimLOD = lod;
+    }
+  }
+
+  if( !victim )
+    return NULL;
+
+  for( i = 0; i < MAX_TRAIL_BEAMS; i++ )
+  {
+    if( trailBeams[ i ].parent == victim )
+      trailBeams[ i ].valid = qfalse;
+  }
+
+  if( cg_debugTrails.integer >= 1 )
+    CG_Printf( "TS %s evicted\n", victim->class->name );
+
+  victim->valid = qfalse;
+  trailsEvicted++;
+
+  return victim;
+}
+
 /*
 ===============
 CG_SpawnNewTrailSystem
@@ -1280,27 +1322,33 @@ trailSystem_t *CG_SpawnNewTrailSystem( qhandle_t psHandle )
 
   for( i = 0; i < MAX_TRAIL_SYSTEMS; i++ )
   {
+    if( !trailSystems[ i ].valid )
+      break;
+  }
+
+  if( i < MAX_TRAIL_SYSTEMS )
     ts = &trailSystems[ i ];
+  else if( ( ts = CG_EvictTrailSystem( ) ) == NULL )
+  {
+    if( cg_debugTrails.integer >= 1 )
+      CG_Printf( "TS %s dropped, no free slots\n", bts->name );
 
-    if( !ts->valid )
-    {
-      memset( ts, 0, sizeof( trailSystem_t ) );
+    return NULL;
+  }
 
-      //found a free slot
-      ts->class = bts;
+  memset( ts, 0, sizeof( trailSystem_t ) );
 
-      ts->valid = qtrue;
-      ts->destroyTime = -1;
+  //found a free slot
+  ts->class = bts;
 
-      for( j = 0; j < bts->numBeams; j++ )
-        CG_SpawnNewTrailBeam( bts->beams[ j ], ts );
+  ts->valid = qtrue;
+  ts->destroyTime = -1;
 
-      if( cg_debugTrails.integer >= 1 )
-        CG_Printf( "TS %s created\n", bts->name );
+  for( j = 0; j < bts->numBeams; j++ )
+    CG_SpawnNewTrailBeam( bts->beams[ j ], ts );
 
-      break;
-    }
-  }
+  if( cg_debugTrails.integer >= 1 )
+    CG_Printf( "TS %s created\n", bts->name );
 
   return ts;
 }
@@ -1411,6 +1459,17 @@ static void CG_GarbageCollectTrailSystems( void )
   }
 }
 
+/*
+===============
+CG_SortBeamsByShader
+===============
+*/
+static int QDECL CG_SortBeamsByShader( const void *a, const void *b )
+{
+  return ( *(trailBeam_t **)a )->class->shader -
+         ( *(trailBeam_t **)b )->class->shader;
+}
+
 /*
 ===============
 CG_AddTrails
@@ -1422,6 +1481,8 @@ void CG_AddTrails( void )
 {
   int           i;
   trailBeam_t   *tb;
+  trailBeam_t   *beams[ MAX_TRAIL_BEAMS ];
+  int           numBeams = 0;
   int           numTS = 0, numTB = 0;
 
   //remove expired trail systems
@@ -1434,10 +1495,19 @@ void CG_AddTrails( void )
     if( tb->valid )
     {
       CG_UpdateBeam( tb );
-      CG_RenderBeam( tb );
+      beams[ numBeams++ ] = tb;
     }
   }
 
+  qsort( beams, numBeams, sizeof( trailBeam_t * ), CG_SortBeamsByShader );
+
+  numBatches = 0;
+
+  for( i = 0; i < numBeams; i++ )
+    CG_RenderBeam( beams[ i ] );
+
+  CG_FlushBeamBatch( );
+
   if( cg_debugTrails.integer >= 2 )
   {
     for( i = 0; i < MAX_TRAIL_SYSTEMS; i++ )
@@ -1448,8 +1518,11 @@ void CG_AddTrails( void )
       if( trailBeams[ i ].valid )
         numTB++;
 
-    CG_Printf( "TS: %d  TB: %d\n", numTS, numTB );
+    CG_Printf( "TS: %d  TB: %d  evicted: %d  batches: %d\n",
+               numTS, numTB, trailsEvicted, numBatches );
   }
+
+  trailsEvicted = 0;
 }
 
 static trailSystem_t  *testTS;
@@ -935,6 +935,7 @@ void CG_AddPlayerWeapon( refEntity_t *parent, playerState_t *ps, centity_t *cent
     if( weapon->wim[ weaponMode ].muzzleParticleSystem && cent->muzzlePsTrigger )
     {
       cent->muzzlePS = CG_SpawnNewParticleSystem( weapon->wim[ weaponMode ].muzzleParticleSystem );
+      CG_SetParticleSystemOwner( &cent->muzzlePS );
 
       if( CG_IsParticleSystemValid( &cent->muzzlePS ) )
       {
@@ -1029,6 +1030,7 @@ void CG_AddViewWeapon( playerState_t *ps )
     if( wi->wim[ weaponMode ].muzzleParticleSystem && cent->muzzlePsTrigger )
     {
       cent->muzzlePS = CG_SpawnNewParticleSystem( wi->wim[ weaponMode ].muzzleParticleSystem );
+      CG_SetParticleSystemOwner( &cent->muzzlePS );
 
       if( CG_IsParticleSystemValid( &cent->muzzlePS ) )
       {
@@ -635,6 +635,42 @@ int   bg_numBuildables = sizeof( bg_buildableList ) / sizeof( bg_buildableList[
 //separate from bg_buildableList to work around char struct init bug
 buildableAttributeOverrides_t bg_buildableOverrideList[ BA_NUM_BUILDABLES ];
 
+//bg_buildableIndex[ n ] is the position of n in bg_buildableList, built on first lookup
+static int      bg_buildableIndex[ BA_NUM_BUILDABLES ];
+static qboolean bg_buildableIndexed = qfalse;
+
+/*
+==============
+BG_BuildableIndex
+
+Map an enum value to its bg_buildableList entry, or -1 if there isn't one
+==============
+*/
+static int BG_BuildableIndex( int n )
+{
+  int i;
+
+  if( !bg_buildableIndexed )
+  {
+    for( i = 0; i < BA_NUM_BUILDABLES; i++ )
+      bg_buildableIndex[ i ] = -1;
+
+    //first entry wins, as with the old linear scans
+    for( i = bg_numBuildables - 1; i >= 0; i-- )
+    {
+      if( bg_buildableList[ i ].buildNum >= 0 && bg_buildableList[ i ].buildNum < BA_NUM_BUILDABLES )
+        bg_buildableIndex[ bg_buildableList[ i ].buildNum ] = i;
+    }
+
+    bg_buildableIndexed = qtrue;
+  }
+
+  if( n < 0 || n >= BA_NUM_BUILDABLES )
+    return -1;
+
+  return bg_buildableIndex[ n ];
+}
+
 /*
 ==============
 BG_FindBuildNumForName
@@ -682,11 +718,8 @@ char *BG_FindNameForBuildable( int bclass )
 {
   int i;
 
-  for( i = 0; i < bg_numBuildables; i++ )
-  {
-    if( bg_buildableList[ i ].buildNum == bclass )
-      return bg_buildableList[ i ].buildName;
-  }
+  if( ( i = BG_BuildableIndex( bclass ) ) >= 0 )
+    return bg_buildableList[ i ].buildName;
 
   //wimp out
   return 0;
@@ -701,11 +734,8 @@ char *BG_FindHumanNameForBuildable( int bclass )
 {
   int i;
 
-  for( i = 0; i < bg_numBuildables; i++ )
-  {
-    if( bg_buildableList[ i ].buildNum == bclass )
-      return bg_buildableList[ i ].humanName;
-  }
+  if( ( i = BG_BuildableIndex( bclass ) ) >= 0 )
+    return bg_buildableList[ i ].humanName;
 
   //wimp out
   return 0;
@@ -720,11 +750,8 @@ char *BG_FindEntityNameForBuildable( int bclass )
 {
   int i;
 
-  for( i = 0; i < bg_numBuildables; i++ )
-  {
-    if( bg_buildableList[ i ].buildNum == bclass )
-      return bg_buildableList[ i ].entityName;
-  }
+  if( ( i = BG_BuildableIndex( bclass ) ) >= 0 )
+    return bg_buildableList[ i ].entityName;
 
   //wimp out
   return 0;
@@ -742,11 +769,8 @@ char *BG_FindModelsForBuildable( int bclass, int modelNum )
   if( bg_buildableOverrideList[ bclass ].models[ modelNum ][ 0 ] != 0 )
     return bg_buildableOverrideList[ bclass ].models[ modelNum ];
 
-  for( i = 0; i < bg_numBuildables; i++ )
-  {
-    if( bg_buildableList[ i ].buildNum == bclass )
-      return bg_buildableList[ i ].models[ modelNum ];
-  }
+  if( ( i = BG_BuildableIndex( bclass ) ) >= 0 )
+    return bg_buildableList[ i ].models[ modelNum ];
 
   //wimp out
   return 0;
@@ -764,11 +788,8 @@ float BG_FindModelScaleForBuildable( int bclass )
   if( bg_buildableOverrideList[ bclass ].modelScale != 0.0f )
     return bg_buildableOverrideList[ bclass ].modelScale;
 
-  for( i = 0; i < bg_numBuildables; i++ )
-  {
-    if( bg_buildableList[ i ].buildNum == bclass )
-      return bg_buildableList[ i ].modelScale;
-  }
+  if( ( i = BG_BuildableIndex( bclass ) ) >= 0 )
+    return bg_buildableList[ i ].modelScale;
 
   Com_Printf( S_COLOR_YELLOW "WARNING: fallthrough in BG_FindModelScaleForBuildable( %d )\n", bclass );
   return 1.0f;
@@ -783,28 +804,25 @@ void BG_FindBBoxForBuildable( int bclass, vec3_t mins, vec3_t maxs )
 {
   int i;
 
-  for( i = 0; i < bg_numBuildables; i++ )
+  if( ( i = BG_BuildableIndex( bclass ) ) >= 0 )
   {
-    if( bg_buildableList[ i ].buildNum == bclass )
+    if( mins != NULL )
     {
-      if( mins != NULL )
-      {
-        VectorCopy( bg_buildableList[ i ].mins, mins );
-
-        if( VectorLength( bg_buildableOverrideList[ bclass ].mins ) )
-          VectorCopy( bg_buildableOverrideList[ bclass ].mins, mins );
-      }
+      VectorCopy( bg_buildableList[ i ].mins, mins );
 
-      if( maxs != NULL )
-      {
-        VectorCopy( bg_buildableList[ i ].maxs, maxs );
+      if( VectorLength( bg_buildableOverrideList[ bclass ].mins ) )
+        VectorCopy( bg_buildableOverrideList[ bclass ].mins, mins );
+    }
 
-        if( VectorLength( bg_buildableOverrideList[ bclass ].maxs ) )
-          VectorCopy( bg_buildableOverrideList[ bclass ].maxs, maxs );
-      }
+    if( maxs != NULL )
+    {
+      VectorCopy( bg_buildableList[ i ].maxs, maxs );
 
-      return;
+      if( VectorLength( bg_buildableOverrideList[ bclass ].maxs ) )
+        VectorCopy( bg_buildableOverrideList[ bclass ].maxs, maxs );
     }
+
+    return;
   }
 
   if( mins != NULL )
@@ -826,12 +844,9 @@ float BG_FindZOffsetForBuildable( int bclass )
   if( bg_buildableOverrideList[ bclass ].zOffset != 0.0f )
     return bg_buildableOverrideList[ bclass ].zOffset;
 
-  for( i = 0; i < bg_numBuildables; i++ )
+  if( ( i = BG_BuildableIndex( bclass ) ) >= 0 )
   {
-    if( bg_buildableList[ i ].buildNum == bclass )
-    {
-      return bg_buildableList[ i ].zOffset;
-    }
+    return bg_buildableList[ i ].zOffset;
   }
 
   return 0.0f;
@@ -846,12 +861,9 @@ trType_t BG_FindTrajectoryForBuildable( int bclass )
 {
   int i;
 
-  for( i = 0; i < bg_numBuildables; i++ )
+  if( ( i = BG_BuildableIndex( bclass ) ) >= 0 )
   {
-    if( bg_buildableList[ i ].buildNum == bclass )
-    {
-      return bg_buildableList[ i ].traj;
-    }
+    return bg_buildableList[ i ].traj;
   }
 
   return TR_GRAVITY;
@@ -866,12 +878,9 @@ float BG_FindBounceForBuildable( int bclass )
 {
   int i;
 
-  for( i = 0; i < bg_numBuildables; i++ )
+  if( ( i = BG_BuildableIndex( bclass ) ) >= 0 )
   {
-    if( bg_buildableList[ i ].buildNum == bclass )
-    {
-      return bg_buildableList[ i ].bounce;
-    }
+    return bg_buildableList[ i ].bounce;
   }
 
   return 0.0;
@@ -886,12 +895,9 @@ int BG_FindBuildPointsForBuildable( int bclass )
 {
   int i;
 
-  for( i = 0; i < bg_numBuildables; i++ )
+  if( ( i = BG_BuildableIndex( bclass ) ) >= 0 )
   {
-    if( bg_buildableList[ i ].buildNum == bclass )
-    {
-      return bg_buildableList[ i ].buildPoints;
-    }
+    return bg_buildableList[ i ].buildPoints;
   }
 
   return 1000;
@@ -906,15 +912,12 @@ qboolean BG_FindStagesForBuildable( int bclass, stage_t stage )
 {
   int i;
 
-  for( i = 0; i < bg_numBuildables; i++ )
+  if( ( i = BG_BuildableIndex( bclass ) ) >= 0 )
   {
-    if( bg_buildableList[ i ].buildNum == bclass )
-    {
-      if( bg_buildableList[ i ].stages & ( 1 << stage ) )
-        return qtrue;
-      else
-        return qfalse;
-    }
+    if( bg_buildableList[ i ].stages & ( 1 << stage ) )
+      return qtrue;
+    else
+      return qfalse;
   }
 
   return qfalse;
@@ -929,12 +932,9 @@ int BG_FindHealthForBuildable( int bclass )
 {
   int i;
 
-  for( i = 0; i < bg_numBuildables; i++ )
+  if( ( i = BG_BuildableIndex( bclass ) ) >= 0 )
   {
-    if( bg_buildableList[ i ].buildNum == bclass )
-    {
-      return bg_buildableList[ i ].health;
-    }
+    return bg_buildableList[ i ].health;
   }
 
   return 1000;
@@ -949,12 +949,9 @@ int BG_FindRegenRateForBuildable( int bclass )
 {
   int i;
 
-  for( i = 0; i < bg_numBuildables; i++ )
+  if( ( i = BG_BuildableIndex( bclass ) ) >= 0 )
   {
-    if( bg_buildableList[ i ].buildNum == bclass )
-    {
-      return bg_buildableList[ i ].regenRate;
-    }
+    return bg_buildableList[ i ].regenRate;
   }
 
   return 0;
@@ -969,12 +966,9 @@ int BG_FindSplashDamageForBuildable( int bclass )
 {
   int i;
 
-  for( i = 0; i < bg_numBuildables; i++ )
+  if( ( i = BG_BuildableIndex( bclass ) ) >= 0 )
   {
-    if( bg_buildableList[ i ].buildNum == bclass )
-    {
-      return bg_buildableList[ i ].splashDamage;
-    }
+    return bg_buildableList[ i ].splashDamage;
   }
 
   return 50;
@@ -989,12 +983,9 @@ int BG_FindSplashRadiusForBuildable( int bclass )
 {
   int i;
 
-  for( i = 0; i < bg_numBuildables; i++ )
+  if( ( i = BG_BuildableIndex( bclass ) ) >= 0 )
   {
-    if( bg_buildableList[ i ].buildNum == bclass )
-    {
-      return bg_buildableList[ i ].splashRadius;
-    }
+    return bg_buildableList[ i ].splashRadius;
   }
 
   return 200;
@@ -1009,12 +1000,9 @@ int BG_FindMODForBuildable( int bclass )
 {
   int i;
 
-  for( i = 0; i < bg_numBuildables; i++ )
+  if( ( i = BG_BuildableIndex( bclass ) ) >= 0 )
   {
-    if( bg_buildableList[ i ].buildNum == bclass )
-    {
-      return bg_buildableList[ i ].meansOfDeath;
-    }
+    return bg_buildableList[ i ].meansOfDeath;
   }
 
   return MOD_UNKNOWN;
@@ -1029,12 +1017,9 @@ int BG_FindTeamForBuildable( int bclass )
 {
   int i;
 
-  for( i = 0; i < bg_numBuildables; i++ )
+  if( ( i = BG_BuildableIndex( bclass ) ) >= 0 )
   {
-    if( bg_buildableList[ i ].buildNum == bclass )
-    {
-      return bg_buildableList[ i ].team;
-    }
+    return bg_buildableList[ i ].team;
   }
 
   return BIT_NONE;
@@ -1049,12 +1034,9 @@ weapon_t BG_FindBuildWeaponForBuildable( int bclass )
 {
   int i;
 
-  for( i = 0; i < bg_numBuildables; i++ )
+  if( ( i = BG_BuildableIndex( bclass ) ) >= 0 )
   {
-    if( bg_buildableList[ i ].buildNum == bclass )
-    {
-      return bg_buildableList[ i ].buildWeapon;
-    }
+    return bg_buildableList[ i ].buildWeapon;
   }
 
   return BA_NONE;
@@ -1069,12 +1051,9 @@ int BG_FindAnimForBuildable( int bclass )
 {
   int i;
 
-  for( i = 0; i < bg_numBuildables; i++ )
+  if( ( i = BG_BuildableIndex( bclass ) ) >= 0 )
   {
-    if( bg_buildableList[ i ].buildNum == bclass )
-    {
-      return bg_buildableList[ i ].idleAnim;
-    }
+    return bg_buildableList[ i ].idleAnim;
   }
 
   return BANIM_IDLE1;
@@ -1089,12 +1068,9 @@ int BG_FindNextThinkForBuildable( int bclass )
 {
   int i;
 
-  for( i = 0; i < bg_numBuildables; i++ )
+  if( ( i = BG_BuildableIndex( bclass ) ) >= 0 )
   {
-    if( bg_buildableList[ i ].buildNum == bclass )
-    {
-      return bg_buildableList[ i ].nextthink;
-    }
+    return bg_buildableList[ i ].nextthink;
   }
 
   return 100;
@@ -1109,12 +1085,9 @@ int BG_FindBuildTimeForBuildable( int bclass )
 {
   int i;
 
-  for( i = 0; i < bg_numBuildables; i++ )
+  if( ( i = BG_BuildableIndex( bclass ) ) >= 0 )
   {
-    if( bg_buildableList[ i ].buildNum == bclass )
-    {
-      return bg_buildableList[ i ].buildTime;
-    }
+    return bg_buildableList[ i ].buildTime;
   }
 
   return 10000;
@@ -1129,12 +1102,9 @@ qboolean BG_FindUsableForBuildable( int bclass )
 {
   int i;
 
-  for( i = 0; i < bg_numBuildables; i++ )
+  if( ( i = BG_BuildableIndex( bclass ) ) >= 0 )
   {
-    if( bg_buildableList[ i ].buildNum == bclass )
-    {
-      return bg_buildableList[ i ].usable;
-    }
+    return bg_buildableList[ i ].usable;
   }
 
   return qfalse;
@@ -1149,12 +1119,9 @@ int BG_FindFireSpeedForBuildable( int bclass )
 {
   int i;
 
-  for( i = 0; i < bg_numBuildables; i++ )
+  if( ( i = BG_BuildableIndex( bclass ) ) >= 0 )
   {
-    if( bg_buildableList[ i ].buildNum == bclass )
-    {
-      return bg_buildableList[ i ].turretFireSpeed;
-    }
+    return bg_buildableList[ i ].turretFireSpeed;
   }
 
   return 1000;
@@ -1169,12 +1136,9 @@ int BG_FindRangeForBuildable( int bclass )
 {
   int i;
 
-  for( i = 0; i < bg_numBuildables; i++ )
+  if( ( i = BG_BuildableIndex( bclass ) ) >= 0 )
   {
-    if( bg_buildableList[ i ].buildNum == bclass )
-    {
-      return bg_buildableList[ i ].turretRange;
-    }
+    return bg_buildableList[ i ].turretRange;
   }
 
   return 1000;
@@ -1189,12 +1153,9 @@ weapon_t BG_FindProjTypeForBuildable( int bclass )
 {
   int i;
 
-  for( i = 0; i < bg_numBuildables; i++ )
+  if( ( i = BG_BuildableIndex( bclass ) ) >= 0 )
   {
-    if( bg_buildableList[ i ].buildNum == bclass )
-    {
-      return bg_buildableList[ i ].turretProjType;
-    }
+    return bg_buildableList[ i ].turretProjType;
   }
 
   return WP_NONE;
@@ -1209,12 +1170,9 @@ float BG_FindMinNormalForBuildable( int bclass )
 {
   int i;
 
-  for( i = 0; i < bg_numBuildables; i++ )
+  if( ( i = BG_BuildableIndex( bclass ) ) >= 0 )
   {
-    if( bg_buildableList[ i ].buildNum == bclass )
-    {
-      return bg_buildableList[ i ].minNormal;
-    }
+    return bg_buildableList[ i ].minNormal;
   }
 
   return 0.707f;
@@ -1229,12 +1187,9 @@ qboolean BG_FindInvertNormalForBuildable( int bclass )
 {
   int i;
 
-  for( i = 0; i < bg_numBuildables; i++ )
+  if( ( i = BG_BuildableIndex( bclass ) ) >= 0 )
   {
-    if( bg_buildableList[ i ].buildNum == bclass )
-    {
-      return bg_buildableList[ i ].invertNormal;
-    }
+    return bg_buildableList[ i ].invertNormal;
   }
 
   return qfalse;
@@ -1249,12 +1204,9 @@ int BG_FindCreepTestForBuildable( int bclass )
 {
   int i;
 
-  for( i = 0; i < bg_numBuildables; i++ )
+  if( ( i = BG_BuildableIndex( bclass ) ) >= 0 )
   {
-    if( bg_buildableList[ i ].buildNum == bclass )
-    {
-      return bg_buildableList[ i ].creepTest;
-    }
+    return bg_buildableList[ i ].creepTest;
   }
 
   return qfalse;
@@ -1269,12 +1221,9 @@ int BG_FindCreepSizeForBuildable( int bclass )
 {
   int i;
 
-  for( i = 0; i < bg_numBuildables; i++ )
+  if( ( i = BG_BuildableIndex( bclass ) ) >= 0 )
   {
-    if( bg_buildableList[ i ].buildNum == bclass )
-    {
-      return bg_buildableList[ i ].creepSize;
-    }
+    return bg_buildableList[ i ].creepSize;
   }
 
   return CREEP_BASESIZE;
@@ -1289,12 +1238,9 @@ int BG_FindDCCTestForBuildable( int bclass )
 {
   int i;
 
-  for( i = 0; i < bg_numBuildables; i++ )
+  if( ( i = BG_BuildableIndex( bclass ) ) >= 0 )
   {
-    if( bg_buildableList[ i ].buildNum == bclass )
-    {
-      return bg_buildableList[ i ].dccTest;
-    }
+    return bg_buildableList[ i ].dccTest;
   }
 
   return qfalse;
@@ -1309,12 +1255,9 @@ int BG_FindUniqueTestForBuildable( int bclass )
 {
   int i;
 
-  for( i = 0; i < bg_numBuildables; i++ )
+  if( ( i = BG_BuildableIndex( bclass ) ) >= 0 )
   {
-    if( bg_buildableList[ i ].buildNum == bclass )
-    {
-      return bg_buildableList[ i ].reactorTest;
-    }
+    return bg_buildableList[ i ].reactorTest;
   }
 
   return qfalse;
@@ -1329,12 +1272,9 @@ qboolean BG_FindReplaceableTestForBuildable( int bclass )
 {
   int i;
 
-  for( i = 0; i < bg_numBuildables; i++ )
+  if( ( i = BG_BuildableIndex( bclass ) ) >= 0 )
   {
-    if( bg_buildableList[ i ].buildNum == bclass )
-    {
-      return bg_buildableList[ i ].replaceable;
-    }
+    return bg_buildableList[ i ].replaceable;
   }
   return qfalse;
 }
@@ -1358,12 +1298,9 @@ qboolean BG_FindTransparentTestForBuildable( int bclass )
 {
   int i;
 
-  for( i = 0; i < bg_numBuildables; i++ )
+  if( ( i = BG_BuildableIndex( bclass ) ) >= 0 )
   {
-    if( bg_buildableList[ i ].buildNum == bclass )
-    {
-      return bg_buildableList[ i ].transparentTest;
-    }
+    return bg_buildableList[ i ].transparentTest;
   }
   return qfalse; 
 }
@@ -2039,6 +1976,42 @@ int   bg_numPclasses = sizeof( bg_classList ) / sizeof( bg_classList[ 0 ] );
 //separate from bg_classList to work around char struct init bug
 classAttributeOverrides_t bg_classOverrideList[ PCL_NUM_CLASSES ];
 
+//bg_classIndex[ n ] is the position of n in bg_classList, built on first lookup
+static int      bg_classIndex[ PCL_NUM_CLASSES ];
+static qboolean bg_classIndexed = qfalse;
+
+/*
+==============
+BG_ClassIndex
+
+Map an enum value to its bg_classList entry, or -1 if there isn't one
+==============
+*/
+static int BG_ClassIndex( int n )
+{
+  int i;
+
+  if( !bg_classIndexed )
+  {
+    for( i = 0; i < PCL_NUM_CLASSES; i++ )
+      bg_classIndex[ i ] = -1;
+
+    //first entry wins, as with the old linear scans
+    for( i = bg_numPclasses - 1; i >= 0; i-- )
+    {
+      if( bg_classList[ i ].classNum >= 0 && bg_classList[ i ].classNum < PCL_NUM_CLASSES )
+        bg_classIndex[ bg_classList[ i ].classNum ] = i;
+    }
+
+    bg_classIndexed = qtrue;
+  }
+
+  if( n < 0 || n >= PCL_NUM_CLASSES )
+    return -1;
+
+  return bg_classIndex[ n ];
+}
+
 /*
 ==============
 BG_FindClassNumForName
@@ -2067,11 +2040,8 @@ char *BG_FindNameForClassNum( int pclass )
 {
   int i;
 
-  for( i = 0; i < bg_numPclasses; i++ )
-  {
-    if( bg_classList[ i ].classNum == pclass )
-      return bg_classList[ i ].className;
-  }
+  if( ( i = BG_ClassIndex( pclass ) ) >= 0 )
+    return bg_classList[ i ].className;
 
   Com_Printf( S_COLOR_YELLOW "WARNING: fallthrough in BG_FindNameForClassNum\n" );
   //wimp out
@@ -2090,11 +2060,8 @@ char *BG_FindHumanNameForClassNum( int pclass )
   if( bg_classOverrideList[ pclass ].humanName[ 0 ] != 0 )
     return bg_classOverrideList[ pclass ].humanName;
 
-  for( i = 0; i < bg_numPclasses; i++ )
-  {
-    if( bg_classList[ i ].classNum == pclass )
-      return bg_classList[ i ].humanName;
-  }
+  if( ( i = BG_ClassIndex( pclass ) ) >= 0 )
+    return bg_classList[ i ].humanName;
 
   Com_Printf( S_COLOR_YELLOW "WARNING: fallthrough in BG_FindHumanNameForClassNum\n" );
   //wimp out
@@ -2113,11 +2080,8 @@ char *BG_FindModelNameForClass( int pclass )
   if( bg_classOverrideList[ pclass ].modelName[ 0 ] != 0 )
     return bg_classOverrideList[ pclass ].modelName;
 
-  for( i = 0; i < bg_numPclasses; i++ )
-  {
-    if( bg_classList[ i ].classNum == pclass )
-      return bg_classList[ i ].modelName;
-  }
+  if( ( i = BG_ClassIndex( pclass ) ) >= 0 )
+    return bg_classList[ i ].modelName;
 
   Com_Printf( S_COLOR_YELLOW "WARNING: fallthrough in BG_FindModelNameForClass\n" );
   //note: must return a valid modelName!
@@ -2136,12 +2100,9 @@ float BG_FindModelScaleForClass( int pclass )
   if( bg_classOverrideList[ pclass ].modelScale != 0.0f )
     return bg_classOverrideList[ pclass ].modelScale;
 
-  for( i = 0; i < bg_numPclasses; i++ )
+  if( ( i = BG_ClassIndex( pclass ) ) >= 0 )
   {
-    if( bg_classList[ i ].classNum == pclass )
-    {
-      return bg_classList[ i ].modelScale;
-    }
+    return bg_classList[ i ].modelScale;
   }
 
   Com_Printf( S_COLOR_YELLOW "WARNING: fallthrough in BG_FindModelScaleForClass( %d )\n", pclass );
@@ -2160,11 +2121,8 @@ char *BG_FindSkinNameForClass( int pclass )
   if( bg_classOverrideList[ pclass ].skinName[ 0 ] != 0 )
     return bg_classOverrideList[ pclass ].skinName;
 
-  for( i = 0; i < bg_numPclasses; i++ )
-  {
-    if( bg_classList[ i ].classNum == pclass )
-      return bg_classList[ i ].skinName;
-  }
+  if( ( i = BG_ClassIndex( pclass ) ) >= 0 )
+    return bg_classList[ i ].skinName;
 
   Com_Printf( S_COLOR_YELLOW "WARNING: fallthrough in BG_FindSkinNameForClass\n" );
   //note: must return a valid modelName!
@@ -2183,12 +2141,9 @@ float BG_FindShadowScaleForClass( int pclass )
   if( bg_classOverrideList[ pclass ].shadowScale != 0.0f )
     return bg_classOverrideList[ pclass ].shadowScale;
 
-  for( i = 0; i < bg_numPclasses; i++ )
+  if( ( i = BG_ClassIndex( pclass ) ) >= 0 )
   {
-    if( bg_classList[ i ].classNum == pclass )
-    {
-      return bg_classList[ i ].shadowScale;
-    }
+    return bg_classList[ i ].shadowScale;
   }
 
   Com_Printf( S_COLOR_YELLOW "WARNING: fallthrough in BG_FindShadowScaleForClass( %d )\n", pclass );
@@ -2207,11 +2162,8 @@ char *BG_FindHudNameForClass( int pclass )
   if( bg_classOverrideList[ pclass ].hudName[ 0 ] != 0 )
     return bg_classOverrideList[ pclass ].hudName;
 
-  for( i = 0; i < bg_numPclasses; i++ )
-  {
-    if( bg_classList[ i ].classNum == pclass )
-      return bg_classList[ i ].hudName;
-  }
+  if( ( i = BG_ClassIndex( pclass ) ) >= 0 )
+    return bg_classList[ i ].hudName;
 
   Com_Printf( S_COLOR_YELLOW "WARNING: fallthrough in BG_FindHudNameForClass\n" );
   //note: must return a valid hudName!
@@ -2227,15 +2179,12 @@ qboolean BG_FindStagesForClass( int pclass, stage_t stage )
 {
   int i;
 
-  for( i = 0; i < bg_numPclasses; i++ )
+  if( ( i = BG_ClassIndex( pclass ) ) >= 0 )
   {
-    if( bg_classList[ i ].classNum == pclass )
-    {
-      if( bg_classList[ i ].stages & ( 1 << stage ) )
-        return qtrue;
-      else
-        return qfalse;
-    }
+    if( bg_classList[ i ].stages & ( 1 << stage ) )
+      return qtrue;
+    else
+      return qfalse;
   }
 
   Com_Printf( S_COLOR_YELLOW "WARNING: fallthrough in BG_FindStagesForClass\n" );
@@ -2251,52 +2200,49 @@ void BG_FindBBoxForClass( int pclass, vec3_t mins, vec3_t maxs, vec3_t cmaxs, ve
 {
   int i;
 
-  for( i = 0; i < bg_numPclasses; i++ )
+  if( ( i = BG_ClassIndex( pclass ) ) >= 0 )
   {
-    if( bg_classList[ i ].classNum == pclass )
+    if( mins != NULL )
     {
-      if( mins != NULL )
-      {
-        VectorCopy( bg_classList[ i ].mins, mins );
+      VectorCopy( bg_classList[ i ].mins, mins );
 
-        if( VectorLength( bg_classOverrideList[ pclass ].mins ) )
-          VectorCopy( bg_classOverrideList[ pclass ].mins, mins );
-      }
-
-      if( maxs != NULL )
-      {
-        VectorCopy( bg_classList[ i ].maxs, maxs );
+      if( VectorLength( bg_classOverrideList[ pclass ].mins ) )
+        VectorCopy( bg_classOverrideList[ pclass ].mins, mins );
+    }
 
-        if( VectorLength( bg_classOverrideList[ pclass ].maxs ) )
-          VectorCopy( bg_classOverrideList[ pclass ].maxs, maxs );
-      }
+    if( maxs != NULL )
+    {
+      VectorCopy( bg_classList[ i ].maxs, maxs );
 
-      if( cmaxs != NULL )
-      {
-        VectorCopy( bg_classList[ i ].crouchMaxs, cmaxs );
+      if( VectorLength( bg_classOverrideList[ pclass ].maxs ) )
+        VectorCopy( bg_classOverrideList[ pclass ].maxs, maxs );
+    }
 
-        if( VectorLength( bg_classOverrideList[ pclass ].crouchMaxs ) )
-          VectorCopy( bg_classOverrideList[ pclass ].crouchMaxs, cmaxs );
-      }
+    if( cmaxs != NULL )
+    {
+      VectorCopy( bg_classList[ i ].crouchMaxs, cmaxs );
 
-      if( dmins != NULL )
-      {
-        VectorCopy( bg_classList[ i ].deadMins, dmins );
+      if( VectorLength( bg_classOverrideList[ pclass ].crouchMaxs ) )
+        VectorCopy( bg_classOverrideList[ pclass ].crouchMaxs, cmaxs );
+    }
 
-        if( VectorLength( bg_classOverrideList[ pclass ].deadMins ) )
-          VectorCopy( bg_classOverrideList[ pclass ].deadMins, dmins );
-      }
+    if( dmins != NULL )
+    {
+      VectorCopy( bg_classList[ i ].deadMins, dmins );
 
-      if( dmaxs != NULL )
-      {
-        VectorCopy( bg_classList[ i ].deadMaxs, dmaxs );
+      if( VectorLength( bg_classOverrideList[ pclass ].deadMins ) )
+        VectorCopy( bg_classOverrideList[ pclass ].deadMins, dmins );
+    }
 
-        if( VectorLength( bg_classOverrideList[ pclass ].deadMaxs ) )
-          VectorCopy( bg_classOverrideList[ pclass ].deadMaxs, dmaxs );
-      }
+    if( dmaxs != NULL )
+    {
+      VectorCopy( bg_classList[ i ].deadMaxs, dmaxs );
 
-      return;
+      if( VectorLength( bg_classOverrideList[ pclass ].deadMaxs ) )
+        VectorCopy( bg_classOverrideList[ pclass ].deadMaxs, dmaxs );
     }
+
+    return;
   }
 
   if( mins != NULL )
@@ -2327,12 +2273,9 @@ float BG_FindZOffsetForClass( int pclass )
   if( bg_classOverrideList[ pclass ].zOffset != 0.0f )
     return bg_classOverrideList[ pclass ].zOffset;
 
-  for( i = 0; i < bg_numPclasses; i++ )
+  if( ( i = BG_ClassIndex( pclass ) ) >= 0 )
   {
-    if( bg_classList[ i ].classNum == pclass )
-    {
-      return bg_classList[ i ].zOffset;
-    }
+    return bg_classList[ i ].zOffset;
   }
 
   Com_Printf( S_COLOR_YELLOW "WARNING: fallthrough in BG_FindZOffsetForClass\n" );
@@ -2350,14 +2293,10 @@ void BG_FindViewheightForClass( int pclass, int *viewheight, int *cViewheight )
   int vh = 0;
   int cvh = 0;
 
-  for( i = 0; i < bg_numPclasses; i++ )
+  if( ( i = BG_ClassIndex( pclass ) ) >= 0 )
   {
-    if( bg_classList[ i ].classNum == pclass )
-    {
-      vh = bg_classList[ i ].viewheight;
-      cvh = bg_classList[ i ].crouchViewheight;
-      break;
-    }
+    vh = bg_classList[ i ].viewheight;
+    cvh = bg_classList[ i ].crouchViewheight;
   }
   
   if( bg_classOverrideList[ pclass ].viewheight != 0 )
@@ -2386,12 +2325,9 @@ int BG_FindHealthForClass( int pclass )
 {
   int i;
 
-  for( i = 0; i < bg_numPclasses; i++ )
+  if( ( i = BG_ClassIndex( pclass ) ) >= 0 )
   {
-    if( bg_classList[ i ].classNum == pclass )
-    {
-      return bg_classList[ i ].health;
-    }
+    return bg_classList[ i ].health;
   }
 
   Com_Printf( S_COLOR_YELLOW "WARNING: fallthrough in BG_FindHealthForClass\n" );
@@ -2407,12 +2343,9 @@ float BG_FindFallDamageForClass( int pclass )
 {
   int i;
 
-  for( i = 0; i < bg_numPclasses; i++ )
+  if( ( i = BG_ClassIndex( pclass ) ) >= 0 )
   {
-    if( bg_classList[ i ].classNum == pclass )
-    {
-      return bg_classList[ i ].fallDamage;
-    }
+    return bg_classList[ i ].fallDamage;
   }
 
   Com_Printf( S_COLOR_YELLOW "WARNING: fallthrough in BG_FindFallDamageForClass\n" );
@@ -2428,12 +2361,9 @@ int BG_FindRegenRateForClass( int pclass )
 {
   int i;
 
-  for( i = 0; i < bg_numPclasses; i++ )
+  if( ( i = BG_ClassIndex( pclass ) ) >= 0 )
   {
-    if( bg_classList[ i ].classNum == pclass )
-    {
-      return bg_classList[ i ].regenRate;
-    }
+    return bg_classList[ i ].regenRate;
   }
 
   Com_Printf( S_COLOR_YELLOW "WARNING: fallthrough in BG_FindRegenRateForClass\n" );
@@ -2449,12 +2379,9 @@ int BG_FindFovForClass( int pclass )
 {
   int i;
 
-  for( i = 0; i < bg_numPclasses; i++ )
+  if( ( i = BG_ClassIndex( pclass ) ) >= 0 )
   {
-    if( bg_classList[ i ].classNum == pclass )
-    {
-      return bg_classList[ i ].fov;
-    }
+    return bg_classList[ i ].fov;
   }
 
   Com_Printf( S_COLOR_YELLOW "WARNING: fallthrough in BG_FindFovForClass\n" );
@@ -2470,12 +2397,9 @@ float BG_FindBobForClass( int pclass )
 {
   int i;
 
-  for( i = 0; i < bg_numPclasses; i++ )
+  if( ( i = BG_ClassIndex( pclass ) ) >= 0 )
   {
-    if( bg_classList[ i ].classNum == pclass )
-    {
-      return bg_classList[ i ].bob;
-    }
+    return bg_classList[ i ].bob;
   }
 
   Com_Printf( S_COLOR_YELLOW "WARNING: fallthrough in BG_FindBobForClass\n" );
@@ -2491,12 +2415,9 @@ float BG_FindBobCycleForClass( int pclass )
 {
   int i;
 
-  for( i = 0; i < bg_numPclasses; i++ )
+  if( ( i = BG_ClassIndex( pclass ) ) >= 0 )
   {
-    if( bg_classList[ i ].classNum == pclass )
-    {
-      return bg_classList[ i ].bobCycle;
-    }
+    return bg_classList[ i ].bobCycle;
   }
 
   Com_Printf( S_COLOR_YELLOW "WARNING: fallthrough in BG_FindBobCycleForClass\n" );
@@ -2512,12 +2433,9 @@ float BG_FindSpeedForClass( int pclass )
 {
   int i;
 
-  for( i = 0; i < bg_numPclasses; i++ )
+  if( ( i = BG_ClassIndex( pclass ) ) >= 0 )
   {
-    if( bg_classList[ i ].classNum == pclass )
-    {
-      return bg_classList[ i ].speed;
-    }
+    return bg_classList[ i ].speed;
   }
 
   Com_Printf( S_COLOR_YELLOW "WARNING: fallthrough in BG_FindSpeedForClass\n" );
@@ -2533,12 +2451,9 @@ float BG_FindAccelerationForClass( int pclass )
 {
   int i;
 
-  for( i = 0; i < bg_numPclasses; i++ )
+  if( ( i = BG_ClassIndex( pclass ) ) >= 0 )
   {
-    if( bg_classList[ i ].classNum == pclass )
-    {
-      return bg_classList[ i ].acceleration;
-    }
+    return bg_classList[ i ].acceleration;
   }
 
   Com_Printf( S_COLOR_YELLOW "WARNING: fallthrough in BG_FindAccelerationForClass\n" );
@@ -2554,12 +2469,9 @@ float BG_FindAirAccelerationForClass( int pclass )
 {
   int i;
 
-  for( i = 0; i < bg_numPclasses; i++ )
+  if( ( i = BG_ClassIndex( pclass ) ) >= 0 )
   {
-    if( bg_classList[ i ].classNum == pclass )
-    {
-      return bg_classList[ i ].airAcceleration;
-    }
+    return bg_classList[ i ].airAcceleration;
   }
 
   Com_Printf( S_COLOR_YELLOW "WARNING: fallthrough in BG_FindAirAccelerationForClass\n" );
@@ -2575,12 +2487,9 @@ float BG_FindFrictionForClass( int pclass )
 {
   int i;
 
-  for( i = 0; i < bg_numPclasses; i++ )
+  if( ( i = BG_ClassIndex( pclass ) ) >= 0 )
   {
-    if( bg_classList[ i ].classNum == pclass )
-    {
-      return bg_classList[ i ].friction;
-    }
+    return bg_classList[ i ].friction;
   }
 
   Com_Printf( S_COLOR_YELLOW "WARNING: fallthrough in BG_FindFrictionForClass\n" );
@@ -2596,12 +2505,9 @@ float BG_FindStopSpeedForClass( int pclass )
 {
   int i;
 
-  for( i = 0; i < bg_numPclasses; i++ )
+  if( ( i = BG_ClassIndex( pclass ) ) >= 0 )
   {
-    if( bg_classList[ i ].classNum == pclass )
-    {
-      return bg_classList[ i ].stopSpeed;
-    }
+    return bg_classList[ i ].stopSpeed;
   }
 
   Com_Printf( S_COLOR_YELLOW "WARNING: fallthrough in BG_FindStopSpeedForClass\n" );
@@ -2617,12 +2523,9 @@ float BG_FindJumpMagnitudeForClass( int pclass )
 {
   int i;
 
-  for( i = 0; i < bg_numPclasses; i++ )
+  if( ( i = BG_ClassIndex( pclass ) ) >= 0 )
   {
-    if( bg_classList[ i ].classNum == pclass )
-    {
-      return bg_classList[ i ].jumpMagnitude;
-    }
+    return bg_classList[ i ].jumpMagnitude;
   }
 
   Com_Printf( S_COLOR_YELLOW "WARNING: fallthrough in BG_FindJumpMagnitudeForClass\n" );
@@ -2638,12 +2541,9 @@ float BG_FindKnockbackScaleForClass( int pclass )
 {
   int i;
 
-  for( i = 0; i < bg_numPclasses; i++ )
+  if( ( i = BG_ClassIndex( pclass ) ) >= 0 )
   {
-    if( bg_classList[ i ].classNum == pclass )
-    {
-      return bg_classList[ i ].knockbackScale;
-    }
+    return bg_classList[ i ].knockbackScale;
   }
 
   Com_Printf( S_COLOR_YELLOW "WARNING: fallthrough in BG_FindKnockbackScaleForClass\n" );
@@ -2659,12 +2559,9 @@ int BG_FindSteptimeForClass( int pclass )
 {
   int i;
 
-  for( i = 0; i < bg_numPclasses; i++ )
+  if( ( i = BG_ClassIndex( pclass ) ) >= 0 )
   {
-    if( bg_classList[ i ].classNum == pclass )
-    {
-      return bg_classList[ i ].steptime;
-    }
+    return bg_classList[ i ].steptime;
   }
 
   Com_Printf( S_COLOR_YELLOW "WARNING: fallthrough in BG_FindSteptimeForClass\n" );
@@ -2680,12 +2577,9 @@ qboolean BG_ClassHasAbility( int pclass, int ability )
 {
   int i;
 
-  for( i = 0; i < bg_numPclasses; i++ )
+  if( ( i = BG_ClassIndex( pclass ) ) >= 0 )
   {
-    if( bg_classList[ i ].classNum == pclass )
-    {
-      return ( bg_classList[ i ].abilities & ability );
-    }
+    return ( bg_classList[ i ].abilities & ability );
   }
 
   return qfalse;
@@ -2700,12 +2594,9 @@ weapon_t BG_FindStartWeaponForClass( int pclass )
 {
   int i;
 
-  for( i = 0; i < bg_numPclasses; i++ )
+  if( ( i = BG_ClassIndex( pclass ) ) >= 0 )
   {
-    if( bg_classList[ i ].classNum == pclass )
-    {
-      return bg_classList[ i ].startWeapon;
-    }
+    return bg_classList[ i ].startWeapon;
   }
 
   Com_Printf( S_COLOR_YELLOW "WARNING: fallthrough in BG_FindStartWeaponForClass\n" );
@@ -2721,12 +2612,9 @@ float BG_FindBuildDistForClass( int pclass )
 {
   int i;
 
-  for( i = 0; i < bg_numPclasses; i++ )
+  if( ( i = BG_ClassIndex( pclass ) ) >= 0 )
   {
-    if( bg_classList[ i ].classNum == pclass )
-    {
-      return bg_classList[ i ].buildDist;
-    }
+    return bg_classList[ i ].buildDist;
   }
 
   Com_Printf( S_COLOR_YELLOW "WARNING: fallthrough in BG_FindBuildDistForClass\n" );
@@ -2751,27 +2639,24 @@ int BG_ClassCanEvolveFromTo( int fclass, int tclass, int credits, int num )
   if( fclass == PCL_NONE || tclass == PCL_NONE )
     return -1;
 
-  for( i = 0; i < bg_numPclasses; i++ )
+  if( ( i = BG_ClassIndex( fclass ) ) >= 0 )
   {
-    if( bg_classList[ i ].classNum == fclass )
-    {
-      for( j = 0; j < 3; j++ )
-        if( bg_classList[ i ].children[ j ] == tclass )
-          return num + cost;
+    for( j = 0; j < 3; j++ )
+      if( bg_classList[ i ].children[ j ] == tclass )
+        return num + cost;
 
-      for( j = 0; j < 3; j++ )
-      {
-        int sub;
-
-        cost = BG_FindCostOfClass( bg_classList[ i ].children[ j ] );
-        sub = BG_ClassCanEvolveFromTo( bg_classList[ i ].children[ j ],
-                                       tclass, credits - cost, num + cost );
-        if( sub >= 0 )
-          return sub;
-      }
+    for( j = 0; j < 3; j++ )
+    {
+      int sub;
 
-      return -1; //may as well return by this point
+      cost = BG_FindCostOfClass( bg_classList[ i ].children[ j ] );
+      sub = BG_ClassCanEvolveFromTo( bg_classList[ i ].children[ j ],
+                                     tclass, credits - cost, num + cost );
+      if( sub >= 0 )
+        return sub;
     }
+
+    return -1; //may as well return by this point
   }
 
   return -1;
@@ -2786,12 +2671,9 @@ int BG_FindValueOfClass( int pclass )
 {
   int i;
 
-  for( i = 0; i < bg_numPclasses; i++ )
+  if( ( i = BG_ClassIndex( pclass ) ) >= 0 )
   {
-    if( bg_classList[ i ].classNum == pclass )
-    {
-      return bg_classList[ i ].value;
-    }
+    return bg_classList[ i ].value;
   }
 
   Com_Printf( S_COLOR_YELLOW "WARNING: fallthrough in BG_FindValueOfClass\n" );
@@ -2807,12 +2689,9 @@ int BG_FindCostOfClass( int pclass )
 {
   int i;
 
-  for( i = 0; i < bg_numPclasses; i++ )
+  if( ( i = BG_ClassIndex( pclass ) ) >= 0 )
   {
-    if( bg_classList[ i ].classNum == pclass )
-    {
-      return bg_classList[ i ].cost;
-    }
+    return bg_classList[ i ].cost;
   }
 
   Com_Printf( S_COLOR_YELLOW "WARNING: fallthrough in BG_FindCostOfClass\n" );
@@ -3751,21 +3630,54 @@ weaponAttributes_t bg_weapons[ ] =
 
 int   bg_numWeapons = sizeof( bg_weapons ) / sizeof( bg_weapons[ 0 ] );
 
+//bg_weaponIndex[ n ] is the position of n in bg_weapons, built on first lookup
+static int      bg_weaponIndex[ WP_NUM_WEAPONS ];
+static qboolean bg_weaponIndexed = qfalse;
+
 /*
 ==============
-BG_FindPriceForWeapon
+BG_WeaponIndex
+
+Map an enum value to its bg_weapons entry, or -1 if there isn't one
 ==============
 */
-int BG_FindPriceForWeapon( int weapon )
+static int BG_WeaponIndex( int n )
 {
   int i;
 
-  for( i = 0; i < bg_numWeapons; i++ )
+  if( !bg_weaponIndexed )
   {
-    if( bg_weapons[ i ].weaponNum == weapon )
+    for( i = 0; i < WP_NUM_WEAPONS; i++ )
+      bg_weaponIndex[ i ] = -1;
+
+    //first entry wins, as with the old linear scans
+    for( i = bg_numWeapons - 1; i >= 0; i-- )
     {
-      return bg_weapons[ i ].price;
+      if( bg_weapons[ i ].weaponNum >= 0 && bg_weapons[ i ].weaponNum < WP_NUM_WEAPONS )
+        bg_weaponIndex[ bg_weapons[ i ].weaponNum ] = i;
     }
+
+    bg_weaponIndexed = qtrue;
+  }
+
+  if( n < 0 || n >= WP_NUM_WEAPONS )
+    return -1;
+
+  return bg_weaponIndex[ n ];
+}
+
+/*
+==============
+BG_FindPriceForWeapon
+==============
+*/
+int BG_FindPriceForWeapon( int weapon )
+{
+  int i;
+
+  if( ( i = BG_WeaponIndex( weapon ) ) >= 0 )
+  {
+    return bg_weapons[ i ].price;
   }
 
   return 100;
@@ -3780,15 +3692,12 @@ qboolean BG_FindStagesForWeapon( int weapon, stage_t stage )
 {
   int i;
 
-  for( i = 0; i < bg_numWeapons; i++ )
+  if( ( i = BG_WeaponIndex( weapon ) ) >= 0 )
   {
-    if( bg_weapons[ i ].weaponNum == weapon )
-    {
-      if( bg_weapons[ i ].stages & ( 1 << stage ) )
-        return qtrue;
-      else
-        return qfalse;
-    }
+    if( bg_weapons[ i ].stages & ( 1 << stage ) )
+      return qtrue;
+    else
+      return qfalse;
   }
 
   return qfalse;
@@ -3803,12 +3712,9 @@ int BG_FindSlotsForWeapon( int weapon )
 {
   int i;
 
-  for( i = 0; i < bg_numWeapons; i++ )
+  if( ( i = BG_WeaponIndex( weapon ) ) >= 0 )
   {
-    if( bg_weapons[ i ].weaponNum == weapon )
-    {
-      return bg_weapons[ i ].slots;
-    }
+    return bg_weapons[ i ].slots;
   }
 
   return SLOT_WEAPON;
@@ -3823,11 +3729,8 @@ char *BG_FindNameForWeapon( int weapon )
 {
   int i;
 
-  for( i = 0; i < bg_numWeapons; i++ )
-  {
-    if( bg_weapons[ i ].weaponNum == weapon )
-      return bg_weapons[ i ].weaponName;
-  }
+  if( ( i = BG_WeaponIndex( weapon ) ) >= 0 )
+    return bg_weapons[ i ].weaponName;
 
   //wimp out
   return 0;
@@ -3861,11 +3764,8 @@ char *BG_FindHumanNameForWeapon( int weapon )
 {
   int i;
 
-  for( i = 0; i < bg_numWeapons; i++ )
-  {
-    if( bg_weapons[ i ].weaponNum == weapon )
-      return bg_weapons[ i ].weaponHumanName;
-  }
+  if( ( i = BG_WeaponIndex( weapon ) ) >= 0 )
+    return bg_weapons[ i ].weaponHumanName;
 
   //wimp out
   return 0;
@@ -3880,18 +3780,12 @@ void BG_FindAmmoForWeapon( int weapon, int *maxAmmo, int *maxClips )
 {
   int i;
 
-  for( i = 0; i < bg_numWeapons; i++ )
+  if( ( i = BG_WeaponIndex( weapon ) ) >= 0 )
   {
-    if( bg_weapons[ i ].weaponNum == weapon )
-    {
-      if( maxAmmo != NULL )
-        *maxAmmo = bg_weapons[ i ].maxAmmo;
-      if( maxClips != NULL )
-        *maxClips = bg_weapons[ i ].maxClips;
-
-      //no need to keep going
-      break;
-    }
+    if( maxAmmo != NULL )
+      *maxAmmo = bg_weapons[ i ].maxAmmo;
+    if( maxClips != NULL )
+      *maxClips = bg_weapons[ i ].maxClips;
   }
 }
 
@@ -3904,12 +3798,9 @@ qboolean BG_FindInfinteAmmoForWeapon( int weapon )
 {
   int i;
 
-  for( i = 0; i < bg_numWeapons; i++ )
+  if( ( i = BG_WeaponIndex( weapon ) ) >= 0 )
   {
-    if( bg_weapons[ i ].weaponNum == weapon )
-    {
-      return bg_weapons[ i ].infiniteAmmo;
-    }
+    return bg_weapons[ i ].infiniteAmmo;
   }
 
   return qfalse;
@@ -3924,12 +3815,9 @@ qboolean BG_FindUsesEnergyForWeapon( int weapon )
 {
   int i;
 
-  for( i = 0; i < bg_numWeapons; i++ )
+  if( ( i = BG_WeaponIndex( weapon ) ) >= 0 )
   {
-    if( bg_weapons[ i ].weaponNum == weapon )
-    {
-      return bg_weapons[ i ].usesEnergy;
-    }
+    return bg_weapons[ i ].usesEnergy;
   }
 
   return qfalse;
@@ -3944,11 +3832,8 @@ int BG_FindRepeatRate1ForWeapon( int weapon )
 {
   int i;
 
-  for( i = 0; i < bg_numWeapons; i++ )
-  {
-    if( bg_weapons[ i ].weaponNum == weapon )
-      return bg_weapons[ i ].repeatRate1;
-  }
+  if( ( i = BG_WeaponIndex( weapon ) ) >= 0 )
+    return bg_weapons[ i ].repeatRate1;
 
   return 1000;
 }
@@ -3962,11 +3847,8 @@ int BG_FindRepeatRate2ForWeapon( int weapon )
 {
   int i;
 
-  for( i = 0; i < bg_numWeapons; i++ )
-  {
-    if( bg_weapons[ i ].weaponNum == weapon )
-      return bg_weapons[ i ].repeatRate2;
-  }
+  if( ( i = BG_WeaponIndex( weapon ) ) >= 0 )
+    return bg_weapons[ i ].repeatRate2;
 
   return 1000;
 }
@@ -3980,11 +3862,8 @@ int BG_FindRepeatRate3ForWeapon( int weapon )
 {
   int i;
 
-  for( i = 0; i < bg_numWeapons; i++ )
-  {
-    if( bg_weapons[ i ].weaponNum == weapon )
-      return bg_weapons[ i ].repeatRate3;
-  }
+  if( ( i = BG_WeaponIndex( weapon ) ) >= 0 )
+    return bg_weapons[ i ].repeatRate3;
 
   return 1000;
 }
@@ -3998,12 +3877,9 @@ int BG_FindReloadTimeForWeapon( int weapon )
 {
   int i;
 
-  for( i = 0; i < bg_numWeapons; i++ )
+  if( ( i = BG_WeaponIndex( weapon ) ) >= 0 )
   {
-    if( bg_weapons[ i ].weaponNum == weapon )
-    {
-      return bg_weapons[ i ].reloadTime;
-    }
+    return bg_weapons[ i ].reloadTime;
   }
 
   return 1000;
@@ -4018,12 +3894,9 @@ float BG_FindKnockbackScaleForWeapon( int weapon )
 {
   int i;
 
-  for( i = 0; i < bg_numWeapons; i++ )
+  if( ( i = BG_WeaponIndex( weapon ) ) >= 0 )
   {
-    if( bg_weapons[ i ].weaponNum == weapon )
-    {
-      return bg_weapons[ i ].knockbackScale;
-    }
+    return bg_weapons[ i ].knockbackScale;
   }
 
   return 1.0f;
@@ -4038,12 +3911,9 @@ qboolean BG_WeaponHasAltMode( int weapon )
 {
   int i;
 
-  for( i = 0; i < bg_numWeapons; i++ )
+  if( ( i = BG_WeaponIndex( weapon ) ) >= 0 )
   {
-    if( bg_weapons[ i ].weaponNum == weapon )
-    {
-      return bg_weapons[ i ].hasAltMode;
-    }
+    return bg_weapons[ i ].hasAltMode;
   }
 
   return qfalse;
@@ -4058,12 +3928,9 @@ qboolean BG_WeaponHasThirdMode( int weapon )
 {
   int i;
 
-  for( i = 0; i < bg_numWeapons; i++ )
+  if( ( i = BG_WeaponIndex( weapon ) ) >= 0 )
   {
-    if( bg_weapons[ i ].weaponNum == weapon )
-    {
-      return bg_weapons[ i ].hasThirdMode;
-    }
+    return bg_weapons[ i ].hasThirdMode;
   }
 
   return qfalse;
@@ -4078,12 +3945,9 @@ qboolean BG_WeaponCanZoom( int weapon )
 {
   int i;
 
-  for( i = 0; i < bg_numWeapons; i++ )
+  if( ( i = BG_WeaponIndex( weapon ) ) >= 0 )
   {
-    if( bg_weapons[ i ].weaponNum == weapon )
-    {
-      return bg_weapons[ i ].canZoom;
-    }
+    return bg_weapons[ i ].canZoom;
   }
 
   return qfalse;
@@ -4098,12 +3962,9 @@ float BG_FindZoomFovForWeapon( int weapon )
 {
   int i;
 
-  for( i = 0; i < bg_numWeapons; i++ )
+  if( ( i = BG_WeaponIndex( weapon ) ) >= 0 )
   {
-    if( bg_weapons[ i ].weaponNum == weapon )
-    {
-      return bg_weapons[ i ].zoomFov;
-    }
+    return bg_weapons[ i ].zoomFov;
   }
 
   return qfalse;
@@ -4118,12 +3979,9 @@ qboolean BG_FindPurchasableForWeapon( int weapon )
 {
   int i;
 
-  for( i = 0; i < bg_numWeapons; i++ )
+  if( ( i = BG_WeaponIndex( weapon ) ) >= 0 )
   {
-    if( bg_weapons[ i ].weaponNum == weapon )
-    {
-      return bg_weapons[ i ].purchasable;
-    }
+    return bg_weapons[ i ].purchasable;
   }
 
   return qfalse;
@@ -4138,12 +3996,9 @@ qboolean BG_FindLongRangedForWeapon( int weapon )
 {
   int i;
 
-  for( i = 0; i < bg_numWeapons; i++ )
+  if( ( i = BG_WeaponIndex( weapon ) ) >= 0 )
   {
-    if( bg_weapons[ i ].weaponNum == weapon )
-    {
-      return bg_weapons[ i ].longRanged;
-    }
+    return bg_weapons[ i ].longRanged;
   }
 
   return qfalse;
@@ -4158,12 +4013,9 @@ int BG_FindBuildDelayForWeapon( int weapon )
 {
   int i;
 
-  for( i = 0; i < bg_numWeapons; i++ )
+  if( ( i = BG_WeaponIndex( weapon ) ) >= 0 )
   {
-    if( bg_weapons[ i ].weaponNum == weapon )
-    {
-      return bg_weapons[ i ].buildDelay;
-    }
+    return bg_weapons[ i ].buildDelay;
   }
 
   return 0;
@@ -4178,12 +4030,9 @@ WUTeam_t BG_FindTeamForWeapon( int weapon )
 {
   int i;
 
-  for( i = 0; i < bg_numWeapons; i++ )
+  if( ( i = BG_WeaponIndex( weapon ) ) >= 0 )
   {
-    if( bg_weapons[ i ].weaponNum == weapon )
-    {
-      return bg_weapons[ i ].team;
-    }
+    return bg_weapons[ i ].team;
   }
 
   return WUT_NONE;
@@ -4293,21 +4142,54 @@ upgradeAttributes_t bg_upgrades[ ] =
 
 int   bg_numUpgrades = sizeof( bg_upgrades ) / sizeof( bg_upgrades[ 0 ] );
 
+//bg_upgradeIndex[ n ] is the position of n in bg_upgrades, built on first lookup
+static int      bg_upgradeIndex[ UP_NUM_UPGRADES ];
+static qboolean bg_upgradeIndexed = qfalse;
+
 /*
 ==============
-BG_FindPriceForUpgrade
+BG_UpgradeIndex
+
+Map an enum value to its bg_upgrades entry, or -1 if there isn't one
 ==============
 */
-int BG_FindPriceForUpgrade( int upgrade )
+static int BG_UpgradeIndex( int n )
 {
   int i;
 
-  for( i = 0; i < bg_numUpgrades; i++ )
+  if( !bg_upgradeIndexed )
   {
-    if( bg_upgrades[ i ].upgradeNum == upgrade )
+    for( i = 0; i < UP_NUM_UPGRADES; i++ )
+      bg_upgradeIndex[ i ] = -1;
+
+    //first entry wins, as with the old linear scans
+    for( i = bg_numUpgrades - 1; i >= 0; i-- )
     {
-      return bg_upgrades[ i ].price;
+      if( bg_upgrades[ i ].upgradeNum >= 0 && bg_upgrades[ i ].upgradeNum < UP_NUM_UPGRADES )
+        bg_upgradeIndex[ bg_upgrades[ i ].upgradeNum ] = i;
     }
+
+    bg_upgradeIndexed = qtrue;
+  }
+
+  if( n < 0 || n >= UP_NUM_UPGRADES )
+    return -1;
+
+  return bg_upgradeIndex[ n ];
+}
+
+/*
+==============
+BG_FindPriceForUpgrade
+==============
+*/
+int BG_FindPriceForUpgrade( int upgrade )
+{
+  int i;
+
+  if( ( i = BG_UpgradeIndex( upgrade ) ) >= 0 )
+  {
+    return bg_upgrades[ i ].price;
   }
 
   return 100;
@@ -4322,15 +4204,12 @@ qboolean BG_FindStagesForUpgrade( int upgrade, stage_t stage )
 {
   int i;
 
-  for( i = 0; i < bg_numUpgrades; i++ )
+  if( ( i = BG_UpgradeIndex( upgrade ) ) >= 0 )
   {
-    if( bg_upgrades[ i ].upgradeNum == upgrade )
-    {
-      if( bg_upgrades[ i ].stages & ( 1 << stage ) )
-        return qtrue;
-      else
-        return qfalse;
-    }
+    if( bg_upgrades[ i ].stages & ( 1 << stage ) )
+      return qtrue;
+    else
+      return qfalse;
   }
 
   return qfalse;
@@ -4345,12 +4224,9 @@ int BG_FindSlotsForUpgrade( int upgrade )
 {
   int i;
 
-  for( i = 0; i < bg_numUpgrades; i++ )
+  if( ( i = BG_UpgradeIndex( upgrade ) ) >= 0 )
   {
-    if( bg_upgrades[ i ].upgradeNum == upgrade )
-    {
-      return bg_upgrades[ i ].slots;
-    }
+    return bg_upgrades[ i ].slots;
   }
 
   return SLOT_NONE;
@@ -4365,11 +4241,8 @@ char *BG_FindNameForUpgrade( int upgrade )
 {
   int i;
 
-  for( i = 0; i < bg_numUpgrades; i++ )
-  {
-    if( bg_upgrades[ i ].upgradeNum == upgrade )
-      return bg_upgrades[ i ].upgradeName;
-  }
+  if( ( i = BG_UpgradeIndex( upgrade ) ) >= 0 )
+    return bg_upgrades[ i ].upgradeName;
 
   //wimp out
   return 0;
@@ -4403,11 +4276,8 @@ char *BG_FindHumanNameForUpgrade( int upgrade )
 {
   int i;
 
-  for( i = 0; i < bg_numUpgrades; i++ )
-  {
-    if( bg_upgrades[ i ].upgradeNum == upgrade )
-      return bg_upgrades[ i ].upgradeHumanName;
-  }
+  if( ( i = BG_UpgradeIndex( upgrade ) ) >= 0 )
+    return bg_upgrades[ i ].upgradeHumanName;
 
   //wimp out
   return 0;
@@ -4422,11 +4292,8 @@ char *BG_FindIconForUpgrade( int upgrade )
 {
   int i;
 
-  for( i = 0; i < bg_numUpgrades; i++ )
-  {
-    if( bg_upgrades[ i ].upgradeNum == upgrade )
-      return bg_upgrades[ i ].icon;
-  }
+  if( ( i = BG_UpgradeIndex( upgrade ) ) >= 0 )
+    return bg_upgrades[ i ].icon;
 
   //wimp out
   return 0;
@@ -4441,11 +4308,8 @@ qboolean BG_FindPurchasableForUpgrade( int upgrade )
 {
   int i;
 
-  for( i = 0; i < bg_numUpgrades; i++ )
-  {
-    if( bg_upgrades[ i ].upgradeNum == upgrade )
-      return bg_upgrades[ i ].purchasable;
-  }
+  if( ( i = BG_UpgradeIndex( upgrade ) ) >= 0 )
+    return bg_upgrades[ i ].purchasable;
 
   return qfalse;
 }
@@ -4459,11 +4323,8 @@ qboolean BG_FindUsableForUpgrade( int upgrade )
 {
   int i;
 
-  for( i = 0; i < bg_numUpgrades; i++ )
-  {
-    if( bg_upgrades[ i ].upgradeNum == upgrade )
-      return bg_upgrades[ i ].usable;
-  }
+  if( ( i = BG_UpgradeIndex( upgrade ) ) >= 0 )
+    return bg_upgrades[ i ].usable;
 
   return qfalse;
 }
@@ -4477,12 +4338,9 @@ WUTeam_t BG_FindTeamForUpgrade( int upgrade )
 {
   int i;
 
-  for( i = 0; i < bg_numUpgrades; i++ )
+  if( ( i = BG_UpgradeIndex( upgrade ) ) >= 0 )
   {
-    if( bg_upgrades[ i ].upgradeNum == upgrade )
-    {
-      return bg_upgrades[ i ].team;
-    }
+    return bg_upgrades[ i ].team;
   }
 
   return WUT_NONE;
@@ -276,8 +276,8 @@ void ClientImpacts( gentity_t *ent, pmove_t *pm )
     // if our movement is blocked by another player's real position,
     // don't use the unlagged position for them because they are 
     // blocking or server-side Pmove() from reaching it
-    if( other->client && other->client->unlaggedCalc.used )
-      other->client->unlaggedCalc.used = qfalse;
+    if( other->client )
+      G_UnlaggedSkip( other );
 
     //charge attack
     if( ent->client->ps.weapon == WP_ALEVEL4 &&
@@ -831,34 +831,49 @@ void ClientTimerActions( gentity_t *ent, int msec )
     if( client->ps.stats[ STAT_PTEAM ] == PTE_ALIENS &&
       level.surrenderTeam != PTE_ALIENS )
     {
-      int       entityList[ MAX_GENTITIES ];
+      gentity_t *entityList[ MAX_CLIENTS ];
       vec3_t    range = { LEVEL4_REGEN_RANGE, LEVEL4_REGEN_RANGE, LEVEL4_REGEN_RANGE };
       vec3_t    mins, maxs;
-      int       i, num;
+      int       i, num, after;
       gentity_t *boostEntity;
       float     modifier = 1.0f;
 
       VectorAdd( client->ps.origin, range, maxs );
       VectorSubtract( client->ps.origin, range, mins );
 
-      num = trap_EntitiesInBox( mins, maxs, entityList, MAX_GENTITIES );
+      num = G_ClientsInBox( mins, maxs, PTE_ALIENS, entityList, MAX_CLIENTS );
       for( i = 0; i < num; i++ )
       {
-        boostEntity = &g_entities[ entityList[ i ] ];
+        boostEntity = entityList[ i ];
 
-        if( boostEntity->client && boostEntity->client->ps.stats[ STAT_PTEAM ] == PTE_ALIENS &&
-            boostEntity->client->ps.stats[ STAT_PCLASS ] == PCL_ALIEN_LEVEL4 )
+        if( boostEntity->client->ps.stats[ STAT_PCLASS ] == PCL_ALIEN_LEVEL4 )
         {
           modifier = LEVEL4_REGEN_MOD;
           break;
         }
-        else if( boostEntity->s.eType == ET_BUILDABLE &&
-            boostEntity->s.modelindex == BA_A_BOOSTER &&
-            boostEntity->spawned && boostEntity->health > 0 )
+      }
+
+      // buildables are walked a list's worth at a time
+      after = -1;
+      while( modifier == 1.0f )
+      {
+        num = G_BuildablesInBox( mins, maxs, after, entityList, MAX_CLIENTS );
+        for( i = 0; i < num; i++ )
         {
-          modifier = BOOSTER_REGEN_MOD;
-          break;
+          boostEntity = entityList[ i ];
+
+          if( boostEntity->s.modelindex == BA_A_BOOSTER &&
+              boostEntity->spawned && boostEntity->health > 0 )
+          {
+            modifier = BOOSTER_REGEN_MOD;
+            break;
+          }
         }
+
+        if( num < MAX_CLIENTS )
+          break;
+
+        after = entityList[ num - 1 ]->s.number;
       }
 
       if( ent->health > 0 && ent->health < client->ps.stats[ STAT_MAX_HEALTH ] &&
@@ -1084,38 +1099,45 @@ void SendPendingPredictableEvents( playerState_t *ps )
 ==============
  G_UnlaggedStore
 
- Called on every server frame.  Stores position data for the client at that 
- into client->unlaggedHist[] and the time into level.unlaggedTimes[].  
- This data is used by G_UnlaggedCalc()
+ Called on every server frame.  Stores position data for all clients as a
+ new marker in level.unlagged.  This data is used by G_UnlaggedCalc()
 ==============
 */
 void G_UnlaggedStore( void )
 {
-  int i = 0;
-  gentity_t *ent;
-  unlagged_t *save;
-  
+  int               i;
+  int               marker;
+  gentity_t         *ent;
+  unlaggedHistory_t *hist = &level.unlagged;
+
   if( !g_unlagged.integer )
     return;
-  level.unlaggedIndex++; 
-  if( level.unlaggedIndex >= MAX_UNLAGGED_MARKERS )
-    level.unlaggedIndex = 0;
 
-  level.unlaggedTimes[ level.unlaggedIndex ] = level.time;
- 
-  for( i = 0; i < level.maxclients; i++ )
+  // the marker being replaced may be one the last rewind lerps from
+  hist->rewinding = qfalse;
+  hist->calcSerial++;
+
+  marker = hist->newest + 1;
+  if( marker >= MAX_UNLAGGED_MARKERS )
+    marker = 0;
+
+  hist->newest = marker;
+  if( hist->count < MAX_UNLAGGED_MARKERS )
+    hist->count++;
+
+  hist->times[ marker ] = level.time;
+
+  for( i = 0, ent = g_entities; i < level.maxclients; i++, ent++ )
   {
-    ent = &g_entities[ i ];
-    save = &ent->client->unlaggedHist[ level.unlaggedIndex ];
-    save->used = qfalse; 
+    hist->used[ marker ][ i ] = qfalse;
     if( !ent->r.linked || !( ent->r.contents & CONTENTS_BODY ) )
       continue;
     if( ent->client->pers.connected != CON_CONNECTED )
-      continue; 
-    VectorCopy( ent->r.mins, save->mins );
-    VectorCopy( ent->r.maxs, save->maxs );
-    VectorCopy( ent->s.pos.trBase, save->origin );
-    save->used = qtrue;
+      continue;
+    VectorCopy( ent->r.mins, hist->mins[ marker ][ i ] );
+    VectorCopy( ent->r.maxs, hist->maxs[ marker ][ i ] );
+    VectorCopy( ent->s.pos.trBase, hist->origins[ marker ][ i ] );
+    hist->used[ marker ][ i ] = qtrue;
   }
 }
 
@@ -1123,100 +1145,155 @@ void G_UnlaggedStore( void )
 ==============
  G_UnlaggedClear
  
- Mark all unlaggedHist[] markers for this client invalid.  Useful for
+ Mark all stored markers for this client invalid.  Useful for
  preventing teleporting and death.
 ==============
 */
 void G_UnlaggedClear( gentity_t *ent )
 {
   int i;
+  int clientNum = ent - g_entities;
 
   for( i = 0; i < MAX_UNLAGGED_MARKERS; i++ )
-    ent->client->unlaggedHist[ i ].used = qfalse;
+    level.unlagged.used[ i ][ clientNum ] = qfalse;
+}
+
+/*
+==============
+ G_UnlaggedMarker
+
+ Ring index of the n'th oldest stored marker
+==============
+*/
+static int G_UnlaggedMarker( int n )
+{
+  int marker = level.unlagged.newest - level.unlagged.count + 1 + n;
+
+  if( marker < 0 )
+    marker += MAX_UNLAGGED_MARKERS;
+
+  return marker;
 }
 
 /*
 ==============
  G_UnlaggedCalc
 
- Loops through all active clients and calculates their predicted position
- for time then stores it in client->unlaggedCalc
+ Finds the two markers either side of time for G_UnlaggedPosition() to lerp
+ between.  Clients are only lerped when something asks where they were.
 ==============
 */
 void G_UnlaggedCalc( int time, gentity_t *rewindEnt )
 {
-  int i = 0;
-  gentity_t *ent;
-  int startIndex = level.unlaggedIndex;
-  int stopIndex = -1;
-  int frameMsec = 0;
-  float lerp = 0.5f;
+  unlaggedHistory_t *hist = &level.unlagged;
+  int               lo, hi, mid;
+  int               frameMsec;
 
   if( !g_unlagged.integer )
     return;
- 
-  // clear any calculated values from a previous run
-  for( i = 0; i < level.maxclients; i++ )
-  {
-    ent = &g_entities[ i ];
-    ent->client->unlaggedCalc.used = qfalse;
-  }
 
-  for( i = 0; i < MAX_UNLAGGED_MARKERS; i++ )
+  // forget the positions calculated for a previous run
+  hist->calcSerial++;
+  hist->rewinding = qfalse;
+
+  // client is on the current frame, no need for unlagged
+  if( !hist->count || hist->times[ hist->newest ] <= time )
+    return;
+
+  hist->rewindEnt = rewindEnt;
+  hist->rewinding = qtrue;
+
+  if( hist->times[ G_UnlaggedMarker( 0 ) ] > time )
   {
-    if( level.unlaggedTimes[ startIndex ] <= time )
-      break;
-    stopIndex = startIndex;
-    if( --startIndex < 0 )
-      startIndex = MAX_UNLAGGED_MARKERS - 1;
+    // the oldest marker still isn't old enough, so rewind as far as the
+    // history goes with no lerping
+    hist->start = hist->stop = G_UnlaggedMarker( 0 );
+    hist->lerp = 0.0f;
+    return;
   }
-  if( i == MAX_UNLAGGED_MARKERS )
+
+  // binary search for the markers either side of time, keeping
+  // times[ lo ] <= time < times[ hi ]
+  lo = 0;
+  hi = hist->count - 1;
+  while( hi - lo > 1 )
   {
-    // if we searched all markers and the oldest one still isn't old enough
-    // just use the oldest marker with no lerping
-    lerp = 0.0f;
+    mid = ( lo + hi ) / 2;
+    if( hist->times[ G_UnlaggedMarker( mid ) ] <= time )
+      lo = mid;
+    else
+      hi = mid;
   }
 
-  // client is on the current frame, no need for unlagged
-  if( stopIndex == -1 )
-    return;
+  hist->start = G_UnlaggedMarker( lo );
+  hist->stop = G_UnlaggedMarker( hi );
 
   // lerp between two markers
-  frameMsec = level.unlaggedTimes[ stopIndex ] -
-    level.unlaggedTimes[ startIndex ];
+  hist->lerp = 0.5f;
+  frameMsec = hist->times[ hist->stop ] - hist->times[ hist->start ];
   if( frameMsec > 0 )
   {
-    lerp = ( float )( time - level.unlaggedTimes[ startIndex ] )
-      / ( float )frameMsec; 
+    hist->lerp = ( float )( time - hist->times[ hist->start ] )
+      / ( float )frameMsec;
   }
-  
-  for( i = 0; i < level.maxclients; i++ )
-  {
-    ent = &g_entities[ i ];
-    if( ent == rewindEnt )
-      continue;
-    if( !ent->r.linked || !( ent->r.contents & CONTENTS_BODY ) )
-      continue;
-    if( ent->client->pers.connected != CON_CONNECTED )
-      continue;
-    if( !ent->client->unlaggedHist[ startIndex ].used )
-      continue;
-    if( !ent->client->unlaggedHist[ stopIndex ].used )
-      continue;
+}
 
-    // between two unlagged markers
-    VectorLerp( lerp, ent->client->unlaggedHist[ startIndex ].mins,
-      ent->client->unlaggedHist[ stopIndex ].mins,
-      ent->client->unlaggedCalc.mins );
-    VectorLerp( lerp, ent->client->unlaggedHist[ startIndex ].maxs,
-      ent->client->unlaggedHist[ stopIndex ].maxs,
-      ent->client->unlaggedCalc.maxs );
-    VectorLerp( lerp, ent->client->unlaggedHist[ startIndex ].origin,
-      ent->client->unlaggedHist[ stopIndex ].origin,
-      ent->client->unlaggedCalc.origin );
-
-    ent->client->unlaggedCalc.used = qtrue;
-  }
+/*
+==============
+ G_UnlaggedPosition
+
+ Where the last G_UnlaggedCalc() puts a client, lerped the first time it is
+ asked for.  The result has used set to qfalse if the client isn't rewound.
+==============
+*/
+unlagged_t *G_UnlaggedPosition( gentity_t *ent )
+{
+  unlaggedHistory_t *hist = &level.unlagged;
+  gclient_t         *client = ent->client;
+  unlagged_t        *calc = &client->unlaggedCalc;
+  int               clientNum = ent - g_entities;
+
+  if( client->unlaggedCalcSerial == hist->calcSerial )
+    return calc;
+
+  client->unlaggedCalcSerial = hist->calcSerial;
+  calc->used = qfalse;
+
+  if( !hist->rewinding || ent == hist->rewindEnt )
+    return calc;
+  if( !ent->r.linked || !( ent->r.contents & CONTENTS_BODY ) )
+    return calc;
+  if( client->pers.connected != CON_CONNECTED )
+    return calc;
+  if( !hist->used[ hist->start ][ clientNum ] )
+    return calc;
+  if( !hist->used[ hist->stop ][ clientNum ] )
+    return calc;
+
+  VectorLerp( hist->lerp, hist->mins[ hist->start ][ clientNum ],
+    hist->mins[ hist->stop ][ clientNum ], calc->mins );
+  VectorLerp( hist->lerp, hist->maxs[ hist->start ][ clientNum ],
+    hist->maxs[ hist->stop ][ clientNum ], calc->maxs );
+  VectorLerp( hist->lerp, hist->origins[ hist->start ][ clientNum ],
+    hist->origins[ hist->stop ][ clientNum ], calc->origin );
+
+  calc->used = qtrue;
+  hist->lerps++;
+
+  return calc;
+}
+
+/*
+==============
+ G_UnlaggedSkip
+
+ Use the real position of a client until the next G_UnlaggedCalc()
+==============
+*/
+void G_UnlaggedSkip( gentity_t *ent )
+{
+  ent->client->unlaggedCalcSerial = level.unlagged.calcSerial;
+  ent->client->unlaggedCalc.used = qfalse;
 }
 
 /*
@@ -1228,15 +1305,16 @@ void G_UnlaggedCalc( int time, gentity_t *rewindEnt )
 */
 void G_UnlaggedOff( void )
 {
-  int i = 0;
-  gentity_t *ent;
+  int               i;
+  gentity_t         *ent;
+  unlaggedHistory_t *hist = &level.unlagged;
   
   if( !g_unlagged.integer )
     return;
   
-  for( i = 0; i < level.maxclients; i++ )
+  for( i = 0; i < hist->numMoved; i++ )
   {
-    ent = &g_entities[ i ];
+    ent = &g_entities[ hist->moved[ i ] ];
     if( !ent->client->unlaggedBackup.used )
       continue;
     VectorCopy( ent->client->unlaggedBackup.mins, ent->r.mins );
@@ -1244,56 +1322,128 @@ void G_UnlaggedOff( void )
     VectorCopy( ent->client->unlaggedBackup.origin, ent->r.currentOrigin );
     ent->client->unlaggedBackup.used = qfalse;
     trap_LinkEntity( ent );
+    hist->relinks++;
   }
+
+  hist->numMoved = 0;
 }
 
 /*
 ==============
- G_UnlaggedOn
+ G_UnlaggedReach
 
- Called after G_UnlaggedCalc() to apply the calculated values to all active
- clients.  Once finished tracing, G_UnlaggedOff() must be called to restore
- the clients' position data
-
- As an optimization, all clients that have an unlagged position that is
- not touchable at "range" from "muzzle" will be ignored.  This is required
- to prevent a huge amount of trap_LinkEntity() calls per user cmd.
+ Whether the absolute box from mins to maxs can touch the segment of length
+ along dir from start, widened by radius.  The box is tested as its bounding
+ sphere, which is cheap and never culls a box that is really touched.
 ==============
 */
+static qboolean G_UnlaggedReach( const vec3_t mins, const vec3_t maxs,
+  const vec3_t start, const vec3_t dir, float length, float radius )
+{
+  vec3_t  center, delta;
+  float   along, reach;
 
-void G_UnlaggedOn( gentity_t *attacker, vec3_t muzzle, float range )
+  VectorAdd( mins, maxs, center );
+  VectorScale( center, 0.5f, center );
+  VectorSubtract( center, start, delta );
+
+  // distance from the closest point on the segment
+  along = DotProduct( delta, dir );
+  if( along < 0.0f )
+    along = 0.0f;
+  else if( along > length )
+    along = length;
+
+  VectorMA( delta, -along, dir, delta );
+
+  reach = radius + 0.5f * Distance( mins, maxs );
+  return VectorLengthSquared( delta ) <= reach * reach;
+}
+
+/*
+==============
+ G_UnlaggedMove
+
+ Moves every client that can touch the segment from start to end, widened by
+ radius, to its unlagged position.  A NULL end makes the segment a single
+ point.  A client has to move if either its real or its unlagged bounds reach
+ the segment, otherwise the trace would hit it where the attacker never saw
+ it.  Clients are first culled on the box around both markers they will be
+ lerped between, so only the ones that survive are lerped and relinked.
+==============
+*/
+static void G_UnlaggedMove( gentity_t *attacker, vec3_t start, vec3_t end, float radius )
 {
-  int i = 0;
-  gentity_t *ent;
-  unlagged_t *calc;
-  
+  int               i, j;
+  gentity_t         *ent;
+  unlagged_t        *calc;
+  unlaggedHistory_t *hist = &level.unlagged;
+  vec3_t            dir, mins, maxs;
+  float             length = 0.0f;
+  float             a, b;
+  qboolean          reachNow;
+
   if( !g_unlagged.integer )
     return;
 
   if( !attacker->client->pers.useUnlagged )
     return;
-  
-  for( i = 0; i < level.maxclients; i++ )
+
+  if( !hist->rewinding )
+    return;
+
+  hist->shots++;
+
+  VectorClear( dir );
+  if( end )
   {
-    ent = &g_entities[ i ];
-    calc = &ent->client->unlaggedCalc;
+    VectorSubtract( end, start, dir );
+    length = VectorNormalize( dir );
+  }
 
-    if( !calc->used )
-      continue;
+  for( i = 0, ent = g_entities; i < level.maxclients; i++, ent++ )
+  {
     if( ent->client->unlaggedBackup.used )
       continue;
     if( !ent->r.linked || !( ent->r.contents & CONTENTS_BODY ) )
       continue;
+
+    reachNow = G_UnlaggedReach( ent->r.absmin, ent->r.absmax,
+                                start, dir, length, radius );
+
+    if( !reachNow )
+    {
+      if( !hist->used[ hist->start ][ i ] || !hist->used[ hist->stop ][ i ] )
+        continue;
+
+      // the lerped box lies within the box around both markers' boxes
+      for( j = 0; j < 3; j++ )
+      {
+        a = hist->origins[ hist->start ][ i ][ j ] + hist->mins[ hist->start ][ i ][ j ];
+        b = hist->origins[ hist->stop ][ i ][ j ] + hist->mins[ hist->stop ][ i ][ j ];
+        mins[ j ] = ( a < b ) ? a : b;
+
+        a = hist->origins[ hist->start ][ i ][ j ] + hist->maxs[ hist->start ][ i ][ j ];
+        b = hist->origins[ hist->stop ][ i ][ j ] + hist->maxs[ hist->stop ][ i ][ j ];
+        maxs[ j ] = ( a > b ) ? a : b;
+      }
+
+      if( !G_UnlaggedReach( mins, maxs, start, dir, length, radius ) )
+        continue;
+    }
+
+    calc = G_UnlaggedPosition( ent );
+    if( !calc->used )
+      continue;
     if( VectorCompare( ent->r.currentOrigin, calc->origin ) )
       continue;
-    if( muzzle )
-    {
-      float r1 = Distance( calc->origin, calc->maxs );
-      float r2 = Distance( calc->origin, calc->mins );
-      float maxRadius = ( r1 > r2 ) ? r1 : r2;
 
-      if( Distance( muzzle, calc->origin ) > range + maxRadius )
-        continue; 
+    if( !reachNow )
+    {
+      VectorAdd( calc->origin, calc->mins, mins );
+      VectorAdd( calc->origin, calc->maxs, maxs );
+      if( !G_UnlaggedReach( mins, maxs, start, dir, length, radius ) )
+        continue;
     }
 
     // create a backup of the real positions
@@ -1301,14 +1451,66 @@ void G_UnlaggedOn( gentity_t *attacker, vec3_t muzzle, float range )
     VectorCopy( ent->r.maxs, ent->client->unlaggedBackup.maxs );
     VectorCopy( ent->r.currentOrigin, ent->client->unlaggedBackup.origin );
     ent->client->unlaggedBackup.used = qtrue;
+    hist->moved[ hist->numMoved++ ] = i;
 
     // move the client to the calculated unlagged position
     VectorCopy( calc->mins, ent->r.mins );
     VectorCopy( calc->maxs, ent->r.maxs );
     VectorCopy( calc->origin, ent->r.currentOrigin );
     trap_LinkEntity( ent );
+    hist->relinks++;
   }
 }
+
+/*
+==============
+ G_UnlaggedOn
+
+ Called after G_UnlaggedCalc() to apply the calculated values to all active
+ clients.  Once finished tracing, G_UnlaggedOff() must be called to restore
+ the clients' position data
+
+ As an optimization, all clients that have an unlagged position that is
+ not touchable at "range" from "muzzle" will be ignored.  This is required
+ to prevent a huge amount of trap_LinkEntity() calls per user cmd.
+==============
+*/
+void G_UnlaggedOn( gentity_t *attacker, vec3_t muzzle, float range )
+{
+  G_UnlaggedMove( attacker, muzzle, NULL, range );
+}
+
+/*
+==============
+ G_UnlaggedOnTrace
+
+ G_UnlaggedOn() for a single trace from start to end, only moving clients
+ within radius of the line.  radius should cover the trace's bounding box.
+==============
+*/
+void G_UnlaggedOnTrace( gentity_t *attacker, vec3_t start, vec3_t end, float radius )
+{
+  G_UnlaggedMove( attacker, start, end, radius );
+}
+
+/*
+==============
+ Svcmd_UnlaggedStats_f
+
+ unlaggedstats
+==============
+*/
+void Svcmd_UnlaggedStats_f( void )
+{
+  unlaggedHistory_t *hist = &level.unlagged;
+
+  G_Printf( "unlagged: %d markers, %d shots, %d clients lerped, %d relinks",
+            hist->count, hist->shots, hist->lerps, hist->relinks );
+  if( hist->shots )
+    G_Printf( " (%.2f per shot)", (float)hist->relinks / hist->shots );
+  G_Printf( "\n" );
+}
+
 /*
 ==============
  G_UnlaggedDetectCollisions
@@ -1333,36 +1535,26 @@ void G_UnlaggedOn( gentity_t *attacker, vec3_t muzzle, float range )
 */
 static void G_UnlaggedDetectCollisions( gentity_t *ent )
 {
-  unlagged_t *calc;
   trace_t tr;
-  float r1, r2;
-  float range;
 
   if( !g_unlagged.integer )
     return;
   if( !ent->client->pers.useUnlagged )
     return;
 
-  calc = &ent->client->unlaggedCalc;
-
   // if the client isn't moving, this is not necessary
   if( VectorCompare( ent->client->oldOrigin, ent->client->ps.origin ) )
     return;
 
-  range = Distance( ent->client->oldOrigin, ent->client->ps.origin );
-
-  // increase the range by the player's largest possible radius since it's
-  // the players bounding box that collides, not their origin
-  r1 = Distance( calc->origin, calc->mins );
-  r2 = Distance( calc->origin, calc->maxs );
-  range += ( r1 > r2 ) ? r1 : r2;
-
-  G_UnlaggedOn( ent, ent->client->oldOrigin, range );
+  // widen the move by the player's radius since it's the players bounding
+  // box that collides, not their origin
+  G_UnlaggedOnTrace( ent, ent->client->oldOrigin, ent->client->ps.origin,
+    RadiusFromBounds( ent->r.mins, ent->r.maxs ) );
 
   trap_Trace(&tr, ent->client->oldOrigin, ent->r.mins, ent->r.maxs,
     ent->client->ps.origin, ent->s.number,  MASK_PLAYERSOLID );
   if( tr.entityNum >= 0 && tr.entityNum < MAX_CLIENTS )
-    g_entities[ tr.entityNum ].client->unlaggedCalc.used = qfalse; 
+    G_UnlaggedSkip( &g_entities[ tr.entityNum ] );
 
   G_UnlaggedOff( );
 }
@@ -322,43 +322,220 @@ static qboolean admin_permission( char *flags, const char *flag, qboolean *perm
   return qfalse;
 }
 
+/*
+  admin index
+
+  g_admin_admins is hashed by GUID and g_admin_levels by level number so the
+  permission and level lookups don't scan the whole list. Anything that adds
+  admins or levels, or changes an admin's level or flags, has to call
+  admin_index_invalidate( ) or admin_index_add( ).
+*/
+
+#define ADMIN_GUID_BUCKETS    1024
+#define ADMIN_LEVEL_BUCKETS   64
+#define ADMIN_PERM_FLAGS      64    // flags with a slot in the per client cache
+#define ADMIN_PERM_HASH       128
+
+static int      adminGuidHead[ ADMIN_GUID_BUCKETS ];    // admin number, 0 for none
+static int      adminGuidNext[ MAX_ADMIN_ADMINS ];
+static int      adminLevelHead[ ADMIN_LEVEL_BUCKETS ];  // level number, 0 for none
+static int      adminLevelNext[ MAX_ADMIN_LEVELS ];
+static qboolean adminIndexDirty = qtrue;
+
+// bumped whenever cached permissions may have become stale
+static int      adminPermGeneration = 1;
+static char     adminPermFlags[ ADMIN_PERM_FLAGS ][ MAX_ADMIN_FLAG_LEN ];
+static int      adminPermFlagCount;
+static int      adminPermHash[ ADMIN_PERM_HASH ];       // flag id + 1, 0 for none
+
+static int admin_guid_hash( const char *guid, int buckets )
+{
+  unsigned int hash = 0;
+
+  while( *guid )
+    hash = hash * 31 + tolower( *guid++ );
+
+  return hash % buckets;
+}
+
+static int admin_level_hash( int level )
+{
+  return (unsigned int)level % ADMIN_LEVEL_BUCKETS;
+}
+
+static void admin_index_invalidate( void )
+{
+  adminIndexDirty = qtrue;
+  adminPermGeneration++;
+}
+
+static void admin_index_rebuild( void )
+{
+  int i, bucket;
+
+  memset( adminGuidHead, 0, sizeof( adminGuidHead ) );
+  memset( adminLevelHead, 0, sizeof( adminLevelHead ) );
+
+  // insert in reverse so chains are in list order and the first entry
+  // matching is the one a scan of the list would have found
+  for( i = MAX_ADMIN_ADMINS - 1; i >= 0; i-- )
+  {
+    if( !g_admin_admins[ i ] )
+      continue;
+
+    bucket = admin_guid_hash( g_admin_admins[ i ]->guid, ADMIN_GUID_BUCKETS );
+    adminGuidNext[ i ] = adminGuidHead[ bucket ];
+    adminGuidHead[ bucket ] = i + 1;
+  }
+
+  for( i = MAX_ADMIN_LEVELS - 1; i >= 0; i-- )
+  {
+    if( !g_admin_levels[ i ] )
+      continue;
+
+    bucket = admin_level_hash( g_admin_levels[ i ]->level );
+    adminLevelNext[ i ] = adminLevelHead[ bucket ];
+    adminLevelHead[ bucket ] = i + 1;
+  }
+
+  adminIndexDirty = qfalse;
+}
+
+// index an admin appended to the end of g_admin_admins
+static void admin_index_add( int i )
+{
+  int *link;
+
+  adminPermGeneration++;
+
+  if( adminIndexDirty )
+    return;
+
+  link = &adminGuidHead[ admin_guid_hash( g_admin_admins[ i ]->guid, ADMIN_GUID_BUCKETS ) ];
+  while( *link )
+    link = &adminGuidNext[ *link - 1 ];
+
+  adminGuidNext[ i ] = 0;
+  *link = i + 1;
+}
+
+static g_admin_admin_t *admin_find_guid( const char *guid )
+{
+  int a;
+
+  if( adminIndexDirty )
+    admin_index_rebuild( );
+
+  for( a = adminGuidHead[ admin_guid_hash( guid, ADMIN_GUID_BUCKETS ) ]; a;
+       a = adminGuidNext[ a - 1 ] )
+  {
+    if( !Q_stricmp( guid, g_admin_admins[ a - 1 ]->guid ) )
+      return g_admin_admins[ a - 1 ];
+  }
+
+  return NULL;
+}
+
+static g_admin_level_t *admin_find_level( int level )
+{
+  int l;
+
+  if( adminIndexDirty )
+    admin_index_rebuild( );
+
+  for( l = adminLevelHead[ admin_level_hash( level ) ]; l; l = adminLevelNext[ l - 1 ] )
+  {
+    if( g_admin_levels[ l - 1 ]->level == level )
+      return g_admin_levels[ l - 1 ];
+  }
+
+  return NULL;
+}
+
+// slot of a flag in the per client permission cache, -1 if there is none
+static int admin_perm_flag_id( const char *flag )
+{
+  int h, id;
+
+  if( strlen( flag ) >= MAX_ADMIN_FLAG_LEN )
+    return -1;
+
+  for( h = admin_guid_hash( flag, ADMIN_PERM_HASH ); ; h = ( h + 1 ) % ADMIN_PERM_HASH )
+  {
+    if( !( id = adminPermHash[ h ] ) )
+      break;
+
+    if( !strcmp( adminPermFlags[ id - 1 ], flag ) )
+      return id - 1;
+  }
+
+  if( adminPermFlagCount >= ADMIN_PERM_FLAGS )
+    return -1;
+
+  id = adminPermFlagCount++;
+  Q_strncpyz( adminPermFlags[ id ], flag, sizeof( adminPermFlags[ id ] ) );
+  adminPermHash[ h ] = id + 1;
+
+  return id;
+}
+
 // This function should only be used directly when the client is connecting and thus has no GUID.
 // Else, use G_admin_permission() 
 qboolean G_admin_permission_guid( char *guid, const char* flag )
 {
-  int i;
   int l = 0;
   qboolean perm = qfalse;
+  g_admin_admin_t *a;
+  g_admin_level_t *lv;
 
   // Does the admin specifically have this flag granted/denied to them, 
   // irrespective of their admin level?
-  for( i = 0; i < MAX_ADMIN_ADMINS && g_admin_admins[ i ]; i++ )
+  if( ( a = admin_find_guid( guid ) ) )
   {
-    if( !Q_stricmp( guid, g_admin_admins[ i ]->guid ) )
-    {
-      if( admin_permission( g_admin_admins[ i ]->flags, flag, &perm ) )
-        return perm;
-      l = g_admin_admins[ i ]->level;
-      break;
-    }
+    if( admin_permission( a->flags, flag, &perm ) )
+      return perm;
+    l = a->level;
   }
 
   // If not, is this flag granted/denied for their admin level?
-  for( i = 0; i < MAX_ADMIN_LEVELS && g_admin_levels[ i ]; i++ )
-  {
-    if( g_admin_levels[ i ]->level == l )
-      return admin_permission( g_admin_levels[ i ]->flags, flag, &perm ) &&
-        perm;
-  }
+  if( ( lv = admin_find_level( l ) ) )
+    return admin_permission( lv->flags, flag, &perm ) && perm;
   return qfalse;
 }
 
 
 qboolean G_admin_permission( gentity_t *ent, const char *flag )
 {
+  clientPersistant_t *pers;
+  int id, word, bit;
+  qboolean perm;
+
   if(!ent) return qtrue; //console always wins
 
-  return G_admin_permission_guid(ent->client->pers.guid, flag);
+  // results are cached per client until the admin config changes
+  pers = &ent->client->pers;
+  if( ( id = admin_perm_flag_id( flag ) ) < 0 )
+    return G_admin_permission_guid( pers->guid, flag );
+
+  if( pers->adminPermGen != adminPermGeneration )
+  {
+    pers->adminPermGen = adminPermGeneration;
+    pers->adminPermKnown[ 0 ] = pers->adminPermKnown[ 1 ] = 0;
+    pers->adminPermGranted[ 0 ] = pers->adminPermGranted[ 1 ] = 0;
+  }
+
+  word = id >> 5;
+  bit = 1 << ( id & 31 );
+
+  if( pers->adminPermKnown[ word ] & bit )
+    return ( pers->adminPermGranted[ word ] & bit ) ? qtrue : qfalse;
+
+  perm = G_admin_permission_guid( pers->guid, flag );
+  pers->adminPermKnown[ word ] |= bit;
+  if( perm )
+    pers->adminPermGranted[ word ] |= bit;
+
+  return perm;
 }
 
 qboolean G_admin_name_check( gentity_t *ent, char *name, char *err, int len )
@@ -451,26 +628,18 @@ qboolean G_admin_name_check( gentity_t *ent, char *name, char *err, int len )
 
 static qboolean admin_higher_guid( char *admin_guid, char *victim_guid )
 {
-  int i;
   int alevel = 0;
+  g_admin_admin_t *a;
 
-  for( i = 0; i < MAX_ADMIN_ADMINS && g_admin_admins[ i ]; i++ )
-  {
-    if( !Q_stricmp( admin_guid, g_admin_admins[ i ]->guid ) )
-    {
-      alevel = g_admin_admins[ i ]->level;
-      break;
-    }
-  }
-  for( i = 0; i < MAX_ADMIN_ADMINS && g_admin_admins[ i ]; i++ )
+  if( ( a = admin_find_guid( admin_guid ) ) )
+    alevel = a->level;
+
+  if( ( a = admin_find_guid( victim_guid ) ) )
   {
-    if( !Q_stricmp( victim_guid, g_admin_admins[ i ]->guid ) )
-    {
-      if( alevel < g_admin_admins[ i ]->level )
-        return qfalse;
-      if( strstr( g_admin_admins[ i ]->flags, va( "%s", ADMF_IMMUTABLE ) ) )
-        return qfalse;
-    }
+    if( alevel < a->level )
+      return qfalse;
+    if( strstr( a->flags, va( "%s", ADMF_IMMUTABLE ) ) )
+      return qfalse;
   }
   return qtrue;
 }
@@ -676,6 +845,7 @@ static void admin_default_levels( void )
     *l->flags = '\0';
     g_admin_levels[ i ] = l;
   }
+  admin_index_invalidate( );
 
   Q_strncpyz( g_admin_levels[ 0 ]->name, "^4Unknown Player",
     sizeof( l->name ) );
@@ -719,27 +889,16 @@ static void admin_default_levels( void )
 //  return a level for a player entity.
 int G_admin_level( gentity_t *ent )
 {
-  int i;
-  qboolean found = qfalse;
+  g_admin_admin_t *a;
 
   if( !ent )
   {
     return MAX_ADMIN_LEVELS;
   }
 
-  for( i = 0; i < MAX_ADMIN_ADMINS && g_admin_admins[ i ]; i++ )
+  if( ( a = admin_find_guid( ent->client->pers.guid ) ) )
   {
-    if( !Q_stricmp( g_admin_admins[ i ]->guid, ent->client->pers.guid ) )
-    {
-
-      found = qtrue;
-      break;
-    }
-  }
-
-  if( found )
-  {
-    return g_admin_admins[ i ]->level;
+    return a->level;
   }
 
   return 0;
@@ -748,26 +907,16 @@ int G_admin_level( gentity_t *ent )
 //  set a player's adminname
 void G_admin_set_adminname( gentity_t *ent )
 {
-  int i;
-  qboolean found = qfalse;
+  g_admin_admin_t *a;
 
   if( !ent )
   {
     return;
   }
 
-  for( i = 0; i < MAX_ADMIN_ADMINS && g_admin_admins[ i ]; i++ )
-  {
-    if( !Q_stricmp( g_admin_admins[ i ]->guid, ent->client->pers.guid ) )
-    {
-      found = qtrue;
-      break;
-    }
-  }
- 
-  if( found )
+  if( ( a = admin_find_guid( ent->client->pers.guid ) ) )
   {
-     Q_strncpyz( ent->client->pers.adminName, g_admin_admins[ i ]->name, sizeof( ent->client->pers.adminName ) );
+     Q_strncpyz( ent->client->pers.adminName, a->name, sizeof( ent->client->pers.adminName ) );
   }
   else
   {
@@ -778,16 +927,13 @@ void G_admin_set_adminname( gentity_t *ent )
 //  Get an admin's registered name
 const char *G_admin_get_adminname( gentity_t *ent )
 {
-  int i;
+  g_admin_admin_t *a;
 
   if( !ent )
     return "console";
 
-  for( i = 0; i < MAX_ADMIN_ADMINS && g_admin_admins[ i ]; i++ )
-  {
-    if( !Q_stricmp( g_admin_admins[ i ]->guid, ent->client->pers.guid ) )
-      return g_admin_admins[ i ]->name;
-  }
+  if( ( a = admin_find_guid( ent->client->pers.guid ) ) )
+    return a->name;
 
   return ent->client->pers.netname;
 }
@@ -819,9 +965,7 @@ char* G_admin_adminPrintName( gentity_t *ent )
 
 static void admin_log( gentity_t *admin, char *cmd, int skiparg )
 {
-  fileHandle_t f;
-  int len, i, j;
-  char string[ MAX_STRING_CHARS ], decoloured[ MAX_STRING_CHARS ];
+  char string[ MAX_STRING_CHARS ];
   int min, tens, sec;
   g_admin_admin_t *a;
   g_admin_level_t *l;
@@ -834,8 +978,8 @@ static void admin_log( gentity_t *admin, char *cmd, int skiparg )
     return ;
 
 
-  len = trap_FS_FOpenFile( g_adminLog.string, &f, FS_APPEND );
-  if( len < 0 )
+  // the file is kept open, and reopened if g_adminLog changes
+  if( !G_LogOpen( LOG_ADMIN, g_adminLog.string, qfalse ) )
   {
     G_Printf( "admin_log: error could not open %s\n", g_adminLog.string );
     return ;
@@ -848,27 +992,11 @@ static void admin_log( gentity_t *admin, char *cmd, int skiparg )
   sec -= tens * 10;
 
   *flags = '\0';
-  if( admin )
+  if( admin && ( a = admin_find_guid( admin->client->pers.guid ) ) )
   {
-    for( i = 0; i < MAX_ADMIN_ADMINS && g_admin_admins[ i ]; i++ )
-    {
-      if( !Q_stricmp( g_admin_admins[ i ]->guid , admin->client->pers.guid ) )
-      {
-
-        a = g_admin_admins[ i ];
-        Q_strncpyz( flags, a->flags, sizeof( flags ) );
-        for( j = 0; j < MAX_ADMIN_LEVELS && g_admin_levels[ j ]; j++ )
-        {
-          if( g_admin_levels[ j ]->level == a->level )
-          {
-            l = g_admin_levels[ j ];
-            Q_strcat( flags, sizeof( flags ), l->flags );
-            break;
-          }
-        }
-        break;
-      }
-    }
+    Q_strncpyz( flags, a->flags, sizeof( flags ) );
+    if( ( l = admin_find_level( a->level ) ) )
+      Q_strcat( flags, sizeof( flags ), l->flags );
   }
 
   if( G_SayArgc() > 1 + skiparg )
@@ -915,16 +1043,7 @@ static void admin_log( gentity_t *admin, char *cmd, int skiparg )
                  G_SayConcatArgs( 1 + skiparg ) );
   }
 
-  if( g_decolourLogfiles.integer )
-  {
-    G_DecolorString( string, decoloured );
-    trap_FS_Write( decoloured, strlen( decoloured ), f );
-  }
-  else
-  {
-     trap_FS_Write( string, strlen( string ), f );
-  }
-  trap_FS_FCloseFile( f );
+  G_LogWrite( LOG_ADMIN, string, g_decolourLogfiles.integer );
   
   if ( !Q_stricmp( cmd, "attempted" ) )
   {
@@ -1088,6 +1207,295 @@ void G_admin_duration( int secs, char *duration, int dursize )
     Com_sprintf( duration, dursize, "%i seconds", secs );
 }
 
+/*
+  ban index
+
+  Active bans are kept in a binary trie keyed by their IPv4 prefix and in a
+  hash of their GUIDs so G_admin_ban_check doesn't need to parse and compare
+  every ban. Bans with an expiry time also sit in a min-heap ordered by
+  expiry and drop out of the index once they run out. Anything that changes
+  a ban must call admin_ban_index( ) so the index stays in step with
+  g_admin_bans.
+*/
+
+#define BAN_TRIE_NODES    ( MAX_ADMIN_BANS * 32 + 1 )
+#define BAN_GUID_BUCKETS  1024
+
+static int            banTrieChild[ BAN_TRIE_NODES ][ 2 ];
+static int            banTrieHead[ BAN_TRIE_NODES ];  // ban number, 0 for none
+static int            banTrieUsed;
+static int            banTrieNode[ MAX_ADMIN_BANS ];  // -1 if not in the trie
+static int            banTrieNext[ MAX_ADMIN_BANS ];  // next ban at the same node
+
+static int            banGuidHead[ BAN_GUID_BUCKETS ];  // ban number, 0 for none
+static int            banGuidNext[ MAX_ADMIN_BANS ];
+static int            banGuidBucket[ MAX_ADMIN_BANS ];  // -1 if not in the hash
+
+static int            banHeap[ MAX_ADMIN_BANS ];
+static int            banHeapSize;
+static int            banHeapPos[ MAX_ADMIN_BANS ];     // -1 if not in the heap
+
+static qboolean       banIndexDirty = qtrue;
+
+// parse a ban's ip string, returns the number of leading bits that have to
+// match or -1 if it doesn't ban any address
+static int admin_ban_parse_ip( const char *ip, unsigned int *addr )
+{
+  int IP[ 5 ], k, count, mask;
+
+  memset( IP, 0, sizeof( IP ) );
+  count = sscanf( ip, "%d.%d.%d.%d/%d", &IP[4], &IP[3], &IP[2], &IP[1], &IP[0] );
+
+  if( count == 4 )
+    mask = 32;
+  else if( count == 5 )
+    mask = IP[ 0 ];
+  else if( count > 0 && count < 4 )
+    mask = 8 * count;
+  else
+    return -1;
+
+  // masks out of range are compared exactly
+  if( mask < 0 || mask > 32 )
+    mask = 32;
+
+  *addr = 0;
+  for( k = 4; k >= 1; k-- )
+    *addr |= (unsigned int)IP[ k ] << 8 * ( k - 1 );
+
+  return mask;
+}
+
+static void admin_ban_trie_clear( void )
+{
+  int i;
+
+  banTrieUsed = 1;
+  banTrieChild[ 0 ][ 0 ] = banTrieChild[ 0 ][ 1 ] = 0;
+  banTrieHead[ 0 ] = 0;
+
+  for( i = 0; i < MAX_ADMIN_BANS; i++ )
+    banTrieNode[ i ] = -1;
+}
+
+static void admin_ban_trie_insert( int i )
+{
+  unsigned int  addr;
+  int           bits, depth, node, bit;
+
+  if( ( bits = admin_ban_parse_ip( g_admin_bans[ i ]->ip, &addr ) ) < 0 )
+    return;
+
+  // nodes of removed bans aren't reclaimed, rebuild the trie when it fills
+  if( banTrieUsed + bits > BAN_TRIE_NODES )
+  {
+    qboolean  indexed[ MAX_ADMIN_BANS ];
+    int       j;
+
+    for( j = 0; j < MAX_ADMIN_BANS; j++ )
+      indexed[ j ] = ( banTrieNode[ j ] >= 0 );
+
+    admin_ban_trie_clear( );
+
+    for( j = 0; j < MAX_ADMIN_BANS; j++ )
+    {
+      if( indexed[ j ] )
+        admin_ban_trie_insert( j );
+    }
+  }
+
+  node = 0;
+  for( depth = 0; depth < bits; depth++ )
+  {
+    bit = ( addr >> ( 31 - depth ) ) & 1;
+
+    if( !banTrieChild[ node ][ bit ] )
+    {
+      banTrieChild[ banTrieUsed ][ 0 ] = banTrieChild[ banTrieUsed ][ 1 ] = 0;
+      banTrieHead[ banTrieUsed ] = 0;
+      banTrieChild[ node ][ bit ] = banTrieUsed++;
+    }
+
+    node = banTrieChild[ node ][ bit ];
+  }
+
+  banTrieNode[ i ] = node;
+  banTrieNext[ i ] = banTrieHead[ node ];
+  banTrieHead[ node ] = i + 1;
+}
+
+static void admin_ban_trie_remove( int i )
+{
+  int *link;
+
+  if( banTrieNode[ i ] < 0 )
+    return;
+
+  for( link = &banTrieHead[ banTrieNode[ i ] ]; *link; link = &banTrieNext[ *link - 1 ] )
+  {
+    if( *link == i + 1 )
+    {
+      *link = banTrieNext[ i ];
+      break;
+    }
+  }
+
+  banTrieNode[ i ] = -1;
+}
+
+static void admin_ban_guid_insert( int i )
+{
+  int bucket;
+
+  if( !*g_admin_bans[ i ]->guid )
+    return;
+
+  bucket = admin_guid_hash( g_admin_bans[ i ]->guid, BAN_GUID_BUCKETS );
+  banGuidBucket[ i ] = bucket;
+  banGuidNext[ i ] = banGuidHead[ bucket ];
+  banGuidHead[ bucket ] = i + 1;
+}
+
+static void admin_ban_guid_remove( int i )
+{
+  int *link;
+
+  if( banGuidBucket[ i ] < 0 )
+    return;
+
+  for( link = &banGuidHead[ banGuidBucket[ i ] ]; *link; link = &banGuidNext[ *link - 1 ] )
+  {
+    if( *link == i + 1 )
+    {
+      *link = banGuidNext[ i ];
+      break;
+    }
+  }
+
+  banGuidBucket[ i ] = -1;
+}
+
+static void admin_ban_heap_swap( int a, int b )
+{
+  int tmp = banHeap[ a ];
+
+  banHeap[ a ] = banHeap[ b ];
+  banHeap[ b ] = tmp;
+  banHeapPos[ banHeap[ a ] ] = a;
+  banHeapPos[ banHeap[ b ] ] = b;
+}
+
+static void admin_ban_heap_sift( int pos )
+{
+  int child;
+
+  // up
+  while( pos > 0 && g_admin_bans[ banHeap[ pos ] ]->expires <
+         g_admin_bans[ banHeap[ ( pos - 1 ) / 2 ] ]->expires )
+  {
+    admin_ban_heap_swap( pos, ( pos - 1 ) / 2 );
+    pos = ( pos - 1 ) / 2;
+  }
+
+  // down
+  while( ( child = pos * 2 + 1 ) < banHeapSize )
+  {
+    if( child + 1 < banHeapSize && g_admin_bans[ banHeap[ child + 1 ] ]->expires <
+        g_admin_bans[ banHeap[ child ] ]->expires )
+      child++;
+
+    if( g_admin_bans[ banHeap[ pos ] ]->expires <=
+        g_admin_bans[ banHeap[ child ] ]->expires )
+      break;
+
+    admin_ban_heap_swap( pos, child );
+    pos = child;
+  }
+}
+
+static void admin_ban_heap_remove( int i )
+{
+  int pos = banHeapPos[ i ];
+
+  if( pos < 0 )
+    return;
+
+  banHeapPos[ i ] = -1;
+  banHeapSize--;
+
+  if( pos < banHeapSize )
+  {
+    banHeap[ pos ] = banHeap[ banHeapSize ];
+    banHeapPos[ banHeap[ pos ] ] = pos;
+    admin_ban_heap_sift( pos );
+  }
+}
+
+// (re)index ban i according to its current ip, guid and expiry
+static void admin_ban_index( int i )
+{
+  int t;
+
+  if( banIndexDirty )
+    return;
+
+  admin_ban_trie_remove( i );
+  admin_ban_guid_remove( i );
+  admin_ban_heap_remove( i );
+
+  if( !g_admin_bans[ i ] )
+    return;
+
+  t = trap_RealTime( NULL );
+
+  // 0 is for perm ban
+  if( g_admin_bans[ i ]->expires != 0 &&
+       ( g_admin_bans[ i ]->expires - t ) < 1 )
+    return;
+
+  admin_ban_trie_insert( i );
+  admin_ban_guid_insert( i );
+
+  if( g_admin_bans[ i ]->expires != 0 )
+  {
+    banHeap[ banHeapSize ] = i;
+    banHeapPos[ i ] = banHeapSize++;
+    admin_ban_heap_sift( banHeapPos[ i ] );
+  }
+}
+
+static void admin_ban_index_rebuild( void )
+{
+  int i;
+
+  admin_ban_trie_clear( );
+  memset( banGuidHead, 0, sizeof( banGuidHead ) );
+  banHeapSize = 0;
+
+  for( i = 0; i < MAX_ADMIN_BANS; i++ )
+    banGuidBucket[ i ] = banHeapPos[ i ] = -1;
+
+  banIndexDirty = qfalse;
+
+  for( i = 0; i < MAX_ADMIN_BANS && g_admin_bans[ i ]; i++ )
+    admin_ban_index( i );
+}
+
+// drop bans that have run out from the index
+static void admin_ban_expire( int t )
+{
+  int i;
+
+  while( banHeapSize > 0 &&
+         ( g_admin_bans[ banHeap[ 0 ] ]->expires - t ) < 1 )
+  {
+    i = banHeap[ 0 ];
+    admin_ban_trie_remove( i );
+    admin_ban_guid_remove( i );
+    admin_ban_heap_remove( i );
+  }
+}
+
 qboolean G_admin_ban_check( char *userinfo, char *reason, int rlen )
 {
   static char lastConnectIP[ 16 ] = {""};
@@ -1096,8 +1504,9 @@ qboolean G_admin_ban_check( char *userinfo, char *reason, int rlen )
   char ip[ 16 ];
   char *value;
   int i;
-  unsigned int userIP = 0, intIP = 0, tempIP;
-  int IP[5], k, mask, ipscanfcount;
+  unsigned int userIP = 0;
+  int IP[5], k;
+  int node, depth, b, ipBan, guidBan;
   int t;
   char notice[51];
   qboolean ignoreIP = qfalse;
@@ -1131,102 +1540,227 @@ qboolean G_admin_ban_check( char *userinfo, char *reason, int rlen )
     userIP |= IP[k] << 8*(k-1);
   }
   ignoreIP = G_admin_permission_guid( guid , ADMF_BAN_IMMUNITY );
-  for( i = 0; i < MAX_ADMIN_BANS && g_admin_bans[ i ]; i++ )
-  {
-    // 0 is for perm ban
-    if( g_admin_bans[ i ]->expires != 0 &&
-         ( g_admin_bans[ i ]->expires - t ) < 1 )
-      continue;
-    if( !ignoreIP )
-    {
-      tempIP = userIP;
-      intIP = 0;
-      mask = -1;
-
-      memset( IP, 0, sizeof( IP ));
-      ipscanfcount = sscanf(g_admin_bans[ i ]->ip, "%d.%d.%d.%d/%d", &IP[4], &IP[3], &IP[2], &IP[1], &IP[0]);
 
-      if( ipscanfcount == 4 )
-        mask = -1;
-      else if( ipscanfcount == 5 )
-        mask = IP[0];
-      else if( ipscanfcount > 0 && ipscanfcount < 4 )
-        mask = 8 * ipscanfcount;
-      else
-        continue;
+  if( banIndexDirty )
+    admin_ban_index_rebuild( );
+  admin_ban_expire( t );
 
-      for(k = 4; k >= 1; k--)
+  // the lowest numbered ban matching either the ip or the guid wins
+  ipBan = guidBan = MAX_ADMIN_BANS;
+  if( !ignoreIP )
+  {
+    node = 0;
+    for( depth = 0; ; depth++ )
+    {
+      for( b = banTrieHead[ node ]; b; b = banTrieNext[ b - 1 ] )
       {
-        if(!IP[k]) continue;
-        intIP |= IP[k] << 8*(k-1);
+        if( b - 1 < ipBan )
+          ipBan = b - 1;
       }
 
-      if(mask > 0 && mask <= 32) 
-      {
-        tempIP &= ~((1 << (32-mask)) - 1);
-        intIP &= ~((1 << (32-mask)) - 1);
-      }
+      if( depth == 32 )
+        break;
 
-      if( intIP == tempIP || mask == 0 )
-      {
-        char duration[ 32 ];
-        G_admin_duration( ( g_admin_bans[ i ]->expires - t ),
-          duration, sizeof( duration ) );
+      if( !( node = banTrieChild[ node ][ ( userIP >> ( 31 - depth ) ) & 1 ] ) )
+        break;
+    }
+  }
 
-        // flood protected
-        if( t - lastConnectTime >= 300 ||
-            Q_stricmp( lastConnectIP, ip ) )
-        {
-          lastConnectTime = t;
-          Q_strncpyz( lastConnectIP, ip, sizeof( lastConnectIP ) );
-
-          G_AdminsPrintf(
-            "Banned player %s^7 (%s^7) tried to connect (ban #%i on %s by %s^7 expires %s reason: %s^7 )\n",
-            Info_ValueForKey( userinfo, "name" ),
-            g_admin_bans[ i ]->name,
-            i+1,
-            ip, 
-            g_admin_bans[ i ]->banner,
-            duration,
-            g_admin_bans[ i ]->reason );
-        }
-            
-        Com_sprintf(
-          reason,
-          rlen,
-          "You have been banned by %s^7 reason: %s^7 expires: %s       %s",
-          g_admin_bans[ i ]->banner,
-          g_admin_bans[ i ]->reason,
-          duration,
-          notice
-          );
-        G_LogPrintf("Banned player tried to connect from IP %s\n", ip);
-        return qtrue;
-      }
+  if( *guid )
+  {
+    for( b = banGuidHead[ admin_guid_hash( guid, BAN_GUID_BUCKETS ) ]; b; b = banGuidNext[ b - 1 ] )
+    {
+      if( b - 1 < guidBan && !Q_stricmp( g_admin_bans[ b - 1 ]->guid, guid ) )
+        guidBan = b - 1;
     }
-    if( *guid && !Q_stricmp( g_admin_bans[ i ]->guid, guid ) )
-    {
-      char duration[ 32 ];
-      G_admin_duration( ( g_admin_bans[ i ]->expires - t ),
-        duration, sizeof( duration ) );
-      Com_sprintf(
-        reason,
-        rlen,
-        "You have been banned by %s^7 reason: %s^7 expires: %s",
+  }
+
+  if( ipBan < MAX_ADMIN_BANS && ipBan <= guidBan )
+  {
+    char duration[ 32 ];
+    i = ipBan;
+    G_admin_duration( ( g_admin_bans[ i ]->expires - t ),
+      duration, sizeof( duration ) );
+
+    // flood protected
+    if( t - lastConnectTime >= 300 ||
+        Q_stricmp( lastConnectIP, ip ) )
+    {
+      lastConnectTime = t;
+      Q_strncpyz( lastConnectIP, ip, sizeof( lastConnectIP ) );
+
+      G_AdminsPrintf(
+        "Banned player %s^7 (%s^7) tried to connect (ban #%i on %s by %s^7 expires %s reason: %s^7 )\n",
+        Info_ValueForKey( userinfo, "name" ),
+        g_admin_bans[ i ]->name,
+        i+1,
+        ip, 
         g_admin_bans[ i ]->banner,
-        g_admin_bans[ i ]->reason,
-        duration
+        duration,
+        g_admin_bans[ i ]->reason );
+    }
+        
+    Com_sprintf(
+      reason,
+      rlen,
+      "You have been banned by %s^7 reason: %s^7 expires: %s       %s",
+      g_admin_bans[ i ]->banner,
+      g_admin_bans[ i ]->reason,
+      duration,
+      notice
       );
-      G_Printf("Banned player tried to connect with GUID %s\n", guid);
-      return qtrue;
-    }
+    G_LogPrintf("Banned player tried to connect from IP %s\n", ip);
+    return qtrue;
+  }
+  if( guidBan < MAX_ADMIN_BANS )
+  {
+    char duration[ 32 ];
+    i = guidBan;
+    G_admin_duration( ( g_admin_bans[ i ]->expires - t ),
+      duration, sizeof( duration ) );
+    Com_sprintf(
+      reason,
+      rlen,
+      "You have been banned by %s^7 reason: %s^7 expires: %s",
+      g_admin_bans[ i ]->banner,
+      g_admin_bans[ i ]->reason,
+      duration
+    );
+    G_Printf("Banned player tried to connect with GUID %s\n", guid);
+    return qtrue;
   }
   return qfalse;
 }
 
-qboolean G_admin_cmd_check( gentity_t *ent, qboolean say )
+/*
+  command index
+
+  g_admin_commands and g_admin_cmds are hashed together by name, custom
+  commands first so they keep overriding the built in ones. The custom
+  commands are only replaced by !readconfig, which invalidates the index.
+  Each entry also counts how often it was used or refused.
+*/
+
+#define ADMIN_CMD_HASH    256   // power of two, over MAX_ADMIN_COMMANDS + adminNumCmds
+
+// custom command i is stored as i + 1, built in command i as -( i + 1 )
+static int      adminCmdHash[ ADMIN_CMD_HASH ];
+static qboolean adminCmdIndexDirty = qtrue;
+static int      adminCmdUses[ sizeof( g_admin_cmds ) / sizeof( g_admin_cmds[ 0 ] ) ];
+static int      adminCmdDenied[ sizeof( g_admin_cmds ) / sizeof( g_admin_cmds[ 0 ] ) ];
+static int      adminCustomUses[ MAX_ADMIN_COMMANDS ];
+static int      adminCustomDenied[ MAX_ADMIN_COMMANDS ];
+
+static const char *admin_cmd_name( int c )
+{
+  if( c > 0 )
+    return g_admin_commands[ c - 1 ]->command;
+
+  return g_admin_cmds[ -c - 1 ].keyword;
+}
+
+static void admin_cmd_insert( int c )
+{
+  int h;
+
+  for( h = admin_guid_hash( admin_cmd_name( c ), ADMIN_CMD_HASH ); adminCmdHash[ h ];
+       h = ( h + 1 ) & ( ADMIN_CMD_HASH - 1 ) )
+  {
+    if( !Q_stricmp( admin_cmd_name( adminCmdHash[ h ] ), admin_cmd_name( c ) ) )
+      return;
+  }
+
+  adminCmdHash[ h ] = c;
+}
+
+static void admin_cmd_index_invalidate( void )
+{
+  adminCmdIndexDirty = qtrue;
+  memset( adminCustomUses, 0, sizeof( adminCustomUses ) );
+  memset( adminCustomDenied, 0, sizeof( adminCustomDenied ) );
+}
+
+static void admin_cmd_index_rebuild( void )
 {
   int i;
+
+  memset( adminCmdHash, 0, sizeof( adminCmdHash ) );
+
+  for( i = 0; i < MAX_ADMIN_COMMANDS && g_admin_commands[ i ]; i++ )
+    admin_cmd_insert( i + 1 );
+
+  for( i = 0; i < adminNumCmds; i++ )
+    admin_cmd_insert( -( i + 1 ) );
+
+  adminCmdIndexDirty = qfalse;
+}
+
+// returns an index as stored in adminCmdHash, 0 if there is no such command
+static int admin_find_cmd( const char *cmd )
+{
+  int h;
+
+  if( adminCmdIndexDirty )
+    admin_cmd_index_rebuild( );
+
+  for( h = admin_guid_hash( cmd, ADMIN_CMD_HASH ); adminCmdHash[ h ];
+       h = ( h + 1 ) & ( ADMIN_CMD_HASH - 1 ) )
+  {
+    if( !Q_stricmp( admin_cmd_name( adminCmdHash[ h ] ), cmd ) )
+      return adminCmdHash[ h ];
+  }
+
+  return 0;
+}
+
+static int QDECL admin_sort_cmd_uses( const void *a, const void *b )
+{
+  int ca = *(const int *)a, cb = *(const int *)b;
+  int ua, ub;
+
+  ua = ca > 0 ? adminCustomUses[ ca - 1 ] + adminCustomDenied[ ca - 1 ] :
+                adminCmdUses[ -ca - 1 ] + adminCmdDenied[ -ca - 1 ];
+  ub = cb > 0 ? adminCustomUses[ cb - 1 ] + adminCustomDenied[ cb - 1 ] :
+                adminCmdUses[ -cb - 1 ] + adminCmdDenied[ -cb - 1 ];
+
+  return ub - ua;
+}
+
+void G_admin_cmd_stats( void )
+{
+  int order[ MAX_ADMIN_COMMANDS + sizeof( g_admin_cmds ) / sizeof( g_admin_cmds[ 0 ] ) ];
+  int i, c, n = 0;
+  int uses, denied;
+
+  for( i = 0; i < MAX_ADMIN_COMMANDS && g_admin_commands[ i ]; i++ )
+  {
+    if( adminCustomUses[ i ] || adminCustomDenied[ i ] )
+      order[ n++ ] = i + 1;
+  }
+
+  for( i = 0; i < adminNumCmds; i++ )
+  {
+    if( adminCmdUses[ i ] || adminCmdDenied[ i ] )
+      order[ n++ ] = -( i + 1 );
+  }
+
+  qsort( order, n, sizeof( order[ 0 ] ), admin_sort_cmd_uses );
+
+  G_Printf( "%-16s %8s %8s\n", "admin command", "uses", "denied" );
+
+  for( i = 0; i < n; i++ )
+  {
+    c = order[ i ];
+    uses = c > 0 ? adminCustomUses[ c - 1 ] : adminCmdUses[ -c - 1 ];
+    denied = c > 0 ? adminCustomDenied[ c - 1 ] : adminCmdDenied[ -c - 1 ];
+
+    G_Printf( "!%-15s %8d %8d\n", admin_cmd_name( c ), uses, denied );
+  }
+}
+
+qboolean G_admin_cmd_check( gentity_t *ent, qboolean say )
+{
+  int i, c;
   char command[ MAX_ADMIN_CMD_LEN ];
   char *cmd;
   int skip = 0;
@@ -1260,36 +1794,40 @@ qboolean G_admin_cmd_check( gentity_t *ent, qboolean say )
     return qtrue;
    }
 
-  for( i = 0; i < MAX_ADMIN_COMMANDS && g_admin_commands[ i ]; i++ )
+  c = admin_find_cmd( cmd );
+
+  if( c > 0 )
   {
-    if( Q_stricmp( cmd, g_admin_commands[ i ]->command ) )
-      continue;
+    i = c - 1;
 
     if( G_admin_permission( ent, g_admin_commands[ i ]->flag ) )
     {
+      adminCustomUses[ i ]++;
       trap_SendConsoleCommand( EXEC_APPEND, g_admin_commands[ i ]->exec );
       admin_log( ent, cmd, skip );
     }
     else
     {
+      adminCustomDenied[ i ]++;
       ADMP( va( "^3!%s: ^7permission denied\n", g_admin_commands[ i ]->command ) );
       admin_log( ent, "attempted", skip - 1 );
     }
     return qtrue;
   }
 
-  for( i = 0; i < adminNumCmds; i++ )
+  if( c < 0 )
   {
-    if( Q_stricmp( cmd, g_admin_cmds[ i ].keyword ) )
-      continue;
+    i = -c - 1;
 
     if( G_admin_permission( ent, g_admin_cmds[ i ].flag ) )
     {
+      adminCmdUses[ i ]++;
       g_admin_cmds[ i ].handler( ent, skip );
       admin_log( ent, cmd, skip );
     }
     else
     {
+      adminCmdDenied[ i ]++;
       ADMP( va( "^3!%s: ^7permission denied\n", g_admin_cmds[ i ].keyword ) );
       admin_log( ent, "attempted", skip - 1 );
     }
@@ -1597,6 +2135,7 @@ qboolean G_admin_readconfig( gentity_t *ent, int skiparg )
     g_admin_bans[ bc++ ] = b;
   if( command_open )
     g_admin_commands[ cc++ ] = c;
+  admin_cmd_index_invalidate( );
   G_Free( cnf2 );
   ADMP( va( "^3!readconfig: ^7loaded %d levels, %d admins, %d bans, %d commands\n",
           lc, ac, bc, cc ) );
@@ -1781,6 +2320,8 @@ qboolean G_admin_setlevel( gentity_t *ent, int skiparg )
       updated = qtrue;
     }
   }
+  if( updated )
+    admin_index_invalidate( );
   if( !updated )
   {
     if( i == MAX_ADMIN_ADMINS )
@@ -1794,6 +2335,7 @@ qboolean G_admin_setlevel( gentity_t *ent, int skiparg )
     Q_strncpyz( a->guid, guid, sizeof( a->guid ) );
     *a->flags = '\0';
     g_admin_admins[ i ] = a;
+    admin_index_add( i );
   }
 
   AP( va( 
@@ -1893,6 +2435,7 @@ static qboolean admin_create_ban( gentity_t *ent,
     return qfalse;
   }
   g_admin_bans[ i ] = b;
+  admin_ban_index( i );
   return qtrue;
 }
 
@@ -2382,6 +2925,7 @@ qboolean G_admin_adjustban( gentity_t *ent, int skiparg )
     }
 
     g_admin_bans[ bnum - 1 ]->expires = expires;
+    admin_ban_index( bnum - 1 );
     G_admin_duration( ( expires ) ? expires - time : -1,
       duration, sizeof( duration ) );
   }
@@ -2515,6 +3059,7 @@ qboolean G_admin_subnetban( gentity_t *ent, int skiparg )
   if( ent )
     Q_strncpyz( g_admin_bans[ bnum - 1 ]->banner, G_admin_get_adminname( ent ),
       sizeof( g_admin_bans[ bnum - 1 ]->banner ) );
+  admin_ban_index( bnum - 1 );
   if( g_admin.string[ 0 ] )
     admin_writeconfig();
   return qtrue;
@@ -2555,6 +3100,7 @@ qboolean G_admin_unban( gentity_t *ent, int skiparg )
     return qfalse;
   }
   g_admin_bans[ bnum -1 ]->expires = t;
+  admin_ban_index( bnum - 1 );
   AP( va( "print \"^3!unban: ^7ban #%d for %s^7 has been removed by %s\n\"",
           bnum,
           g_admin_bans[ bnum - 1 ]->name,
@@ -4500,6 +5046,9 @@ void G_admin_cleanup()
     G_Free( g_admin_bans[ i ] );
     g_admin_bans[ i ] = NULL;
   }
+  banIndexDirty = qtrue;
+  admin_index_invalidate( );
+  admin_cmd_index_invalidate( );
   for( i = 0; i < MAX_ADMIN_COMMANDS && g_admin_commands[ i ]; i++ )
   {
     G_Free( g_admin_commands[ i ] );
@@ -563,7 +563,7 @@ static int botFindClosestEnemy( gentity_t *self, qboolean includeTeam ) {
   int vectorRange = MGTURRET_RANGE * 3;  
   int i;
   int total_entities;
-  int entityList[ MAX_GENTITIES ];
+  gentity_t *entityList[ MAX_CLIENTS ];
   vec3_t    range;
   vec3_t    mins, maxs;
   gentity_t *target;
@@ -572,19 +572,19 @@ static int botFindClosestEnemy( gentity_t *self, qboolean includeTeam ) {
   VectorAdd( self->client->ps.origin, range, maxs );
   VectorSubtract( self->client->ps.origin, range, mins );
 
-  total_entities = trap_EntitiesInBox( mins, maxs, entityList, MAX_GENTITIES );
+  total_entities = G_ClientsInBox( mins, maxs, PTE_NONE, entityList, MAX_CLIENTS );
 
   // check list for enemies
   for( i = 0; i < total_entities; i++ ) {
-    target = &g_entities[ entityList[ i ] ];
+    target = entityList[ i ];
 
     if( target->client && self != target && target->client->ps.stats[ STAT_PTEAM ] != self->client->ps.stats[ STAT_PTEAM ] ) {
       // aliens ignore if it's in LOS because they have radar
       if(self->client->ps.stats[ STAT_PTEAM ] == PTE_ALIENS) {
-        return entityList[ i ];
+        return target->s.number;
       } else {
         if( botTargetInRange( self, target ) ) {
-          return entityList[ i ];
+          return target->s.number;
         }
       }
     }
@@ -593,15 +593,15 @@ static int botFindClosestEnemy( gentity_t *self, qboolean includeTeam ) {
   if(includeTeam) {
     // check list for enemies in team
     for( i = 0; i < total_entities; i++ ) {
-      target = &g_entities[ entityList[ i ] ];
+      target = entityList[ i ];
 
       if( target->client && self !=target && target->client->ps.stats[ STAT_PTEAM ] == self->client->ps.stats[ STAT_PTEAM ] ) {
         // aliens ignore if it's in LOS because they have radar
         if(self->client->ps.stats[ STAT_PTEAM ] == PTE_ALIENS) {
-          return entityList[ i ];
+          return target->s.number;
         } else {
           if( botTargetInRange( self, target ) ) {
-            return entityList[ i ];
+            return target->s.number;
           }
         }
       }
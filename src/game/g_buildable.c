@@ -135,113 +135,681 @@ gentity_t *G_CheckSpawnPoint( int spawnNum, vec3_t origin, vec3_t normal,
   return NULL;
 }
 
+/*
+==============================================================================
+
+BUILDABLE REGISTRY
+
+Every ET_BUILDABLE is kept in a uniform grid over s.origin (x and y only)
+and in a list per modelindex, so the power/creep/dcc/overmind lookups
+don't have to walk all of g_entities. Buildables are linked when G_SetOrigin
+gives them a position and unlinked in G_FreeEntity. Counts per type are
+kept alongside so build points can be summed without a scan.
+
+==============================================================================
+*/
+
+#define BUILDABLE_CELL_SIZE     512
+#define BUILDABLE_GRID_BUCKETS  1024  // must be a power of two
+#define BUILDABLE_MAX_EXTENT    64    // more than any buildable's horizontal bounds
+
+static gentity_t  *buildableGrid[ BUILDABLE_GRID_BUCKETS ];
+static gentity_t  *buildableTypes[ BA_NUM_BUILDABLES ];
+static int        buildableCounts[ BA_NUM_BUILDABLES ];
+static int        poweredCounts[ BA_NUM_BUILDABLES ];   // humans only
+
+/*
+================
+G_BuildableCell
+
+Grid coordinates of a point
+================
+*/
+static int G_BuildableCell( float x )
+{
+  return (int)floor( x / BUILDABLE_CELL_SIZE );
+}
+
+/*
+================
+G_BuildableBucket
+
+Hash grid coordinates into a bucket
+================
+*/
+static int G_BuildableBucket( int x, int y )
+{
+  return ( ( x * 73856093 ) ^ ( y * 19349663 ) ) & ( BUILDABLE_GRID_BUCKETS - 1 );
+}
+
+/*
+================
+G_InitBuildableRegistry
+
+Forget all buildables, called when g_entities is cleared
+================
+*/
+void G_InitBuildableRegistry( void )
+{
+  memset( buildableGrid, 0, sizeof( buildableGrid ) );
+  memset( buildableTypes, 0, sizeof( buildableTypes ) );
+  memset( buildableCounts, 0, sizeof( buildableCounts ) );
+  memset( poweredCounts, 0, sizeof( poweredCounts ) );
+}
+
+/*
+================
+G_RemoveFromGrid
+
+Unlink a buildable from its grid bucket
+================
+*/
+static void G_RemoveFromGrid( gentity_t *ent )
+{
+  int bucket = G_BuildableBucket( ent->buildableCell[ 0 ], ent->buildableCell[ 1 ] );
+
+  if( ent->buildableCellPrev )
+    ent->buildableCellPrev->buildableCellNext = ent->buildableCellNext;
+  else
+    buildableGrid[ bucket ] = ent->buildableCellNext;
+
+  if( ent->buildableCellNext )
+    ent->buildableCellNext->buildableCellPrev = ent->buildableCellPrev;
+
+  ent->buildableCellNext = ent->buildableCellPrev = NULL;
+}
+
+/*
+================
+G_AddToGrid
+
+Link a buildable into the bucket for a grid cell
+================
+*/
+static void G_AddToGrid( gentity_t *ent, int x, int y )
+{
+  int bucket = G_BuildableBucket( x, y );
+
+  ent->buildableCell[ 0 ] = x;
+  ent->buildableCell[ 1 ] = y;
+
+  ent->buildableCellPrev = NULL;
+  ent->buildableCellNext = buildableGrid[ bucket ];
+  if( buildableGrid[ bucket ] )
+    buildableGrid[ bucket ]->buildableCellPrev = ent;
+  buildableGrid[ bucket ] = ent;
+}
+
+static void G_RemoveFromPowerNetwork( gentity_t *ent );
+static void G_BuildableMoved( gentity_t *ent );
+
+/*
+================
+G_UnlinkBuildable
+
+Remove a buildable from the registry and the power network
+================
+*/
+void G_UnlinkBuildable( gentity_t *ent )
+{
+  if( !ent->buildableLinked )
+    return;
+
+  G_RemoveFromGrid( ent );
+
+  if( ent->buildableTypePrev )
+    ent->buildableTypePrev->buildableTypeNext = ent->buildableTypeNext;
+  else
+    buildableTypes[ ent->s.modelindex ] = ent->buildableTypeNext;
+
+  if( ent->buildableTypeNext )
+    ent->buildableTypeNext->buildableTypePrev = ent->buildableTypePrev;
+
+  ent->buildableTypeNext = ent->buildableTypePrev = NULL;
+  ent->buildableLinked = qfalse;
+
+  buildableCounts[ ent->s.modelindex ]--;
+  if( ent->biteam == BIT_HUMANS && ent->powered )
+    poweredCounts[ ent->s.modelindex ]--;
+
+  G_RemoveFromPowerNetwork( ent );
+}
+
+/*
+================
+G_LinkBuildable
+
+Add a buildable to the registry, or move it to the cell of its current s.origin
+================
+*/
+void G_LinkBuildable( gentity_t *ent )
+{
+  int       x, y;
+  gentity_t *prev, *next;
+
+  if( ent->s.modelindex <= BA_NONE || ent->s.modelindex >= BA_NUM_BUILDABLES )
+    return;
+
+  x = G_BuildableCell( ent->s.origin[ 0 ] );
+  y = G_BuildableCell( ent->s.origin[ 1 ] );
+
+  if( ent->buildableLinked )
+  {
+    if( ent->buildableCell[ 0 ] != x || ent->buildableCell[ 1 ] != y )
+    {
+      G_RemoveFromGrid( ent );
+      G_AddToGrid( ent, x, y );
+    }
+
+    G_BuildableMoved( ent );
+    return;
+  }
+
+  G_AddToGrid( ent, x, y );
+
+  // keep the type lists in entity order so lookups resolve ties the same
+  // way a scan of g_entities would
+  prev = NULL;
+  for( next = buildableTypes[ ent->s.modelindex ]; next && next < ent;
+       next = next->buildableTypeNext )
+    prev = next;
+
+  ent->buildableTypePrev = prev;
+  ent->buildableTypeNext = next;
+  if( prev )
+    prev->buildableTypeNext = ent;
+  else
+    buildableTypes[ ent->s.modelindex ] = ent;
+  if( next )
+    next->buildableTypePrev = ent;
+
+  ent->buildableLinked = qtrue;
+
+  buildableCounts[ ent->s.modelindex ]++;
+  if( ent->biteam == BIT_HUMANS && ent->powered )
+    poweredCounts[ ent->s.modelindex ]++;
+}
+
+/*
+================
+G_BuildableCount
+
+Number of buildables of a type, optionally only those that are powered
+================
+*/
+int G_BuildableCount( buildable_t buildable, qboolean poweredOnly )
+{
+  if( buildable <= BA_NONE || buildable >= BA_NUM_BUILDABLES )
+    return 0;
+
+  if( poweredOnly )
+    return poweredCounts[ buildable ];
+
+  return buildableCounts[ buildable ];
+}
+
+/*
+================
+G_FirstBuildableOfType
+
+Head of the list of buildables of a type, follow buildableTypeNext for the rest
+================
+*/
+gentity_t *G_FirstBuildableOfType( buildable_t buildable )
+{
+  if( buildable <= BA_NONE || buildable >= BA_NUM_BUILDABLES )
+    return NULL;
+
+  return buildableTypes[ buildable ];
+}
+
 /*
 ================
-G_NumberOfDependants
+G_SortBuildablesByNumber
 
-Return number of entities that depend on this one
+qsort comparison function for G_BuildablesInRadius
 ================
 */
-static int G_NumberOfDependants( gentity_t *self )
+static int QDECL G_SortBuildablesByNumber( const void *a, const void *b )
 {
-  int       i, n = 0;
+  return ( *(gentity_t **)a ) - ( *(gentity_t **)b );
+}
+
+/*
+================
+G_BuildablesInRadius
+
+Fill list with the buildables in the grid cells that touch a sphere, sorted
+by entity number. The list may contain buildables just outside radius so
+callers must still check the distance.
+================
+*/
+int G_BuildablesInRadius( vec3_t origin, float radius, gentity_t **list, int maxcount )
+{
+  int       x, y, minx, miny, maxx, maxy;
+  int       count = 0;
   gentity_t *ent;
 
-  for ( i = 1, ent = g_entities + i; i < level.num_entities; i++, ent++ )
+  minx = G_BuildableCell( origin[ 0 ] - radius );
+  maxx = G_BuildableCell( origin[ 0 ] + radius );
+  miny = G_BuildableCell( origin[ 1 ] - radius );
+  maxy = G_BuildableCell( origin[ 1 ] + radius );
+
+  for( x = minx; x <= maxx; x++ )
   {
-    if( ent->s.eType != ET_BUILDABLE )
-      continue;
+    for( y = miny; y <= maxy; y++ )
+    {
+      for( ent = buildableGrid[ G_BuildableBucket( x, y ) ]; ent;
+           ent = ent->buildableCellNext )
+      {
+        // other cells can share this bucket
+        if( ent->buildableCell[ 0 ] != x || ent->buildableCell[ 1 ] != y )
+          continue;
+
+        if( count < maxcount )
+          list[ count++ ] = ent;
+      }
+    }
+  }
+
+  qsort( list, count, sizeof( list[ 0 ] ), G_SortBuildablesByNumber );
+
+  return count;
+}
+
+static qboolean G_BoundsIntersect(const vec3_t mins, const vec3_t maxs,
+                                  const vec3_t mins2, const vec3_t maxs2)
+{
+  if ( maxs[0] < mins2[0] ||
+       maxs[1] < mins2[1] ||
+       maxs[2] < mins2[2] ||
+       mins[0] > maxs2[0] ||
+       mins[1] > maxs2[1] ||
+       mins[2] > maxs2[2])
+  {
+    return qfalse;
+  }
+
+  return qtrue;
+}
 
-    if( ent->parentNode == self )
-      n++;
+/*
+================
+G_BuildablesInBox
+
+Fill list with the linked buildables whose bounds touch a box, sorted by
+entity number. Unlike G_BuildablesInRadius the list is exact, so it can
+stand in for trap_EntitiesInBox when only buildables are wanted.
+
+Only buildables numbered above after are listed, and if there are more
+than maxcount the lowest numbered are kept, so a small list can be walked
+in chunks by passing the last number of one chunk as after for the next.
+================
+*/
+int G_BuildablesInBox( const vec3_t mins, const vec3_t maxs, int after,
+                       gentity_t **list, int maxcount )
+{
+  int       x, y, minx, miny, maxx, maxy;
+  int       i, count = 0;
+  gentity_t *ent;
+
+  if( maxcount <= 0 )
+    return 0;
+
+  // the grid is keyed on s.origin, so widen the search by the largest
+  // buildable's horizontal extent
+  minx = G_BuildableCell( mins[ 0 ] - BUILDABLE_MAX_EXTENT );
+  maxx = G_BuildableCell( maxs[ 0 ] + BUILDABLE_MAX_EXTENT );
+  miny = G_BuildableCell( mins[ 1 ] - BUILDABLE_MAX_EXTENT );
+  maxy = G_BuildableCell( maxs[ 1 ] + BUILDABLE_MAX_EXTENT );
+
+  for( x = minx; x <= maxx; x++ )
+  {
+    for( y = miny; y <= maxy; y++ )
+    {
+      for( ent = buildableGrid[ G_BuildableBucket( x, y ) ]; ent;
+           ent = ent->buildableCellNext )
+      {
+        if( ent->buildableCell[ 0 ] != x || ent->buildableCell[ 1 ] != y )
+          continue;
+
+        if( ent->s.number <= after )
+          continue;
+
+        if( count == maxcount && ent->s.number > list[ count - 1 ]->s.number )
+          continue;
+
+        if( !ent->r.linked || !G_BoundsIntersect( ent->r.absmin, ent->r.absmax, mins, maxs ) )
+          continue;
+
+        // insert in number order, dropping the highest if the list is full
+        i = ( count < maxcount ) ? count++ : count - 1;
+        for( ; i > 0 && list[ i - 1 ]->s.number > ent->s.number; i-- )
+          list[ i ] = list[ i - 1 ];
+
+        list[ i ] = ent;
+      }
+    }
   }
 
-  return n;
+  return count;
 }
 
 #define POWER_REFRESH_TIME  2000
 
 /*
 ================
-G_FindPower
+G_IsPowerConsumer
 
-attempt to find power for self, return qtrue if successful
+Human buildables that only work while connected to a reactor or repeater
 ================
 */
-static qboolean G_FindPower( gentity_t *self )
+static qboolean G_IsPowerConsumer( gentity_t *ent )
 {
-  int       i;
+  return ent->biteam == BIT_HUMANS &&
+         ent->s.modelindex != BA_H_REACTOR &&
+         ent->s.modelindex != BA_H_REPEATER &&
+         ent->s.modelindex != BA_H_SPAWN;
+}
+
+/*
+================
+G_SetPowerParent
+
+Move self into the dependant list of parent
+================
+*/
+static void G_SetPowerParent( gentity_t *self, gentity_t *parent )
+{
+  gentity_t *old = self->parentNode;
+
+  if( old == parent )
+    return;
+
+  if( old )
+  {
+    if( self->powerPrev )
+      self->powerPrev->powerNext = self->powerNext;
+    else
+      old->powerDependants = self->powerNext;
+
+    if( self->powerNext )
+      self->powerNext->powerPrev = self->powerPrev;
+
+    old->numDependants--;
+  }
+
+  self->parentNode = parent;
+  self->powerPrev = NULL;
+  self->powerNext = NULL;
+
+  if( parent )
+  {
+    self->powerNext = parent->powerDependants;
+    if( parent->powerDependants )
+      parent->powerDependants->powerPrev = self;
+    parent->powerDependants = self;
+
+    parent->numDependants++;
+  }
+}
+
+/*
+================
+G_ClosestPowerSource
+
+Find the nearest reactor or repeater whose base covers origin
+================
+*/
+static gentity_t *G_ClosestPowerSource( vec3_t origin, gentity_t *skip )
+{
+  int       i, num;
+  gentity_t *list[ MAX_GENTITIES ];
   gentity_t *ent;
   gentity_t *closestPower = NULL;
   int       distance = 0;
   int       minDistance = 10000;
   vec3_t    temp_v;
 
-  if( self->biteam != BIT_HUMANS )
-    return qfalse;
+  //iterate through nearby buildables, distances are truncated so allow for
+  //anything that rounds down to REACTOR_BASESIZE
+  num = G_BuildablesInRadius( origin, REACTOR_BASESIZE + 1, list, MAX_GENTITIES );
+  for( i = 0; i < num; i++ )
+  {
+    ent = list[ i ];
+
+    if( ent == skip || !ent->powerSource )
+      continue;
+
+    VectorSubtract( origin, ent->s.origin, temp_v );
+    distance = VectorLength( temp_v );
+
+    if( distance < minDistance &&
+        ( ( ent->s.modelindex == BA_H_REACTOR &&
+          distance <= REACTOR_BASESIZE ) ||
+        ( ent->s.modelindex == BA_H_REPEATER &&
+          distance <= REPEATER_BASESIZE ) ) )
+    {
+      closestPower = ent;
+      minDistance = distance;
+    }
+  }
+
+  return closestPower;
+}
+
+static void G_UpdatePowerSource( gentity_t *node );
+
+/*
+================
+G_SetBuildablePowered
+
+All changes to the powered state of a human buildable go through here so the
+powered build point counts and the power network stay in step
+================
+*/
+static void G_SetBuildablePowered( gentity_t *ent, qboolean powered )
+{
+  powered = powered ? qtrue : qfalse;
+
+  if( ent->powered == powered )
+    return;
+
+  if( ent->buildableLinked && ent->biteam == BIT_HUMANS )
+    poweredCounts[ ent->s.modelindex ] += powered ? 1 : -1;
+
+  ent->powered = powered;
+
+  G_UpdatePowerSource( ent );
+}
+
+/*
+================
+G_RefreshPower
+
+Attach ent to the closest power source unless its current one still has
+power. Consumers are powered if and only if they have a parent.
+================
+*/
+static void G_RefreshPower( gentity_t *ent )
+{
+  if( ent->biteam != BIT_HUMANS || !ent->buildableLinked )
+    return;
 
   //reactor is always powered
-  if( self->s.modelindex == BA_H_REACTOR )
-    return qtrue;
+  if( ent->s.modelindex == BA_H_REACTOR )
+    return;
 
-  //if this already has power then stop now
-  if( self->parentNode && self->parentNode->powered )
-    return qtrue;
+  if( !ent->parentNode || !ent->parentNode->powerSource )
+    G_SetPowerParent( ent, G_ClosestPowerSource( ent->s.origin, ent ) );
 
-  //reset parent
-  self->parentNode = NULL;
+  if( G_IsPowerConsumer( ent ) )
+    G_SetBuildablePowered( ent, ent->parentNode && ent->health > 0 );
+}
 
-  //iterate through entities
-  for ( i = 1, ent = g_entities + i; i < level.num_entities; i++, ent++ )
-  {
-    if( ent->s.eType != ET_BUILDABLE )
-      continue;
+/*
+================
+G_PowerSourceGained
 
-    //if entity is a power item calculate the distance to it
-    if( ( ent->s.modelindex == BA_H_REACTOR || ent->s.modelindex == BA_H_REPEATER ) &&
-        ent->spawned )
-    {
-      VectorSubtract( self->s.origin, ent->s.origin, temp_v );
-      distance = VectorLength( temp_v );
+Connect any unpowered consumers in range of a new power source
+================
+*/
+static void G_PowerSourceGained( gentity_t *node )
+{
+  int       i, num;
+  gentity_t *list[ MAX_GENTITIES ];
+  gentity_t *ent;
+  float     range;
 
-      if( distance < minDistance && ent->powered &&
-          ( ( ent->s.modelindex == BA_H_REACTOR &&
-            distance <= REACTOR_BASESIZE ) ||
-          ( ent->s.modelindex == BA_H_REPEATER &&
-            distance <= REPEATER_BASESIZE ) ) ) {
+  range = ( node->s.modelindex == BA_H_REACTOR ) ?
+    REACTOR_BASESIZE : REPEATER_BASESIZE;
 
-          closestPower = ent;
-          minDistance = distance;
-      }
-    }
+  num = G_BuildablesInRadius( node->s.origin, range + 1, list, MAX_GENTITIES );
+  for( i = 0; i < num; i++ )
+  {
+    ent = list[ i ];
+
+    if( G_IsPowerConsumer( ent ) && !ent->powered && ent->health > 0 )
+      G_RefreshPower( ent );
   }
+}
 
-  //if there were no power items nearby give up
-  if( closestPower ) {
-    self->parentNode = closestPower;
-    return qtrue;
+/*
+================
+G_PowerSourceLost
+
+Detach everything depending on node and let it look for power elsewhere
+================
+*/
+static void G_PowerSourceLost( gentity_t *node )
+{
+  gentity_t *ent;
+
+  while( ( ent = node->powerDependants ) )
+  {
+    G_SetPowerParent( ent, NULL );
+
+    if( ent->health > 0 )
+      G_RefreshPower( ent );
+    else if( G_IsPowerConsumer( ent ) )
+      G_SetBuildablePowered( ent, qfalse );
   }
+}
+
+/*
+================
+G_UpdatePowerSource
+
+Re-evaluate whether node is giving power and propagate any change
+================
+*/
+static void G_UpdatePowerSource( gentity_t *node )
+{
+  qboolean source;
+
+  source = node->buildableLinked && node->biteam == BIT_HUMANS &&
+           ( node->s.modelindex == BA_H_REACTOR ||
+             node->s.modelindex == BA_H_REPEATER ) &&
+           node->spawned && node->powered;
+
+  if( source == node->powerSource )
+    return;
+
+  node->powerSource = source;
+
+  if( source )
+    G_PowerSourceGained( node );
   else
-    return qfalse;
+    G_PowerSourceLost( node );
 }
 
 /*
 ================
-G_IsPowered
+G_UpdateRepeaterPower
 
-Simple wrapper to G_FindPower to check if a location has power
+Repeaters are powered while any reactor is built
 ================
 */
-qboolean G_IsPowered( vec3_t origin )
+static void G_UpdateRepeaterPower( void )
 {
-  gentity_t dummy;
+  qboolean  reactor = qfalse;
+  gentity_t *ent, *next;
 
-  dummy.parentNode = NULL;
-  dummy.biteam = BIT_HUMANS;
-  dummy.s.modelindex = BA_NONE;
-  VectorCopy( origin, dummy.s.origin );
+  for( ent = G_FirstBuildableOfType( BA_H_REACTOR ); ent; ent = ent->buildableTypeNext )
+  {
+    if( ent->spawned )
+      reactor = qtrue;
+  }
 
-  return G_FindPower( &dummy );
+  for( ent = G_FirstBuildableOfType( BA_H_REPEATER ); ent; ent = next )
+  {
+    next = ent->buildableTypeNext;
+    G_SetBuildablePowered( ent, reactor && ent->spawned && ent->health > 0 );
+  }
+}
+
+/*
+================
+G_BuildableSpawned
+
+Called when a buildable finishes construction
+================
+*/
+static void G_BuildableSpawned( gentity_t *ent )
+{
+  if( ent->s.modelindex == BA_H_REACTOR || ent->s.modelindex == BA_H_REPEATER )
+  {
+    G_UpdateRepeaterPower( );
+    G_UpdatePowerSource( ent );
+  }
+}
+
+/*
+================
+G_BuildableMoved
+
+Called when a linked buildable changes position
+================
+*/
+static void G_BuildableMoved( gentity_t *ent )
+{
+  if( ent->powerSource )
+    G_PowerSourceGained( ent );
+  else if( G_IsPowerConsumer( ent ) && !ent->powered && ent->health > 0 )
+    G_RefreshPower( ent );
+}
+
+/*
+================
+G_RemoveFromPowerNetwork
+
+Called when a buildable is freed
+================
+*/
+static void G_RemoveFromPowerNetwork( gentity_t *ent )
+{
+  if( ent->biteam != BIT_HUMANS )
+    return;
+
+  G_SetPowerParent( ent, NULL );
+
+  ent->powerSource = qfalse;
+  G_PowerSourceLost( ent );
+
+  if( ent->s.modelindex == BA_H_REACTOR )
+    G_UpdateRepeaterPower( );
+}
+
+/*
+================
+G_IsPowered
+
+Check if a location has power
+================
+*/
+qboolean G_IsPowered( vec3_t origin )
+{
+  return G_ClosestPowerSource( origin, NULL ) != NULL;
 }
 
 /*
@@ -253,7 +821,6 @@ attempt to find a controlling DCC for self, return qtrue if successful
 */
 static qboolean G_FindDCC( gentity_t *self )
 {
-  int       i;
   gentity_t *ent;
   gentity_t *closestDCC = NULL;
   int       distance = 0;
@@ -271,14 +838,11 @@ static qboolean G_FindDCC( gentity_t *self )
   //reset parent
   self->dccNode = NULL;
 
-  //iterate through entities
-  for( i = 1, ent = g_entities + i; i < level.num_entities; i++, ent++ )
+  //iterate through dccs
+  for( ent = G_FirstBuildableOfType( BA_H_DCC ); ent; ent = ent->buildableTypeNext )
   {
-    if( ent->s.eType != ET_BUILDABLE )
-      continue;
-
     //if entity is a dcc calculate the distance to it
-    if( ent->s.modelindex == BA_H_DCC && ent->spawned )
+    if( ent->spawned )
     {
       VectorSubtract( self->s.origin, ent->s.origin, temp_v );
       distance = VectorLength( temp_v );
@@ -328,7 +892,6 @@ Attempt to find an overmind for self
 */
 static qboolean G_FindOvermind( gentity_t *self )
 {
-  int       i;
   gentity_t *ent;
 
   if( self->biteam != BIT_ALIENS )
@@ -341,14 +904,10 @@ static qboolean G_FindOvermind( gentity_t *self )
   //reset parent
   self->overmindNode = NULL;
 
-  //iterate through entities
-  for( i = 1, ent = g_entities + i; i < level.num_entities; i++, ent++ )
+  //iterate through overminds
+  for( ent = G_FirstBuildableOfType( BA_A_OVERMIND ); ent; ent = ent->buildableTypeNext )
   {
-    if( ent->s.eType != ET_BUILDABLE )
-      continue;
-
-    //if entity is an overmind calculate the distance to it
-    if( ent->s.modelindex == BA_A_OVERMIND && ent->spawned && ent->health > 0 )
+    if( ent->spawned && ent->health > 0 )
     {
       self->overmindNode = ent;
       return qtrue;
@@ -386,7 +945,8 @@ attempt to find creep for self, return qtrue if successful
 */
 static qboolean G_FindCreep( gentity_t *self )
 {
-  int       i;
+  int       i, num;
+  gentity_t *list[ MAX_GENTITIES ];
   gentity_t *ent;
   gentity_t *closestSpawn = NULL;
   int       distance = 0;
@@ -400,10 +960,10 @@ static qboolean G_FindCreep( gentity_t *self )
   //if self does not have a parentNode or it's parentNode is invalid find a new one
   if( ( self->parentNode == NULL ) || !self->parentNode->inuse )
   {
-    for ( i = 1, ent = g_entities + i; i < level.num_entities; i++, ent++ )
+    num = G_BuildablesInRadius( self->s.origin, CREEP_BASESIZE + 1, list, MAX_GENTITIES );
+    for( i = 0; i < num; i++ )
     {
-      if( ent->s.eType != ET_BUILDABLE )
-        continue;
+      ent = list[ i ];
 
       if( ( ent->s.modelindex == BA_A_SPAWN || ent->s.modelindex == BA_A_OVERMIND ) &&
           ent->spawned )
@@ -460,7 +1020,7 @@ Set any nearby humans' SS_CREEPSLOWED flag
 */
 static void G_CreepSlow( gentity_t *self )
 {
-  int         entityList[ MAX_GENTITIES ];
+  gentity_t   *entityList[ MAX_CLIENTS ];
   vec3_t      range;
   vec3_t      mins, maxs;
   int         i, num;
@@ -474,10 +1034,10 @@ static void G_CreepSlow( gentity_t *self )
   VectorSubtract( self->s.origin, range, mins );
 
   //find humans
-  num = trap_EntitiesInBox( mins, maxs, entityList, MAX_GENTITIES );
+  num = G_ClientsInBox( mins, maxs, PTE_HUMANS, entityList, MAX_CLIENTS );
   for( i = 0; i < num; i++ )
   {
-    enemy = &g_entities[ entityList[ i ] ];
+    enemy = entityList[ i ];
 
     if( enemy->flags & FL_NOTARGET )
       continue;
@@ -791,7 +1351,7 @@ Think function for Alien Overmind
 */
 void AOvermind_Think( gentity_t *self )
 {
-  int       entityList[ MAX_GENTITIES ];
+  gentity_t *entityList[ MAX_CLIENTS ];
   vec3_t    range = { OVERMIND_ATTACK_RANGE, OVERMIND_ATTACK_RANGE, OVERMIND_ATTACK_RANGE };
   vec3_t    mins, maxs;
   int       i, num;
@@ -803,10 +1363,10 @@ void AOvermind_Think( gentity_t *self )
   if( self->spawned && ( self->health > 0 ) )
   {
     //do some damage
-    num = trap_EntitiesInBox( mins, maxs, entityList, MAX_GENTITIES );
+    num = G_ClientsInBox( mins, maxs, PTE_HUMANS, entityList, MAX_CLIENTS );
     for( i = 0; i < num; i++ )
     {
-      enemy = &g_entities[ entityList[ i ] ];
+      enemy = entityList[ i ];
 
       if( enemy->flags & FL_NOTARGET ) 
         continue;
@@ -1061,7 +1621,7 @@ Think function for Alien Acid Tube
 */
 void AAcidTube_Think( gentity_t *self )
 {
-  int       entityList[ MAX_GENTITIES ];
+  gentity_t *entityList[ MAX_CLIENTS ];
   vec3_t    range = { ACIDTUBE_RANGE, ACIDTUBE_RANGE, ACIDTUBE_RANGE };
   vec3_t    mins, maxs;
   int       i, num;
@@ -1082,10 +1642,10 @@ void AAcidTube_Think( gentity_t *self )
   if( self->spawned && G_FindOvermind( self ) )
   {
     //do some damage
-    num = trap_EntitiesInBox( mins, maxs, entityList, MAX_GENTITIES );
+    num = G_ClientsInBox( mins, maxs, PTE_HUMANS, entityList, MAX_CLIENTS );
     for( i = 0; i < num; i++ )
     {
-      enemy = &g_entities[ entityList[ i ] ];
+      enemy = entityList[ i ];
 
       if( enemy->flags & FL_NOTARGET )
         continue;
@@ -1126,7 +1686,7 @@ Think function for Alien Hive
 */
 void AHive_Think( gentity_t *self )
 {
-  int       entityList[ MAX_GENTITIES ];
+  gentity_t *entityList[ MAX_CLIENTS ];
   vec3_t    range = { ACIDTUBE_RANGE, ACIDTUBE_RANGE, ACIDTUBE_RANGE };
   vec3_t    mins, maxs;
   int       i, num;
@@ -1153,10 +1713,10 @@ void AHive_Think( gentity_t *self )
   if( self->spawned && !self->active && G_FindOvermind( self ) )
   {
     //do some damage
-    num = trap_EntitiesInBox( mins, maxs, entityList, MAX_GENTITIES );
+    num = G_ClientsInBox( mins, maxs, PTE_HUMANS, entityList, MAX_CLIENTS );
     for( i = 0; i < num; i++ )
     {
-      enemy = &g_entities[ entityList[ i ] ];
+      enemy = entityList[ i ];
 
       if( enemy->flags & FL_NOTARGET )
         continue;
@@ -1696,24 +2256,7 @@ Think for human power repeater
 */
 void HRepeater_Think( gentity_t *self )
 {
-  int       i;
-  qboolean  reactor = qfalse;
-  gentity_t *ent;
-
-  if( self->spawned )
-  {
-    //iterate through entities
-    for ( i = 1, ent = g_entities + i; i < level.num_entities; i++, ent++ )
-    {
-      if( ent->s.eType != ET_BUILDABLE )
-        continue;
-
-      if( ent->s.modelindex == BA_H_REACTOR && ent->spawned )
-        reactor = qtrue;
-    }
-  }
-
-  if( G_NumberOfDependants( self ) == 0 )
+  if( self->numDependants == 0 )
   {
     //if no dependants for x seconds then disappear
     if( self->count < 0 )
@@ -1724,8 +2267,6 @@ void HRepeater_Think( gentity_t *self )
   else
     self->count = -1;
 
-  self->powered = reactor;
-
   self->nextthink = level.time + POWER_REFRESH_TIME;
 }
 
@@ -1760,7 +2301,7 @@ Think function for Human Reactor
 */
 void HReactor_Think( gentity_t *self )
 {
-  int       entityList[ MAX_GENTITIES ];
+  gentity_t *entityList[ MAX_CLIENTS ];
   vec3_t    range = { REACTOR_ATTACK_RANGE, REACTOR_ATTACK_RANGE, REACTOR_ATTACK_RANGE };
   vec3_t    mins, maxs;
   int       i, num;
@@ -1772,10 +2313,10 @@ void HReactor_Think( gentity_t *self )
   if( self->spawned && ( self->health > 0 ) )
   {
     //do some damage
-    num = trap_EntitiesInBox( mins, maxs, entityList, MAX_GENTITIES );
+    num = G_ClientsInBox( mins, maxs, PTE_ALIENS, entityList, MAX_CLIENTS );
     for( i = 0; i < num; i++ )
     {
-      enemy = &g_entities[ entityList[ i ] ];
+      enemy = entityList[ i ];
 
       if( enemy->flags & FL_NOTARGET )
         continue;
@@ -1845,10 +2386,7 @@ Think for armoury
 */
 void HArmoury_Think( gentity_t *self )
 {
-  //make sure we have power
   self->nextthink = level.time + POWER_REFRESH_TIME;
-
-  self->powered = G_FindPower( self );
 }
 
 
@@ -1869,10 +2407,7 @@ Think for dcc
 */
 void HDCC_Think( gentity_t *self )
 {
-  //make sure we have power
   self->nextthink = level.time + POWER_REFRESH_TIME;
-
-  self->powered = G_FindPower( self );
 }
 
 
@@ -1889,7 +2424,7 @@ think function for Human Medistation
 */
 void HMedistat_Think( gentity_t *self )
 {
-  int       entityList[ MAX_GENTITIES ];
+  gentity_t *entityList[ MAX_CLIENTS ];
   vec3_t    mins, maxs;
   int       i, num;
   gentity_t *player;
@@ -1898,7 +2433,7 @@ void HMedistat_Think( gentity_t *self )
   self->nextthink = level.time + BG_FindNextThinkForBuildable( self->s.modelindex );
 
   //make sure we have power
-  if( !( self->powered = G_FindPower( self ) ) )
+  if( !self->powered )
   {
     if( self->active )
     {
@@ -1925,10 +2460,10 @@ void HMedistat_Think( gentity_t *self )
       G_SetIdleBuildableAnim( self, BANIM_IDLE2 );
 
     //check if a previous occupier is still here
-    num = trap_EntitiesInBox( mins, maxs, entityList, MAX_GENTITIES );
+    num = G_ClientsInBox( mins, maxs, PTE_HUMANS, entityList, MAX_CLIENTS );
     for( i = 0; i < num; i++ )
     {
-      player = &g_entities[ entityList[ i ] ];
+      player = entityList[ i ];
 
       if( player->client && player->client->ps.stats[ STAT_PTEAM ] == PTE_HUMANS )
       {
@@ -1946,7 +2481,7 @@ void HMedistat_Think( gentity_t *self )
       //look for something to heal
       for( i = 0; i < num; i++ )
       {
-        player = &g_entities[ entityList[ i ] ];
+        player = entityList[ i ];
 
     if( player->flags & FL_NOTARGET )
       continue; // notarget cancels even beneficial effects?
@@ -2144,7 +2679,7 @@ Used by HMGTurret_Think to locate enemy gentities
 */
 void HMGTurret_FindEnemy( gentity_t *self )
 {
-  int       entityList[ MAX_GENTITIES ];
+  gentity_t *entityList[ MAX_CLIENTS ];
   vec3_t    range;
   vec3_t    mins, maxs;
   int       i, num;
@@ -2155,10 +2690,10 @@ void HMGTurret_FindEnemy( gentity_t *self )
   VectorSubtract( self->s.origin, range, mins );
 
   //find aliens
-  num = trap_EntitiesInBox( mins, maxs, entityList, MAX_GENTITIES );
+  num = G_ClientsInBox( mins, maxs, PTE_ALIENS, entityList, MAX_CLIENTS );
   for( i = 0; i < num; i++ )
   {
-    target = &g_entities[ entityList[ i ] ];
+    target = entityList[ i ];
 
     if( target->client && target->client->ps.stats[ STAT_PTEAM ] == PTE_ALIENS )
     {
@@ -2177,7 +2712,7 @@ void HMGTurret_FindEnemy( gentity_t *self )
     //check again, this time ignoring painted targets
     for( i = 0; i < num; i++ )
     {
-      target = &g_entities[ entityList[ i ] ];
+      target = entityList[ i ];
 
       if( target->client && target->client->ps.stats[ STAT_PTEAM ] == PTE_ALIENS )
       {
@@ -2214,7 +2749,7 @@ void HMGTurret_Think( gentity_t *self )
   self->s.eFlags &= ~EF_FIRING;
 
   //if not powered don't do anything and check again for power next think
-  if( !( self->powered = G_FindPower( self ) ) )
+  if( !self->powered )
   {
     self->nextthink = level.time + POWER_REFRESH_TIME;
     return;
@@ -2272,7 +2807,7 @@ Think function for Tesla Generator
 */
 void HTeslaGen_Think( gentity_t *self )
 {
-  int       entityList[ MAX_GENTITIES ];
+  gentity_t *entityList[ MAX_CLIENTS ];
   vec3_t    range;
   vec3_t    mins, maxs;
   vec3_t    dir;
@@ -2282,7 +2817,7 @@ void HTeslaGen_Think( gentity_t *self )
   self->nextthink = level.time + BG_FindNextThinkForBuildable( self->s.modelindex );
 
   //if not powered don't do anything and check again for power next think
-  if( !( self->powered = G_FindPower( self ) ) || !( self->dcced = G_FindDCC( self ) ) )
+  if( !self->powered || !( self->dcced = G_FindDCC( self ) ) )
   {
     self->s.eFlags &= ~EF_FIRING;
     self->nextthink = level.time + POWER_REFRESH_TIME;
@@ -2299,10 +2834,10 @@ void HTeslaGen_Think( gentity_t *self )
     VectorSubtract( self->s.origin, range, mins );
 
     //find aliens
-    num = trap_EntitiesInBox( mins, maxs, entityList, MAX_GENTITIES );
+    num = G_ClientsInBox( mins, maxs, PTE_ALIENS, entityList, MAX_CLIENTS );
     for( i = 0; i < num; i++ )
     {
-      enemy = &g_entities[ entityList[ i ] ];
+      enemy = entityList[ i ];
 
       if( enemy->flags & FL_NOTARGET )
         continue;
@@ -2430,7 +2965,7 @@ void HSpawn_Die( gentity_t *self, gentity_t *inflictor, gentity_t *attacker, int
   G_SetIdleBuildableAnim( self, BANIM_DESTROYED );
 
   self->die = nullDieFunction;
-  self->powered = qfalse; //free up power
+  G_SetBuildablePowered( self, qfalse ); //free up power
   //prevent any firing effects and cancel structure protection
   self->s.eFlags &= ~( EF_FIRING | EF_DBUILDER );
 
@@ -2484,7 +3019,7 @@ void HSpawn_Think( gentity_t *self )
   gentity_t *ent;
 
   // spawns work without power
-  self->powered = qtrue;
+  G_SetBuildablePowered( self, qtrue );
 
   if( self->spawned )
   {
@@ -2639,7 +3174,10 @@ void G_BuildableThink( gentity_t *ent, int msec )
   if( !ent->spawned && ent->health > 0 && !level.pausedTime )
   {
     if( ent->buildTime + bTime < level.time )
+    {
       ent->spawned = qtrue;
+      G_BuildableSpawned( ent );
+    }
   }
 
   ent->s.generic1 = (int)( ( (float)ent->health / (float)bHealth ) * B_HEALTH_MASK );
@@ -2701,50 +3239,29 @@ Check whether a point is within some range of a type of buildable
 */
 qboolean G_BuildableRange( vec3_t origin, float r, buildable_t buildable )
 {
-  int       entityList[ MAX_GENTITIES ];
   vec3_t    range;
   vec3_t    mins, maxs;
-  int       i, num;
   gentity_t *ent;
 
   VectorSet( range, r, r, r );
   VectorAdd( origin, range, maxs );
   VectorSubtract( origin, range, mins );
 
-  num = trap_EntitiesInBox( mins, maxs, entityList, MAX_GENTITIES );
-  for( i = 0; i < num; i++ )
+  for( ent = G_FirstBuildableOfType( buildable ); ent; ent = ent->buildableTypeNext )
   {
-    ent = &g_entities[ entityList[ i ] ];
-
-    if( ent->s.eType != ET_BUILDABLE )
+    if( !ent->r.linked || !G_BoundsIntersect( ent->r.absmin, ent->r.absmax, mins, maxs ) )
       continue;
 
     if( ent->biteam == BIT_HUMANS && !ent->powered )
       continue;
 
-    if( ent->s.modelindex == buildable && ent->spawned )
+    if( ent->spawned )
       return qtrue;
   }
 
   return qfalse;
 }
 
-static qboolean G_BoundsIntersect(const vec3_t mins, const vec3_t maxs,
-                                  const vec3_t mins2, const vec3_t maxs2)
-{
-  if ( maxs[0] < mins2[0] ||
-       maxs[1] < mins2[1] ||
-       maxs[2] < mins2[2] ||
-       mins[0] > maxs2[0] ||
-       mins[1] > maxs2[1] ||
-       mins[2] > maxs2[2])
-  {
-    return qfalse;
-  }
-
-  return qtrue;
-}
-
 /*
 ===============
 G_BuildablesIntersect
@@ -3590,8 +4107,12 @@ static gentity_t *G_Build( gentity_t *builder, buildable_t buildable, vec3_t ori
     built->powered = qtrue;
     built->s.generic1 |= B_POWERED_TOGGLEBIT;
   }
-  else if( ( built->powered = G_FindPower( built ) ) )
-    built->s.generic1 |= B_POWERED_TOGGLEBIT;
+  else
+  {
+    G_RefreshPower( built );
+    if( built->powered )
+      built->s.generic1 |= B_POWERED_TOGGLEBIT;
+  }
 
   if( ( built->dcced = G_FindDCC( built ) ) )
     built->s.generic1 |= B_DCCED_TOGGLEBIT;
@@ -3785,6 +4306,7 @@ static void G_FinishSpawningBuildable( gentity_t *ent )
   built->spawned = qtrue; //map entities are already spawned
   built->health = BG_FindHealthForBuildable( buildable );
   built->s.generic1 |= B_SPAWNED_TOGGLEBIT;
+  G_BuildableSpawned( built );
 
   // drop towards normal surface
   VectorScale( built->s.origin2, -4096.0f, dest );
@@ -4113,6 +4635,7 @@ gentity_t *G_InstantBuild( buildable_t buildable, vec3_t origin, vec3_t angles,
   built->spawned = qtrue; //map entities are already spawned
   built->health = BG_FindHealthForBuildable( buildable );
   built->s.generic1 |= B_SPAWNED_TOGGLEBIT;
+  G_BuildableSpawned( built );
 
   // drop towards normal surface
   VectorScale( built->s.origin2, -4096.0f, dest );
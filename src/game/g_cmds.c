@@ -1089,7 +1089,7 @@ void G_Say( gentity_t *ent, gentity_t *target, int mode, const char *chatText )
 
 static void Cmd_SayArea_f( gentity_t *ent )
 {
-  int    entityList[ MAX_GENTITIES ];
+  gentity_t *entityList[ MAX_CLIENTS ];
   int    num, i;
   int    color = COLOR_BLUE;
   const char  *prefix;
@@ -1132,9 +1132,9 @@ static void Cmd_SayArea_f( gentity_t *ent )
   VectorAdd( ent->s.origin, range, maxs );
   VectorSubtract( ent->s.origin, range, mins );
 
-  num = trap_EntitiesInBox( mins, maxs, entityList, MAX_GENTITIES );
+  num = G_ClientsInBox( mins, maxs, PTE_NONE, entityList, MAX_CLIENTS );
   for( i = 0; i < num; i++ )
-    G_SayTo( ent, &g_entities[ entityList[ i ] ], SAY_TEAM, color, name, msg, prefix );
+    G_SayTo( ent, entityList[ i ], SAY_TEAM, color, name, msg, prefix );
   
   //Send to ADMF_SPEC_ALLCHAT candidates
   for( i = 0; i < level.maxclients; i++ )
@@ -2822,6 +2822,109 @@ commands_t cmds[ ] = {
 };
 static int numCmds = sizeof( cmds ) / sizeof( cmds[ 0 ] );
 
+/*
+  command index
+
+  cmds[ ] is hashed by lower cased name when the first command arrives so
+  ClientCommand doesn't compare argv( 0 ) against every entry. cmdUses counts
+  every command clients send, including refused ones, for "cmdstats".
+*/
+
+#define CMD_HASH_SIZE 128   // power of two, well over numCmds
+
+static int      cmdHash[ CMD_HASH_SIZE ];   // cmds index + 1, 0 for none
+static qboolean cmdHashBuilt = qfalse;
+static int      cmdUses[ sizeof( cmds ) / sizeof( cmds[ 0 ] ) ];
+static int      cmdUnknownUses;
+
+static int G_CommandHash( const char *name )
+{
+  unsigned int hash = 0;
+
+  while( *name )
+    hash = hash * 31 + tolower( *name++ );
+
+  return hash & ( CMD_HASH_SIZE - 1 );
+}
+
+static void G_BuildCommandHash( void )
+{
+  int i, h;
+
+  memset( cmdHash, 0, sizeof( cmdHash ) );
+
+  for( i = 0; i < numCmds; i++ )
+  {
+    for( h = G_CommandHash( cmds[ i ].cmdName ); cmdHash[ h ];
+         h = ( h + 1 ) & ( CMD_HASH_SIZE - 1 ) )
+    {
+      // keep the first of any duplicate names, as the old scan did
+      if( !Q_stricmp( cmds[ cmdHash[ h ] - 1 ].cmdName, cmds[ i ].cmdName ) )
+        break;
+    }
+
+    if( !cmdHash[ h ] )
+      cmdHash[ h ] = i + 1;
+  }
+
+  cmdHashBuilt = qtrue;
+}
+
+/*
+=================
+G_FindCommand
+
+Index of a client command in cmds[ ], or -1
+=================
+*/
+static int G_FindCommand( const char *name )
+{
+  int h;
+
+  if( !cmdHashBuilt )
+    G_BuildCommandHash( );
+
+  for( h = G_CommandHash( name ); cmdHash[ h ]; h = ( h + 1 ) & ( CMD_HASH_SIZE - 1 ) )
+  {
+    if( !Q_stricmp( cmds[ cmdHash[ h ] - 1 ].cmdName, name ) )
+      return cmdHash[ h ] - 1;
+  }
+
+  return -1;
+}
+
+static int QDECL G_SortCommandUses( const void *a, const void *b )
+{
+  return cmdUses[ *(const int *)b ] - cmdUses[ *(const int *)a ];
+}
+
+/*
+=================
+Svcmd_CmdStats_f
+
+cmdstats
+=================
+*/
+void Svcmd_CmdStats_f( void )
+{
+  int order[ sizeof( cmds ) / sizeof( cmds[ 0 ] ) ];
+  int i;
+
+  for( i = 0; i < numCmds; i++ )
+    order[ i ] = i;
+
+  qsort( order, numCmds, sizeof( order[ 0 ] ), G_SortCommandUses );
+
+  G_Printf( "%-16s %8s\n", "command", "uses" );
+
+  for( i = 0; i < numCmds && cmdUses[ order[ i ] ]; i++ )
+    G_Printf( "%-16s %8d\n", cmds[ order[ i ] ].cmdName, cmdUses[ order[ i ] ] );
+
+  G_Printf( "%-16s %8d\n", "(other)", cmdUnknownUses );
+
+  G_admin_cmd_stats( );
+}
+
 /*
 =================
 ClientCommand
@@ -2839,20 +2942,20 @@ void ClientCommand( int clientNum )
 
   trap_Argv( 0, cmd, sizeof( cmd ) );
 
-  for( i = 0; i < numCmds; i++ )
-  {
-    if( Q_stricmp( cmd, cmds[ i ].cmdName ) == 0 )
-      break;
-  }
+  i = G_FindCommand( cmd );
 
-  if( i == numCmds )
+  if( i < 0 )
   {
+    cmdUnknownUses++;
+
     if( !G_admin_cmd_check( ent, qfalse ) )
       trap_SendServerCommand( clientNum,
         va( "print \"Unknown command %s\n\"", cmd ) );
     return;
   }
 
+  cmdUses[ i ]++;
+
   // do tests here to reduce the amount of repeated code
 
   if( !( cmds[ i ].cmdFlags & CMD_INTERMISSION ) && ( level.intermissiontime || level.paused ) )
@@ -826,7 +826,7 @@ static float G_CalcDamageModifier( vec3_t point, gentity_t *targ, gentity_t *att
   if( point == NULL )
     return 1.0f;
 
-  if( g_unlagged.integer && targ->client && targ->client->unlaggedCalc.used )
+  if( g_unlagged.integer && targ->client && G_UnlaggedPosition( targ )->used )
     VectorCopy( targ->client->unlaggedCalc.origin, targOrigin );
   else
     VectorCopy( targ->r.currentOrigin, targOrigin );
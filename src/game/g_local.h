@@ -108,6 +108,10 @@ struct gentity_s
   qboolean          neverFree;      // if true, FreeEntity will only unlink
                                     // bodyque uses this
 
+  gentity_t         *entityNext;    // next/prev on the run list or, with
+  gentity_t         *entityPrev;    // freeAfterEvent, the temp entity list
+  gentity_t         *freeNext;      // next slot in the free queue, see G_Spawn
+
   int               flags;          // FL_* variables
 
   char              *model;
@@ -266,6 +270,21 @@ struct gentity_s
   int               lastDamageTime;
   
   int               bdnumb;     // buildlog entry ID
+
+  // buildable registry, see G_LinkBuildable
+  qboolean          buildableLinked;
+  int               buildableCell[ 2 ];           // grid cell containing s.origin
+  gentity_t         *buildableCellNext;           // next/prev in the same grid bucket
+  gentity_t         *buildableCellPrev;
+  gentity_t         *buildableTypeNext;           // next/prev of the same modelindex,
+  gentity_t         *buildableTypePrev;           // sorted by entity number
+
+  // human power network, see G_RefreshPower
+  qboolean          powerSource;                  // reactor/repeater currently giving power
+  gentity_t         *powerDependants;             // buildables with parentNode == this
+  int               numDependants;
+  gentity_t         *powerNext;                   // next/prev sharing the same parentNode
+  gentity_t         *powerPrev;
 };
 
 typedef enum
@@ -439,6 +458,9 @@ typedef struct
   qboolean            denyBuild;
   int                 adminLevel;
   char                adminName[ MAX_NETNAME ];
+  int                 adminPermGen;         // see G_admin_permission
+  int                 adminPermKnown[ 2 ];  // flag ids with a cached result
+  int                 adminPermGranted[ 2 ];
   qboolean            designatedBuilder;
   qboolean            firstConnect;        // This is the first map since connect
   qboolean            useUnlagged;
@@ -453,6 +475,34 @@ typedef struct unlagged_s {
   qboolean    used;
 } unlagged_t;
 
+// position history of every client, one marker per server frame kept in a
+// ring. Each field is an array over clients so a rewind reads two rows.
+typedef struct unlaggedHistory_s {
+  int         newest;                     // marker stored last
+  int         count;                      // markers stored so far
+  int         times[ MAX_UNLAGGED_MARKERS ];
+  vec3_t      origins[ MAX_UNLAGGED_MARKERS ][ MAX_CLIENTS ];
+  vec3_t      mins[ MAX_UNLAGGED_MARKERS ][ MAX_CLIENTS ];
+  vec3_t      maxs[ MAX_UNLAGGED_MARKERS ][ MAX_CLIENTS ];
+  qboolean    used[ MAX_UNLAGGED_MARKERS ][ MAX_CLIENTS ];
+
+  // the rewind set up by G_UnlaggedCalc, see G_UnlaggedPosition
+  int         calcSerial;
+  qboolean    rewinding;
+  int         start;
+  int         stop;
+  float       lerp;
+  gentity_t   *rewindEnt;
+
+  // clients moved by G_UnlaggedOn, restored by G_UnlaggedOff
+  int         moved[ MAX_CLIENTS ];
+  int         numMoved;
+
+  int         shots;                      // G_UnlaggedOn calls while rewinding
+  int         lerps;
+  int         relinks;
+} unlaggedHistory_t;
+
 // this structure is cleared on each ClientSpawn(),
 // except for 'client->pers' and 'client->sess'
 struct gclient_s
@@ -545,9 +595,9 @@ struct gclient_s
 #define RAM_FRAMES  1                       // number of frames to wait before retriggering
   int                 retriggerArmouryMenu; // frame number to retrigger the armoury menu
 
-  unlagged_t          unlaggedHist[ MAX_UNLAGGED_MARKERS ];
   unlagged_t          unlaggedBackup;
   unlagged_t          unlaggedCalc;
+  int                 unlaggedCalcSerial;   // level.unlagged.calcSerial of unlaggedCalc
   int                 unlaggedTime;
   
   int               tkcredits[ MAX_CLIENTS ];
@@ -643,6 +693,14 @@ struct buildHistory_s
 #define MAX_SPAWN_VARS      64
 #define MAX_SPAWN_VARS_CHARS  4096
 
+// one bit per entity slot, with a summary bit per word so the nearest set
+// bit either side of a slot is found in a few steps
+typedef struct
+{
+  unsigned int      words[ MAX_GENTITIES / 32 ];
+  unsigned int      summary;
+} entityBits_t;
+
 typedef struct
 {
   struct gclient_s  *clients;   // [maxclients]
@@ -650,8 +708,18 @@ typedef struct
   struct gentity_s  *gentities;
   int               gentitySize;
   int               num_entities;   // current number, <= MAX_GENTITIES
-
-  fileHandle_t      logFile;
+  entityBits_t      usedEntityBits; // in-use slots from MAX_CLIENTS up
+  entityBits_t      runEntityBits;  // slots on the run list
+  gentity_t         *firstEntity;   // run list, in-use entities from MAX_CLIENTS
+                                    // up that can think, sorted by number
+  gentity_t         *runEntity;     // entity G_RunFrame is running
+  gentity_t         *firstTempEntity; // freeAfterEvent entities, unsorted
+  gentity_t         *freeHead;      // free slots, oldest freetime first
+  gentity_t         *freeTail;
+  int               numFreeEntities;
+  int               numUsedEntities;      // in use from MAX_CLIENTS up
+  int               peakUsedEntities;
+  int               forcedEntityReuses;   // slots reused inside the freetime window
 
   // store latched cvars here that we want to get at often
   int               maxclients;
@@ -771,8 +839,7 @@ typedef struct
   qboolean paused;
   int pausedTime;
 
-  int unlaggedIndex;
-  int unlaggedTimes[ MAX_UNLAGGED_MARKERS ];
+  unlaggedHistory_t unlagged;
 
   char              layout[ MAX_QPATH ];
 
@@ -850,6 +917,7 @@ void      Cmd_TeamVote_f( gentity_t *ent );
 void      Cmd_Builder_f( gentity_t *ent );
 void      G_WordWrap( char *buffer, int maxwidth );
 void      G_CP( gentity_t *ent );
+void      Svcmd_CmdStats_f( void );
 
 //
 // g_physics.c
@@ -893,6 +961,16 @@ qboolean          AHovel_Blocked( gentity_t *hovel, gentity_t *player, qboolean
 gentity_t         *G_CheckSpawnPoint( int spawnNum, vec3_t origin, vec3_t normal,
                     buildable_t spawn, vec3_t spawnOrigin );
 
+void              G_InitBuildableRegistry( void );
+void              G_LinkBuildable( gentity_t *ent );
+void              G_UnlinkBuildable( gentity_t *ent );
+gentity_t         *G_FirstBuildableOfType( buildable_t buildable );
+int               G_BuildablesInRadius( vec3_t origin, float radius,
+                                        gentity_t **list, int maxcount );
+int               G_BuildablesInBox( const vec3_t mins, const vec3_t maxs, int after,
+                                     gentity_t **list, int maxcount );
+int               G_BuildableCount( buildable_t buildable, qboolean poweredOnly );
+
 qboolean          G_IsPowered( vec3_t origin );
 qboolean          G_IsDCCBuilt( void );
 qboolean          G_IsOvermindBuilt( void );
@@ -923,12 +1001,17 @@ char             *G_FindBuildLogName( int id );
 //
 // g_utils.c
 //
+void        G_InitConfigstringCache( void );
+void        G_SetConfigstringCached( int num, const char *string );
+void        Svcmd_ConfigstringStats_f( void );
+void        Svcmd_EntityStats_f( void );
 int         G_ParticleSystemIndex( char *name );
 int         G_ShaderIndex( char *name );
 int         G_ModelIndex( char *name );
 int         G_SoundIndex( char *name );
 void        G_TeamCommand( pTeam_t team, char *cmd );
 void        G_KillBox (gentity_t *ent);
+gentity_t   *G_NextEntity( gentity_t *from );
 gentity_t   *G_Find (gentity_t *from, int fieldofs, const char *match);
 gentity_t   *G_PickTarget (char *targetname);
 void        G_UseTargets (gentity_t *ent, gentity_t *activator);
@@ -937,6 +1020,7 @@ void        G_SetMovedir ( vec3_t angles, vec3_t movedir);
 void        G_InitGentity( gentity_t *e );
 gentity_t   *G_Spawn( void );
 gentity_t   *G_TempEntity( vec3_t origin, int event );
+void        G_FreeAfterEvent( gentity_t *ent );
 void        G_Sound( gentity_t *ent, int channel, int soundIndex );
 void        G_FreeEntity( gentity_t *e );
 qboolean    G_EntitiesFree( void );
@@ -964,6 +1048,8 @@ void        G_CloseMenus( int clientNum );
 
 qboolean    G_Visible( gentity_t *ent1, gentity_t *ent2 );
 gentity_t   *G_ClosestEnt( vec3_t origin, gentity_t **entities, int numEntities );
+int         G_ClientsInBox( const vec3_t mins, const vec3_t maxs, pTeam_t team,
+                            gentity_t **list, int maxcount );
 
 //
 // g_combat.c
@@ -1134,8 +1220,12 @@ void ClientCommand( int clientNum );
 void G_UnlaggedStore( void );
 void G_UnlaggedClear( gentity_t *ent );
 void G_UnlaggedCalc( int time, gentity_t *skipEnt );
+unlagged_t *G_UnlaggedPosition( gentity_t *ent );
+void G_UnlaggedSkip( gentity_t *ent );
 void G_UnlaggedOn( gentity_t *attacker, vec3_t muzzle, float range );
+void G_UnlaggedOnTrace( gentity_t *attacker, vec3_t start, vec3_t end, float radius );
 void G_UnlaggedOff( void );
+void Svcmd_UnlaggedStats_f( void );
 void ClientThink( int clientNum );
 void ClientEndFrame( gentity_t *ent );
 void G_RunClient( gentity_t *ent );
@@ -1158,6 +1248,65 @@ void G_Free( void *ptr );
 void G_DefragmentMemory( void );
 void Svcmd_GameMem_f( void );
 
+//
+// g_prof.c
+//
+typedef enum
+{
+  FP_ENTITIES,        // whole entity loop, broken down by eType below
+
+  FP_MISSILES,
+  FP_BUILDABLES,
+  FP_PHYSICS,
+  FP_MOVERS,
+  FP_CLIENTS,
+  FP_THINKERS,
+
+  FP_CLIENTENDFRAME,
+  FP_UNLAGGEDSTORE,
+  FP_COUNTSPAWNS,
+  FP_BUILDPOINTS,
+  FP_STAGES,
+  FP_SPAWNCLIENTS,
+  FP_AVGPLAYERS,
+  FP_ZAPS,
+  FP_EXITRULES,
+  FP_TEAMSTATUS,
+  FP_VOTES,
+  FP_CVARS,
+  FP_LOG,
+
+  FP_TOTAL,
+
+  FP_NUM_PHASES
+} framePhase_t;
+
+void G_FrameProfReset( void );
+int  G_FrameProfBegin( void );
+int  G_FrameProfAdd( framePhase_t phase, int start );
+void G_FrameProfEnd( void );
+void G_FrameProfDump( void );
+void Svcmd_FrameProf_f( void );
+
+//
+// g_log.c
+//
+typedef enum
+{
+  LOG_GAME,
+  LOG_ADMIN,
+
+  LOG_NUM_TARGETS
+} logTarget_t;
+
+qboolean G_LogOpen( logTarget_t target, const char *filename, qboolean sync );
+qboolean G_LogIsOpen( logTarget_t target );
+void     G_LogWrite( logTarget_t target, const char *string, qboolean decolour );
+void     G_LogFlush( logTarget_t target );
+void     G_LogClose( logTarget_t target );
+void     G_LogFrame( void );
+void     Svcmd_LogStats_f( void );
+
 //
 // g_session.c
 //
@@ -1291,6 +1440,9 @@ extern  vmCvar_t  g_quadfactor;
 extern  vmCvar_t  g_inactivity;
 extern  vmCvar_t  g_debugMove;
 extern  vmCvar_t  g_debugAlloc;
+extern  vmCvar_t  g_allocNoFragment;
+extern  vmCvar_t  g_frameProf;
+extern  vmCvar_t  g_frameProfLog;
 extern  vmCvar_t  g_debugDamage;
 extern  vmCvar_t  g_weaponRespawn;
 extern  vmCvar_t  g_weaponTeamRespawn;
@@ -1376,6 +1528,7 @@ extern  vmCvar_t  g_devmapKillerHP;
 
 extern  vmCvar_t  g_privateMessages;
 extern  vmCvar_t  g_decolourLogfiles;
+extern  vmCvar_t  g_logFlushTime;
 extern  vmCvar_t  g_publicSayadmins;
 extern  vmCvar_t  g_myStats;
 extern  vmCvar_t  g_antiSpawnBlock;
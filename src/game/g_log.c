@@ -0,0 +1,243 @@
+/*
+===========================================================================
+Copyright (C) 1999-2005 Id Software, Inc.
+Copyright (C) 2000-2006 Tim Angus
+
+This file is part of Tremulous.
+
+Tremulous is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the License,
+or (at your option) any later version.
+
+Tremulous is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Tremulous; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+===========================================================================
+*/
+
+// g_log.c -- buffered writes to the game and admin logs
+
+#include "g_local.h"
+
+// Lines are collected in memory and written out in one trap_FS_Write when
+// the buffer fills up, when g_logFlushTime msec have passed since the last
+// write or when the log is closed. Files opened with sync set, and all logs
+// when g_logFlushTime is 0, are written through on every line as before.
+
+#define LOG_BUFFER_SIZE   16384
+
+typedef struct
+{
+  fileHandle_t  f;
+  char          name[ MAX_QPATH ];
+  qboolean      sync;
+
+  char          buffer[ LOG_BUFFER_SIZE ];
+  int           length;
+  int           lastFlush;    // trap_Milliseconds( ) of the last write
+
+  int           lines;        // lines logged since the file was opened
+  int           bytes;
+  int           flushes;      // trap_FS_Write calls
+} gameLog_t;
+
+static gameLog_t  logs[ LOG_NUM_TARGETS ];
+
+static const char *logNames[ LOG_NUM_TARGETS ] =
+{
+  "game",
+  "admin"
+};
+
+/*
+================
+G_LogFlush
+
+Write out anything buffered for a log
+================
+*/
+void G_LogFlush( logTarget_t target )
+{
+  gameLog_t *log = &logs[ target ];
+
+  log->lastFlush = trap_Milliseconds( );
+
+  if( !log->f || !log->length )
+    return;
+
+  trap_FS_Write( log->buffer, log->length, log->f );
+  log->flushes++;
+  log->length = 0;
+}
+
+/*
+================
+G_LogClose
+
+Flush and close a log
+================
+*/
+void G_LogClose( logTarget_t target )
+{
+  gameLog_t *log = &logs[ target ];
+
+  if( !log->f )
+    return;
+
+  G_LogFlush( target );
+  trap_FS_FCloseFile( log->f );
+  memset( log, 0, sizeof( *log ) );
+}
+
+/*
+================
+G_LogOpen
+
+Open filename for appending as target, does nothing if it is already open
+================
+*/
+qboolean G_LogOpen( logTarget_t target, const char *filename, qboolean sync )
+{
+  gameLog_t *log = &logs[ target ];
+
+  if( log->f && !Q_stricmp( log->name, filename ) && log->sync == sync )
+    return qtrue;
+
+  G_LogClose( target );
+
+  if( !filename[ 0 ] )
+    return qfalse;
+
+  trap_FS_FOpenFile( filename, &log->f, sync ? FS_APPEND_SYNC : FS_APPEND );
+
+  if( !log->f )
+    return qfalse;
+
+  Q_strncpyz( log->name, filename, sizeof( log->name ) );
+  log->sync = sync;
+  log->lastFlush = trap_Milliseconds( );
+
+  return qtrue;
+}
+
+/*
+================
+G_LogIsOpen
+================
+*/
+qboolean G_LogIsOpen( logTarget_t target )
+{
+  return logs[ target ].f != 0;
+}
+
+/*
+================
+G_LogWrite
+
+Append a string to a log, optionally stripping colour codes on the way
+================
+*/
+void G_LogWrite( logTarget_t target, const char *string, qboolean decolour )
+{
+  gameLog_t   *log = &logs[ target ];
+  const char  *in;
+  char        *out;
+  int         len;
+
+  if( !log->f )
+    return;
+
+  len = strlen( string );
+
+  // make sure the worst case fits in one go
+  if( log->length + len >= LOG_BUFFER_SIZE )
+    G_LogFlush( target );
+
+  if( len >= LOG_BUFFER_SIZE )
+  {
+    trap_FS_Write( string, len, log->f );
+    log->flushes++;
+    log->lines++;
+    log->bytes += len;
+    return;
+  }
+
+  out = log->buffer + log->length;
+
+  if( decolour )
+  {
+    // same as G_DecolorString
+    for( in = string; *in; )
+    {
+      if( *in == 27 || *in == '^' )
+      {
+        in++;
+        if( *in )
+          in++;
+        continue;
+      }
+      *out++ = *in++;
+    }
+  }
+  else
+  {
+    memcpy( out, string, len );
+    out += len;
+  }
+
+  len = out - ( log->buffer + log->length );
+  log->length += len;
+  log->lines++;
+  log->bytes += len;
+
+  if( log->sync || g_logFlushTime.integer <= 0 )
+    G_LogFlush( target );
+}
+
+/*
+================
+G_LogFrame
+
+Flush logs that have had something buffered for longer than g_logFlushTime
+================
+*/
+void G_LogFrame( void )
+{
+  int i, now = trap_Milliseconds( );
+
+  for( i = 0; i < LOG_NUM_TARGETS; i++ )
+  {
+    if( logs[ i ].length && now - logs[ i ].lastFlush >= g_logFlushTime.integer )
+      G_LogFlush( i );
+  }
+}
+
+/*
+================
+Svcmd_LogStats_f
+
+logstats
+================
+*/
+void Svcmd_LogStats_f( void )
+{
+  int i;
+
+  G_Printf( "%-6s %-24s %8s %10s %8s %8s\n",
+            "log", "file", "lines", "bytes", "writes", "pending" );
+
+  for( i = 0; i < LOG_NUM_TARGETS; i++ )
+  {
+    gameLog_t *log = &logs[ i ];
+
+    G_Printf( "%-6s %-24s %8d %10d %8d %8d\n",
+              logNames[ i ], log->f ? log->name : "-",
+              log->lines, log->bytes, log->flushes, log->length );
+  }
+}
@@ -65,6 +65,9 @@ vmCvar_t  g_inactivity;
 vmCvar_t  g_debugMove;
 vmCvar_t  g_debugDamage;
 vmCvar_t  g_debugAlloc;
+vmCvar_t  g_allocNoFragment;
+vmCvar_t  g_frameProf;
+vmCvar_t  g_frameProfLog;
 vmCvar_t  g_weaponRespawn;
 vmCvar_t  g_weaponTeamRespawn;
 vmCvar_t  g_motd;
@@ -76,6 +79,7 @@ vmCvar_t  g_restarted;
 vmCvar_t  g_lockTeamsAtStart;
 vmCvar_t  g_logFile;
 vmCvar_t  g_logFileSync;
+vmCvar_t  g_logFlushTime;
 vmCvar_t  g_blood;
 vmCvar_t  g_podiumDist;
 vmCvar_t  g_podiumDrop;
@@ -226,6 +230,7 @@ static cvarTable_t   gameCvarTable[ ] =
 
   { &g_logFile, "g_logFile", "games.log", CVAR_ARCHIVE, 0, qfalse  },
   { &g_logFileSync, "g_logFileSync", "0", CVAR_ARCHIVE, 0, qfalse  },
+  { &g_logFlushTime, "g_logFlushTime", "1000", CVAR_ARCHIVE, 0, qfalse  },
 
   { &g_password, "g_password", "", CVAR_USERINFO, 0, qfalse  },
 
@@ -246,6 +251,9 @@ static cvarTable_t   gameCvarTable[ ] =
   { &g_debugMove, "g_debugMove", "0", 0, 0, qfalse },
   { &g_debugDamage, "g_debugDamage", "0", 0, 0, qfalse },
   { &g_debugAlloc, "g_debugAlloc", "0", 0, 0, qfalse },
+  { &g_allocNoFragment, "g_allocNoFragment", "0", CVAR_ARCHIVE, 0, qfalse },
+  { &g_frameProf, "g_frameProf", "0", 0, 0, qfalse },
+  { &g_frameProfLog, "g_frameProfLog", "frameprof", CVAR_ARCHIVE, 0, qfalse },
   { &g_motd, "g_motd", "", 0, 0, qfalse },
   { &g_blood, "com_blood", "1", 0, 0, qfalse },
 
@@ -437,6 +445,9 @@ void QDECL G_Error( const char *fmt, ... )
   vsprintf( text, fmt, argptr );
   va_end( argptr );
 
+  G_LogFlush( LOG_GAME );
+  G_LogFlush( LOG_ADMIN );
+
   trap_Error( text );
 }
 
@@ -623,6 +634,9 @@ void G_InitGame( int levelTime, int randomSeed, int restart )
 
   G_InitMemory( );
 
+  G_FrameProfReset( );
+  G_InitConfigstringCache( );
+
   // set some level globals
   memset( &level, 0, sizeof( level ) );
   level.time = levelTime;
@@ -637,12 +651,7 @@ void G_InitGame( int levelTime, int randomSeed, int restart )
 
   if( g_logFile.string[ 0 ] )
   {
-    if( g_logFileSync.integer )
-      trap_FS_FOpenFile( g_logFile.string, &level.logFile, FS_APPEND_SYNC );
-    else
-      trap_FS_FOpenFile( g_logFile.string, &level.logFile, FS_APPEND );
-
-    if( !level.logFile )
+    if( !G_LogOpen( LOG_GAME, g_logFile.string, g_logFileSync.integer ) )
       G_Printf( "WARNING: Couldn't open logfile: %s\n", g_logFile.string );
     else
     {
@@ -683,6 +692,7 @@ void G_InitGame( int levelTime, int randomSeed, int restart )
   // initialize all entities for this game
   memset( g_entities, 0, MAX_GENTITIES * sizeof( g_entities[ 0 ] ) );
   level.gentities = g_entities;
+  G_InitBuildableRegistry( );
 
   // initialize all clients for this game
   level.maxclients = g_maxclients.integer;
@@ -792,12 +802,13 @@ void G_ShutdownGame( int restart )
 
   G_Printf( "==== ShutdownGame ====\n" );
 
-  if( level.logFile )
+  if( G_LogIsOpen( LOG_GAME ) )
   {
     G_LogPrintf( "ShutdownGame:\n" );
     G_LogPrintf( "------------------------------------------------------------\n" );
-    trap_FS_FCloseFile( level.logFile );
   }
+  G_LogClose( LOG_GAME );
+  G_LogClose( LOG_ADMIN );
 
   // write all the client session data so we can get it back
   G_WriteSessionData( );
@@ -1144,26 +1155,25 @@ Counts the number of spawns for each team
 */
 void G_CountSpawns( void )
 {
-  int i;
   gentity_t *ent;
 
   level.numAlienSpawns = 0;
   level.numHumanSpawns = 0;
 
-  for( i = 1, ent = g_entities + i ; i < level.num_entities ; i++, ent++ )
+  for( ent = G_FirstBuildableOfType( BA_A_SPAWN ); ent; ent = ent->buildableTypeNext )
   {
-    if( !ent->inuse )
-      continue;
-
-    if( ent->s.modelindex == BA_A_SPAWN && ent->health > 0 )
+    if( ent->health > 0 )
       level.numAlienSpawns++;
+  }
 
-    if( ent->s.modelindex == BA_H_SPAWN && ent->health > 0 )
+  for( ent = G_FirstBuildableOfType( BA_H_SPAWN ); ent; ent = ent->buildableTypeNext )
+  {
+    if( ent->health > 0 )
       level.numHumanSpawns++;
   }
 
   //let the client know how many spawns there are
-  trap_SetConfigstring( CS_SPAWNS, va( "%d %d",
+  G_SetConfigstringCached( CS_SPAWNS, va( "%d %d",
         level.numAlienSpawns, level.numHumanSpawns ) );
 }
 
@@ -1178,7 +1188,7 @@ Recalculate the quantity of building points available to the teams
 */
 void G_CalculateBuildPoints( void )
 {
-  int         i;
+  int         points;
   buildable_t buildable;
   gentity_t   *ent;
   int         localHTP = g_humanBuildPoints.integer,
@@ -1193,38 +1203,32 @@ void G_CalculateBuildPoints( void )
   level.reactorPresent = qfalse;
   level.overmindPresent = qfalse;
 
-  for( i = 1, ent = g_entities + i ; i < level.num_entities ; i++, ent++ )
+  for( ent = G_FirstBuildableOfType( BA_H_REACTOR ); ent; ent = ent->buildableTypeNext )
   {
-    if( !ent->inuse )
-      continue;
+    if( ent->spawned && ent->health > 0 )
+      level.reactorPresent = qtrue;
+  }
+
+  for( ent = G_FirstBuildableOfType( BA_A_OVERMIND ); ent; ent = ent->buildableTypeNext )
+  {
+    if( ent->spawned && ent->health > 0 )
+      level.overmindPresent = qtrue;
+  }
 
-    if( ent->s.eType != ET_BUILDABLE )
+  for( buildable = BA_NONE + 1; buildable < BA_NUM_BUILDABLES; buildable++ )
+  {
+    if( !BG_FindReplaceableTestForBuildable( buildable ) )
       continue;
 
-    buildable = ent->s.modelindex;
+    points = BG_FindBuildPointsForBuildable( buildable );
 
-    if( buildable != BA_NONE )
+    if( BG_FindTeamForBuildable( buildable ) == BIT_HUMANS )
     {
-      if( buildable == BA_H_REACTOR && ent->spawned && ent->health > 0 )
-        level.reactorPresent = qtrue;
-
-      if( buildable == BA_A_OVERMIND && ent->spawned && ent->health > 0 )
-        level.overmindPresent = qtrue;
-
-      if( BG_FindReplaceableTestForBuildable( buildable ) )
-      {
-        if( BG_FindTeamForBuildable( buildable ) == BIT_HUMANS )
-        {
-          level.humanBuildPoints -= BG_FindBuildPointsForBuildable( buildable );
-          if( ent->powered )
-            level.humanBuildPointsPowered -= BG_FindBuildPointsForBuildable( buildable );
-        }
-        else
-        {
-          level.alienBuildPoints -= BG_FindBuildPointsForBuildable( buildable );
-        }
-      }
+      level.humanBuildPoints -= points * G_BuildableCount( buildable, qfalse );
+      level.humanBuildPointsPowered -= points * G_BuildableCount( buildable, qtrue );
     }
+    else
+      level.alienBuildPoints -= points * G_BuildableCount( buildable, qfalse );
   }
 
   if( level.humanBuildPoints < 0 )
@@ -1240,7 +1244,7 @@ void G_CalculateBuildPoints( void )
     level.alienBuildPoints = 0;
   }
 
-  trap_SetConfigstring( CS_BUILDPOINTS, va( "%d %d %d %d %d",
+  G_SetConfigstringCached( CS_BUILDPOINTS, va( "%d %d %d %d %d",
         level.alienBuildPoints, localATP,
         level.humanBuildPoints, localHTP,
         level.humanBuildPointsPowered ) );
@@ -1271,7 +1275,7 @@ void G_CalculateBuildPoints( void )
     else
       humanNextStageThreshold = -1;
 
-    trap_SetConfigstring( CS_STAGES, va( "%d %d %d %d %d %d",
+    G_SetConfigstringCached( CS_STAGES, va( "%d %d %d %d %d %d",
           g_alienStage.integer, g_humanStage.integer,
           g_alienKills.integer, g_humanKills.integer,
           alienNextStageThreshold, humanNextStageThreshold ) );
@@ -1622,6 +1626,8 @@ void BeginIntermission( void )
 
   // send the current scoring to all clients
   SendScoreboardMessageToAllClients( );
+
+  G_FrameProfDump( );
 }
 
 
@@ -1725,7 +1731,7 @@ Print to the logfile with a time stamp if it is open
 void QDECL G_LogPrintf( const char *fmt, ... )
 {
   va_list argptr;
-  char    string[ 1024 ], decoloured[ 1024 ];
+  char    string[ 1024 ];
   int     min, tens, sec;
 
   sec = ( level.time - level.startTime ) / 1000;
@@ -1744,18 +1750,7 @@ void QDECL G_LogPrintf( const char *fmt, ... )
   if( g_dedicated.integer )
     G_Printf( "%s", string + 7 );
 
-  if( !level.logFile )
-    return;
-
-  if( g_decolourLogfiles.integer )
-  {
-    G_DecolorString( string, decoloured );
-    trap_FS_Write( decoloured, strlen( decoloured ), level.logFile );
-  }
-  else
-  {
-    trap_FS_Write( string, strlen( string ), level.logFile );
-  }
+  G_LogWrite( LOG_GAME, string, g_decolourLogfiles.integer );
 }
 
 /*
@@ -1787,10 +1782,7 @@ void QDECL G_LogPrintfColoured( const char *fmt, ... )
   if( g_dedicated.integer )
     G_Printf( "%s", string + 7 );
 
-  if( !level.logFile )
-    return;
-
-  trap_FS_Write( string, strlen( string ), level.logFile );
+  G_LogWrite( LOG_GAME, string, qfalse );
 }
 
 /*
@@ -1803,7 +1795,7 @@ Print to the logfile only (not console) with a time stamp if it is open
 void QDECL G_LogOnlyPrintf( const char *fmt, ... )
 {
   va_list argptr;
-  char    string[ 1024 ], decoloured[ 1024 ];
+  char    string[ 1024 ];
   int     min, tens, sec;
 
   sec = (level.time - level.startTime) / 1000;
@@ -1819,18 +1811,7 @@ void QDECL G_LogOnlyPrintf( const char *fmt, ... )
   vsprintf( string +7 , fmt,argptr );
   va_end( argptr );
 
-  if( !level.logFile )
-    return;
-
-  if( g_decolourLogfiles.integer )
-  {
-    G_DecolorString( string, decoloured );
-    trap_FS_Write( decoloured, strlen( decoloured ), level.logFile );
-  }
-  else
-  {
-    trap_FS_Write( string, strlen( string ), level.logFile );
-  }
+  G_LogWrite( LOG_GAME, string, g_decolourLogfiles.integer );
 }
 
 /*
@@ -2028,7 +2009,7 @@ void CheckIntermissionExit( void )
     numPlayers++;
   }
 
-  trap_SetConfigstring( CS_CLIENTS_READY, va( "%d", readyMask ) );
+  G_SetConfigstringCached( CS_CLIENTS_READY, va( "%d", readyMask ) );
 
   // never exit in less than five seconds
   if( level.time < level.intermissiontime + 5000 )
@@ -2434,20 +2415,15 @@ void CheckCvars( void )
   // the server setting is changed
   if( g_markDeconstruct.modificationCount != lastMarkDeconModCount )
   {
-    int       i;
-    gentity_t *ent;
+    buildable_t buildable;
+    gentity_t   *ent;
 
     lastMarkDeconModCount = g_markDeconstruct.modificationCount;
 
-    for( i = 1, ent = g_entities + i ; i < level.num_entities ; i++, ent++ )
+    for( buildable = BA_NONE + 1; buildable < BA_NUM_BUILDABLES; buildable++ )
     {
-      if( !ent->inuse )
-        continue;
-
-      if( ent->s.eType != ET_BUILDABLE )
-        continue;
-
-      ent->deconstruct = qfalse;
+      for( ent = G_FirstBuildableOfType( buildable ); ent; ent = ent->buildableTypeNext )
+        ent->deconstruct = qfalse;
     }
   }
 
@@ -2501,6 +2477,102 @@ void G_EvaluateAcceleration( gentity_t *ent, int msec )
   VectorCopy( ent->acceleration, ent->oldAccel );
 }
 
+/*
+================
+G_ExpireTempEntities
+
+Free the entities on the temp entity list whose event has expired. They
+don't think, so this is all G_RunFrame does with them.
+================
+*/
+static void G_ExpireTempEntities( void )
+{
+  gentity_t *ent, *next;
+
+  for( ent = level.firstTempEntity; ent; ent = next )
+  {
+    next = ent->entityNext;
+
+    // tempEntities or dropped items completely go away after their event
+    if( level.time - ent->eventTime > EVENT_VALID_MSEC )
+      G_FreeEntity( ent );
+  }
+}
+
+/*
+================
+G_RunEntity
+
+Expire events and run one entity for this frame, returns the profiler
+timestamp to continue from. Entities waiting to be freed after their event
+are on the temp entity list instead, see G_ExpireTempEntities
+================
+*/
+static int G_RunEntity( gentity_t *ent, int msec, int t )
+{
+  // clear events that are too old
+  if( level.time - ent->eventTime > EVENT_VALID_MSEC )
+  {
+    if( ent->s.event )
+    {
+      ent->s.event = 0; // &= EV_EVENT_BITS;
+      if ( ent->client )
+      {
+        ent->client->ps.externalEvent = 0;
+        //ent->client->ps.events[0] = 0;
+        //ent->client->ps.events[1] = 0;
+      }
+    }
+
+    if( ent->unlinkAfterEvent )
+    {
+      // items that will respawn will hide themselves after their pickup event
+      ent->unlinkAfterEvent = qfalse;
+      trap_UnlinkEntity( ent );
+    }
+  }
+
+  //TA: calculate the acceleration of this entity
+  if( ent->evaluateAcceleration )
+    G_EvaluateAcceleration( ent, msec );
+
+  if( !ent->r.linked && ent->neverFree )
+    return t;
+
+  if( ent->s.eType == ET_MISSILE )
+  {
+    G_RunMissile( ent );
+    return G_FrameProfAdd( FP_MISSILES, t );
+  }
+
+  if( ent->s.eType == ET_BUILDABLE )
+  {
+    G_BuildableThink( ent, msec );
+    return G_FrameProfAdd( FP_BUILDABLES, t );
+  }
+
+  if( ent->s.eType == ET_CORPSE || ent->physicsObject )
+  {
+    G_Physics( ent, msec );
+    return G_FrameProfAdd( FP_PHYSICS, t );
+  }
+
+  if( ent->s.eType == ET_MOVER )
+  {
+    G_RunMover( ent );
+    return G_FrameProfAdd( FP_MOVERS, t );
+  }
+
+  if( ent < &g_entities[ MAX_CLIENTS ] )
+  {
+    G_RunClient( ent );
+    return G_FrameProfAdd( FP_CLIENTS, t );
+  }
+
+  G_RunThink( ent );
+  return G_FrameProfAdd( FP_THINKERS, t );
+}
+
 /*
 ================
 G_RunFrame
@@ -2513,7 +2585,7 @@ void G_RunFrame( int levelTime )
   int       i;
   gentity_t *ent;
   int       msec;
-  int       start, end;
+  int       t, entStart;
 
   // if we are waiting for the level to restart, do nothing
   if( level.restarted )
@@ -2547,91 +2619,32 @@ void G_RunFrame( int levelTime )
   // get any cvar changes
   G_UpdateCvars( );
 
+  t = entStart = G_FrameProfBegin( );
+
   //
-  // go through all allocated objects
+  // go through all allocated objects, clients first and then the in-use
+  // entity lists so free slots cost nothing
   //
-  start = trap_Milliseconds( );
+  G_ExpireTempEntities( );
+
   ent = &g_entities[ 0 ];
 
-  for( i = 0; i < level.num_entities; i++, ent++ )
+  for( i = 0; i < level.maxclients; i++, ent++ )
   {
-    if( !ent->inuse )
-      continue;
-
-    // clear events that are too old
-    if( level.time - ent->eventTime > EVENT_VALID_MSEC )
-    {
-      if( ent->s.event )
-      {
-        ent->s.event = 0; // &= EV_EVENT_BITS;
-        if ( ent->client )
-        {
-          ent->client->ps.externalEvent = 0;
-          //ent->client->ps.events[0] = 0;
-          //ent->client->ps.events[1] = 0;
-        }
-      }
-
-      if( ent->freeAfterEvent )
-      {
-        // tempEntities or dropped items completely go away after their event
-        G_FreeEntity( ent );
-        continue;
-      }
-      else if( ent->unlinkAfterEvent )
-      {
-        // items that will respawn will hide themselves after their pickup event
-        ent->unlinkAfterEvent = qfalse;
-        trap_UnlinkEntity( ent );
-      }
-    }
-
-    // temporary entities don't think
-    if( ent->freeAfterEvent )
-      continue;
-
-    //TA: calculate the acceleration of this entity
-    if( ent->evaluateAcceleration )
-      G_EvaluateAcceleration( ent, msec );
-
-    if( !ent->r.linked && ent->neverFree )
-      continue;
-
-    if( ent->s.eType == ET_MISSILE )
-    {
-      G_RunMissile( ent );
-      continue;
-    }
-
-    if( ent->s.eType == ET_BUILDABLE )
-    {
-      G_BuildableThink( ent, msec );
-      continue;
-    }
-
-    if( ent->s.eType == ET_CORPSE || ent->physicsObject )
-    {
-      G_Physics( ent, msec );
-      continue;
-    }
-
-    if( ent->s.eType == ET_MOVER )
-    {
-      G_RunMover( ent );
-      continue;
-    }
-
-    if( i < MAX_CLIENTS )
-    {
-      G_RunClient( ent );
-      continue;
-    }
+    if( ent->inuse )
+      t = G_RunEntity( ent, msec, t );
+  }
 
-    G_RunThink( ent );
+  for( ent = level.firstEntity; ent;
+       ent = level.runEntity ? level.runEntity->entityNext : level.firstEntity )
+  {
+    // G_FreeEntity steps this back if ent goes away while it runs
+    level.runEntity = ent;
+    t = G_RunEntity( ent, msec, t );
   }
-  end = trap_Milliseconds();
+  level.runEntity = NULL;
 
-  start = trap_Milliseconds();
+  t = G_FrameProfAdd( FP_ENTITIES, entStart );
 
   // perform final fixups on the players
   ent = &g_entities[ 0 ];
@@ -2641,26 +2654,34 @@ void G_RunFrame( int levelTime )
     if( ent->inuse )
       ClientEndFrame( ent );
   }
+  t = G_FrameProfAdd( FP_CLIENTENDFRAME, t );
 
   // save position information for all active clients 
   G_UnlaggedStore( );
-
-  end = trap_Milliseconds();
+  t = G_FrameProfAdd( FP_UNLAGGEDSTORE, t );
 
   //TA:
   G_CountSpawns( );
+  t = G_FrameProfAdd( FP_COUNTSPAWNS, t );
   G_CalculateBuildPoints( );
+  t = G_FrameProfAdd( FP_BUILDPOINTS, t );
   G_CalculateStages( );
+  t = G_FrameProfAdd( FP_STAGES, t );
   G_SpawnClients( PTE_ALIENS );
   G_SpawnClients( PTE_HUMANS );
+  t = G_FrameProfAdd( FP_SPAWNCLIENTS, t );
   G_CalculateAvgPlayers( );
+  t = G_FrameProfAdd( FP_AVGPLAYERS, t );
   G_UpdateZaps( msec );
+  t = G_FrameProfAdd( FP_ZAPS, t );
 
   // see if it is time to end the level
   CheckExitRules( );
+  t = G_FrameProfAdd( FP_EXITRULES, t );
 
   // update to team status?
   CheckTeamStatus( );
+  t = G_FrameProfAdd( FP_TEAMSTATUS, t );
 
   // cancel vote if timed out
   CheckVote( );
@@ -2668,9 +2689,17 @@ void G_RunFrame( int levelTime )
   // check team votes
   CheckTeamVote( PTE_HUMANS );
   CheckTeamVote( PTE_ALIENS );
+  t = G_FrameProfAdd( FP_VOTES, t );
 
   // for tracking changes
   CheckCvars( );
+  t = G_FrameProfAdd( FP_CVARS, t );
+
+  // flush the buffered log
+  G_LogFrame( );
+  G_FrameProfAdd( FP_LOG, t );
+
+  G_FrameProfEnd( );
 
   if( g_listEntity.integer )
   {
@@ -23,194 +23,410 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include "g_local.h"
 
-#define  POOLSIZE ( 1024 * 1024 )
+// The pool is split into pages. Small allocations come from slab pages that
+// are carved into blocks of a single size class, each class keeping its own
+// free list, so allocating and freeing a small block is O(1). Anything too
+// big for the largest class takes a run of whole pages. Slab pages are taken
+// from the top of the pool and page runs from the bottom so that the two
+// kinds of allocation don't interleave.
+//
+// With g_allocNoFragment set, slab pages that become empty are kept by their
+// class rather than handed back to the page pool. A page then never changes
+// role once it has been used, so small block churn can never break up the
+// free pages needed for large allocations on servers that run for a long
+// time without a map change. G_DefragmentMemory releases them explicitly,
+// which G_Alloc also does as a last resort before failing.
+
+#define  POOLSIZE       ( 1024 * 1024 )
+#define  PAGESIZE       4096
+#define  NUMPAGES       ( POOLSIZE / PAGESIZE )
 #define  FREEMEMCOOKIE  ((int)0xDEADBE3F)  // Any unlikely to be used value
-#define  ROUNDBITS    31          // Round to 32 bytes
+
+#define  MINCLASSBITS   5                 // 32 byte blocks
+#define  NUMCLASSES     7                 // up to 2048 byte blocks
+#define  CLASSSIZE(c)   ( 1 << ( (c) + MINCLASSBITS ) )
+
+// pageClass values other than a size class
+#define  PAGE_FREE      -1
+#define  PAGE_RUN       -2                // first page of a run
+#define  PAGE_RUNCONT   -3                // rest of a run
 
 struct freememnode
 {
-  // Size of ROUNDBITS
-  int cookie, size;        // Size includes node (obviously)
+  int cookie;
   struct freememnode *prev, *next;
 };
 
-static char    memoryPool[POOLSIZE];
-static struct freememnode *freehead;
-static int    freemem;
+typedef struct
+{
+  struct freememnode  *freehead;
+  int                 pages;      // slab pages owned by this class
+  int                 inuse;      // blocks handed out
+  int                 peak;       // highest inuse
+  int                 allocs;     // G_Alloc calls served
+} memClass_t;
+
+static char       memoryPool[ POOLSIZE ];
+static int        pageClass[ NUMPAGES ];
+static int        pageUsed[ NUMPAGES ];   // blocks in use on a slab page,
+                                          // page count of a run
+static memClass_t memClasses[ NUMCLASSES ];
+static int        freemem;                // bytes not given to any allocation
+static int        freePages;
+static int        runAllocs, runPages, runPeak;
 
-void *G_Alloc( int size )
+/*
+================
+G_SizeClass
+
+Smallest class that fits size, or -1 if it needs a page run
+================
+*/
+static int G_SizeClass( int size )
+{
+  int c;
+
+  for( c = 0; c < NUMCLASSES; c++ )
+  {
+    if( size <= CLASSSIZE( c ) )
+      return c;
+  }
+
+  return -1;
+}
+
+/*
+================
+G_AllocPages
+
+First fit a run of free pages, searching up from the bottom of the pool
+or down from the top
+================
+*/
+static int G_AllocPages( int count, qboolean fromTop )
 {
-  // Find a free block and allocate.
-  // Does two passes, attempts to fill same-sized free slot first.
+  int i, start, len;
 
-  struct freememnode *fmn, *prev, *next, *smallest;
-  int allocsize, smallestsize;
-  char *endptr;
-  int *ptr;
+  if( count > freePages )
+    return -1;
 
-  allocsize = ( size + sizeof(int) + ROUNDBITS ) & ~ROUNDBITS;    // Round to 32-byte boundary
-  ptr = NULL;
+  len = 0;
+  start = -1;
 
-  smallest = NULL;
-  smallestsize = POOLSIZE + 1;    // Guaranteed not to miss any slots :)
-  for( fmn = freehead; fmn; fmn = fmn->next )
+  for( i = 0; i < NUMPAGES; i++ )
   {
-    if( fmn->cookie != FREEMEMCOOKIE )
-      G_Error( "G_Alloc: Memory corruption detected!\n" );
+    int page = fromTop ? NUMPAGES - 1 - i : i;
+
+    if( pageClass[ page ] != PAGE_FREE )
+    {
+      len = 0;
+      continue;
+    }
+
+    len++;
 
-    if( fmn->size >= allocsize )
+    if( len == count )
     {
-      // We've got a block
-      if( fmn->size == allocsize )
-      {
-        // Same size, just remove
-
-        prev = fmn->prev;
-        next = fmn->next;
-        if( prev )
-          prev->next = next;      // Point previous node to next
-        if( next )
-          next->prev = prev;      // Point next node to previous
-        if( fmn == freehead )
-          freehead = next;      // Set head pointer to next
-        ptr = (int *) fmn;
-        break;              // Stop the loop, this is fine
-      }
-      else
-      {
-        // Keep track of the smallest free slot
-        if( fmn->size < smallestsize )
-        {
-          smallest = fmn;
-          smallestsize = fmn->size;
-        }
-      }
+      start = fromTop ? page : page - count + 1;
+      break;
     }
   }
 
-  if( !ptr && smallest )
+  if( start < 0 )
+    return -1;
+
+  freePages -= count;
+
+  return start;
+}
+
+/*
+================
+G_AddSlab
+
+Carve a new page into free blocks of class c
+================
+*/
+static qboolean G_AddSlab( int c )
+{
+  memClass_t          *mc = &memClasses[ c ];
+  struct freememnode  *fmn;
+  char                *base;
+  int                 page, i;
+
+  if( ( page = G_AllocPages( 1, qtrue ) ) < 0 )
+    return qfalse;
+
+  pageClass[ page ] = c;
+  pageUsed[ page ] = 0;
+  mc->pages++;
+
+  base = memoryPool + page * PAGESIZE;
+
+  for( i = PAGESIZE - CLASSSIZE( c ); i >= 0; i -= CLASSSIZE( c ) )
   {
-    // We found a slot big enough
-    smallest->size -= allocsize;
-    endptr = (char *) smallest + smallest->size;
-    ptr = (int *) endptr;
+    fmn = (struct freememnode *)( base + i );
+    fmn->cookie = FREEMEMCOOKIE;
+    fmn->prev = NULL;
+    fmn->next = mc->freehead;
+    if( mc->freehead )
+      mc->freehead->prev = fmn;
+    mc->freehead = fmn;
   }
 
-  if( ptr )
+  return qtrue;
+}
+
+/*
+================
+G_ReleaseSlab
+
+Give an empty slab page back to the page pool
+================
+*/
+static void G_ReleaseSlab( int page )
+{
+  int                 c = pageClass[ page ];
+  memClass_t          *mc = &memClasses[ c ];
+  struct freememnode  *fmn;
+  char                *base = memoryPool + page * PAGESIZE;
+  int                 i;
+
+  for( i = 0; i < PAGESIZE; i += CLASSSIZE( c ) )
   {
-    freemem -= allocsize;
-    if( g_debugAlloc.integer )
-      G_Printf( "G_Alloc of %i bytes (%i left)\n", allocsize, freemem );
-    memset( ptr, 0, allocsize );
-    *ptr++ = allocsize;        // Store a copy of size for deallocation
-    return( (void *) ptr );
+    fmn = (struct freememnode *)( base + i );
+
+    if( fmn->prev )
+      fmn->prev->next = fmn->next;
+    else
+      mc->freehead = fmn->next;
+
+    if( fmn->next )
+      fmn->next->prev = fmn->prev;
   }
 
-  G_Error( "G_Alloc: failed on allocation of %i bytes\n", size );
-  return( NULL );
+  pageClass[ page ] = PAGE_FREE;
+  mc->pages--;
+  freePages++;
 }
 
-void G_Free( void *ptr )
+/*
+================
+G_Alloc
+================
+*/
+void *G_Alloc( int size )
 {
-  // Release allocated memory, add it to the free list.
+  memClass_t          *mc;
+  struct freememnode  *fmn;
+  int                 c, page, count;
+  void                *ptr;
+
+  if( size <= 0 )
+    size = 1;
+
+  c = G_SizeClass( size );
 
-  struct freememnode *fmn;
-  char *freeend;
-  int *freeptr;
+  if( c < 0 )
+  {
+    count = ( size + PAGESIZE - 1 ) / PAGESIZE;
+
+    if( ( page = G_AllocPages( count, qfalse ) ) < 0 )
+    {
+      // empty slabs may be in the way
+      G_DefragmentMemory( );
+      page = G_AllocPages( count, qfalse );
+    }
 
-  freeptr = ptr;
-  freeptr--;
+    if( page < 0 )
+      G_Error( "G_Alloc: failed on allocation of %i bytes\n", size );
 
-  freemem += *freeptr;
+    pageClass[ page ] = PAGE_RUN;
+    pageUsed[ page ] = count;
+    for( c = 1; c < count; c++ )
+      pageClass[ page + c ] = PAGE_RUNCONT;
+
+    runAllocs++;
+    runPages += count;
+    if( runPages > runPeak )
+      runPeak = runPages;
+
+    freemem -= count * PAGESIZE;
+    if( g_debugAlloc.integer )
+      G_Printf( "G_Alloc of %i bytes as %i pages (%i left)\n", size, count, freemem );
+
+    ptr = memoryPool + page * PAGESIZE;
+    memset( ptr, 0, count * PAGESIZE );
+    return ptr;
+  }
+
+  mc = &memClasses[ c ];
+
+  if( !mc->freehead && !G_AddSlab( c ) )
+  {
+    G_DefragmentMemory( );
+    if( !G_AddSlab( c ) )
+      G_Error( "G_Alloc: failed on allocation of %i bytes\n", size );
+  }
+
+  fmn = mc->freehead;
+  if( fmn->cookie != FREEMEMCOOKIE )
+    G_Error( "G_Alloc: Memory corruption detected!\n" );
+
+  mc->freehead = fmn->next;
+  if( mc->freehead )
+    mc->freehead->prev = NULL;
+
+  pageUsed[ ( (char *)fmn - memoryPool ) / PAGESIZE ]++;
+
+  mc->allocs++;
+  mc->inuse++;
+  if( mc->inuse > mc->peak )
+    mc->peak = mc->inuse;
+
+  freemem -= CLASSSIZE( c );
   if( g_debugAlloc.integer )
-    G_Printf( "G_Free of %i bytes (%i left)\n", *freeptr, freemem );
+    G_Printf( "G_Alloc of %i bytes from %i byte class (%i left)\n",
+      size, CLASSSIZE( c ), freemem );
+
+  memset( fmn, 0, CLASSSIZE( c ) );
+  return (void *)fmn;
+}
+
+/*
+================
+G_Free
+================
+*/
+void G_Free( void *ptr )
+{
+  memClass_t          *mc;
+  struct freememnode  *fmn;
+  int                 offset, page, c, count;
 
-  for( fmn = freehead; fmn; fmn = fmn->next )
+  offset = (char *)ptr - memoryPool;
+  if( offset < 0 || offset >= POOLSIZE )
+    G_Error( "G_Free: pointer not allocated by G_Alloc\n" );
+
+  page = offset / PAGESIZE;
+  c = pageClass[ page ];
+
+  if( c == PAGE_RUN )
   {
-    freeend = ((char *) fmn) + fmn->size;
-    if( freeend == (char *) freeptr )
-    {
-      // Released block can be merged to an existing node
+    if( offset % PAGESIZE )
+      G_Error( "G_Free: Memory corruption detected!\n" );
 
-      fmn->size += *freeptr;    // Add size of node.
-      return;
-    }
+    count = pageUsed[ page ];
+    for( c = 0; c < count; c++ )
+      pageClass[ page + c ] = PAGE_FREE;
+
+    freePages += count;
+    runPages -= count;
+    freemem += count * PAGESIZE;
+    if( g_debugAlloc.integer )
+      G_Printf( "G_Free of %i pages (%i left)\n", count, freemem );
+    return;
   }
-  // No merging, add to head of list
 
-  fmn = (struct freememnode *) freeptr;
-  fmn->size = *freeptr;        // Set this first to avoid corrupting *freeptr
+  if( c < 0 || ( offset % PAGESIZE ) % CLASSSIZE( c ) )
+    G_Error( "G_Free: Memory corruption detected!\n" );
+
+  mc = &memClasses[ c ];
+
+  fmn = (struct freememnode *)ptr;
   fmn->cookie = FREEMEMCOOKIE;
   fmn->prev = NULL;
-  fmn->next = freehead;
-  freehead->prev = fmn;
-  freehead = fmn;
+  fmn->next = mc->freehead;
+  if( mc->freehead )
+    mc->freehead->prev = fmn;
+  mc->freehead = fmn;
+
+  mc->inuse--;
+  freemem += CLASSSIZE( c );
+  if( g_debugAlloc.integer )
+    G_Printf( "G_Free of %i bytes (%i left)\n", CLASSSIZE( c ), freemem );
+
+  if( --pageUsed[ page ] == 0 && !g_allocNoFragment.integer )
+    G_ReleaseSlab( page );
 }
 
+/*
+================
+G_InitMemory
+================
+*/
 void G_InitMemory( void )
 {
-  // Set up the initial node
+  int i;
 
-  freehead = (struct freememnode *)memoryPool;
-  freehead->cookie = FREEMEMCOOKIE;
-  freehead->size = POOLSIZE;
-  freehead->next = NULL;
-  freehead->prev = NULL;
+  for( i = 0; i < NUMPAGES; i++ )
+  {
+    pageClass[ i ] = PAGE_FREE;
+    pageUsed[ i ] = 0;
+  }
+
+  memset( memClasses, 0, sizeof( memClasses ) );
   freemem = sizeof( memoryPool );
+  freePages = NUMPAGES;
+  runAllocs = runPages = runPeak = 0;
 }
 
+/*
+================
+G_DefragmentMemory
+
+Hand empty slab pages back to the page pool so they can be used for
+page runs or by other classes
+================
+*/
 void G_DefragmentMemory( void )
 {
-  // If there's a frenzy of deallocation and we want to
-  // allocate something big, this is useful. Otherwise...
-  // not much use.
+  int i;
 
-  struct freememnode *startfmn, *endfmn, *fmn;
-
-  for( startfmn = freehead; startfmn; )
+  for( i = 0; i < NUMPAGES; i++ )
   {
-    endfmn = (struct freememnode *)(((char *) startfmn) + startfmn->size);
-    for( fmn = freehead; fmn; )
-    {
-      if( fmn->cookie != FREEMEMCOOKIE )
-        G_Error( "G_DefragmentMemory: Memory corruption detected!\n" );
-
-      if( fmn == endfmn )
-      {
-        // We can add fmn onto startfmn.
-
-        if( fmn->prev )
-          fmn->prev->next = fmn->next;
-        if( fmn->next )
-        {
-          if( !(fmn->next->prev = fmn->prev) )
-            freehead = fmn->next;  // We're removing the head node
-        }
-        startfmn->size += fmn->size;
-        memset( fmn, 0, sizeof(struct freememnode) );  // A redundant call, really.
-
-        startfmn = freehead;
-        endfmn = fmn = NULL;        // Break out of current loop
-      }
-      else
-        fmn = fmn->next;
-    }
-
-    if( endfmn )
-      startfmn = startfmn->next;    // endfmn acts as a 'restart' flag here
+    if( pageClass[ i ] >= 0 && pageUsed[ i ] == 0 )
+      G_ReleaseSlab( i );
   }
 }
 
+/*
+================
+Svcmd_GameMem_f
+
+Give a breakdown of memory
+================
+*/
 void Svcmd_GameMem_f( void )
 {
-  // Give a breakdown of memory
-
-  struct freememnode *fmn;
+  int i, largest = 0, len = 0;
 
   G_Printf( "Game memory status: %i out of %i bytes allocated\n", POOLSIZE - freemem, POOLSIZE );
+  G_Printf( "  %5s %6s %6s %6s %8s\n", "class", "pages", "inuse", "peak", "allocs" );
+
+  for( i = 0; i < NUMCLASSES; i++ )
+  {
+    memClass_t *mc = &memClasses[ i ];
+
+    G_Printf( "  %5d %6d %6d %6d %8d\n",
+      CLASSSIZE( i ), mc->pages, mc->inuse, mc->peak, mc->allocs );
+  }
+
+  G_Printf( "  %5s %6d %6s %6d %8d\n", "runs", runPages, "", runPeak, runAllocs );
+
+  for( i = 0; i < NUMPAGES; i++ )
+  {
+    if( pageClass[ i ] == PAGE_FREE )
+    {
+      if( ++len > largest )
+        largest = len;
+    }
+    else
+      len = 0;
+  }
 
-  for( fmn = freehead; fmn; fmn = fmn->next )
-    G_Printf( "  %dd: %d bytes free.\n", fmn, fmn->size );
+  G_Printf( "  %d of %d pages free, largest free run %d pages\n",
+    freePages, NUMPAGES, largest );
   G_Printf( "Status complete.\n" );
 }
 
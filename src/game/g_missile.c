@@ -87,7 +87,7 @@ void G_ExplodeMissile( gentity_t *ent )
       ent->s.weapon != WP_FLAMER )
     G_AddEvent( ent, EV_MISSILE_MISS, DirToByte( dir ) );
 
-  ent->freeAfterEvent = qtrue;
+  G_FreeAfterEvent( ent );
 
   // splash damage
   if( ent->splashDamage )
@@ -219,7 +219,7 @@ void G_MissileImpact( gentity_t *ent, trace_t *trace )
   else
     G_AddEvent( ent, EV_MISSILE_MISS, DirToByte( trace->plane.normal ) );
 
-  ent->freeAfterEvent = qtrue;
+  G_FreeAfterEvent( ent );
 
   // change over to a normal entity right at the point of impact
   ent->s.eType = ET_GENERAL;
@@ -0,0 +1,313 @@
+/*
+===========================================================================
+Copyright (C) 1999-2005 Id Software, Inc.
+Copyright (C) 2000-2006 Tim Angus
+
+This file is part of Tremulous.
+
+Tremulous is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the License,
+or (at your option) any later version.
+
+Tremulous is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Tremulous; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+===========================================================================
+*/
+
+// g_prof.c -- per phase timing of G_RunFrame
+
+#include "g_local.h"
+
+// trap_Milliseconds( ) only has a resolution of 1 msec, so short phases
+// mostly read 0 and occasionally 1. Since the sampling phase is random
+// the accumulated sums are still an unbiased estimate of the real cost.
+
+#define FRAMEPROF_WINDOW  256
+
+typedef struct
+{
+  int samples[ FRAMEPROF_WINDOW ];  // msec spent in this phase per frame
+  int counts[ FRAMEPROF_WINDOW ];   // number of calls/entities per frame
+
+  int total;                        // msec spent since the last reset
+  int worst;                        // worst single frame since the last reset
+  int worstTime;                    // level.time of the worst frame
+} frameProfPhase_t;
+
+static const char *phaseNames[ FP_NUM_PHASES ] =
+{
+  "entities",
+  "missiles",
+  "buildables",
+  "physics",
+  "movers",
+  "clients",
+  "thinkers",
+  "ClientEndFrame",
+  "G_UnlaggedStore",
+  "G_CountSpawns",
+  "G_CalculateBuildPoints",
+  "G_CalculateStages",
+  "G_SpawnClients",
+  "G_CalculateAvgPlayers",
+  "G_UpdateZaps",
+  "CheckExitRules",
+  "CheckTeamStatus",
+  "CheckVote",
+  "CheckCvars",
+  "G_LogFrame",
+  "total"
+};
+
+static frameProfPhase_t phases[ FP_NUM_PHASES ];
+static int              frameMsec[ FP_NUM_PHASES ];
+static int              frameCount[ FP_NUM_PHASES ];
+static int              frameStart;
+static int              numFrames;    // frames recorded since the last reset
+static int              windowHead;   // next slot to write in the window
+
+/*
+================
+G_FrameProfReset
+
+Discard all recorded timings
+================
+*/
+void G_FrameProfReset( void )
+{
+  memset( phases, 0, sizeof( phases ) );
+  memset( frameMsec, 0, sizeof( frameMsec ) );
+  memset( frameCount, 0, sizeof( frameCount ) );
+  numFrames = 0;
+  windowHead = 0;
+}
+
+/*
+================
+G_FrameProfBegin
+
+Start timing a new frame, returns the time to pass to G_FrameProfAdd
+================
+*/
+int G_FrameProfBegin( void )
+{
+  if( !g_frameProf.integer )
+    return 0;
+
+  memset( frameMsec, 0, sizeof( frameMsec ) );
+  memset( frameCount, 0, sizeof( frameCount ) );
+  frameStart = trap_Milliseconds( );
+
+  return frameStart;
+}
+
+/*
+================
+G_FrameProfAdd
+
+Charge the time since start to phase, returns the current time so
+consecutive phases can be chained without extra trap calls
+================
+*/
+int G_FrameProfAdd( framePhase_t phase, int start )
+{
+  int now;
+
+  if( !g_frameProf.integer )
+    return 0;
+
+  now = trap_Milliseconds( );
+  frameMsec[ phase ] += now - start;
+  frameCount[ phase ]++;
+
+  return now;
+}
+
+/*
+================
+G_FrameProfEnd
+
+Commit the timings of the current frame into the rolling window
+================
+*/
+void G_FrameProfEnd( void )
+{
+  int i;
+
+  if( !g_frameProf.integer )
+    return;
+
+  frameMsec[ FP_TOTAL ] = trap_Milliseconds( ) - frameStart;
+  frameCount[ FP_TOTAL ] = 1;
+
+  for( i = 0; i < FP_NUM_PHASES; i++ )
+  {
+    frameProfPhase_t *p = &phases[ i ];
+
+    p->samples[ windowHead ] = frameMsec[ i ];
+    p->counts[ windowHead ] = frameCount[ i ];
+    p->total += frameMsec[ i ];
+
+    if( frameMsec[ i ] > p->worst )
+    {
+      p->worst = frameMsec[ i ];
+      p->worstTime = level.time;
+    }
+  }
+
+  windowHead = ( windowHead + 1 ) % FRAMEPROF_WINDOW;
+  numFrames++;
+}
+
+/*
+================
+G_FrameProfSortInts
+
+qsort comparison function for window samples
+================
+*/
+static int QDECL G_FrameProfSortInts( const void *a, const void *b )
+{
+  return *(const int *)a - *(const int *)b;
+}
+
+/*
+================
+G_FrameProfStats
+
+Calculate min/avg/p99/max of a phase over the rolling window
+================
+*/
+static void G_FrameProfStats( framePhase_t phase, int *min, float *avg,
+                              int *p99, int *max, float *count )
+{
+  frameProfPhase_t  *p = &phases[ phase ];
+  int               sorted[ FRAMEPROF_WINDOW ];
+  int               i, n, sum = 0, sumCount = 0;
+
+  n = numFrames < FRAMEPROF_WINDOW ? numFrames : FRAMEPROF_WINDOW;
+
+  if( n <= 0 )
+  {
+    *min = *p99 = *max = 0;
+    *avg = *count = 0.0f;
+    return;
+  }
+
+  for( i = 0; i < n; i++ )
+  {
+    sorted[ i ] = p->samples[ i ];
+    sum += p->samples[ i ];
+    sumCount += p->counts[ i ];
+  }
+
+  qsort( sorted, n, sizeof( sorted[ 0 ] ), G_FrameProfSortInts );
+
+  *min = sorted[ 0 ];
+  *max = sorted[ n - 1 ];
+  *p99 = sorted[ ( n * 99 ) / 100 ];
+  *avg = (float)sum / n;
+  *count = (float)sumCount / n;
+}
+
+/*
+================
+G_FrameProfDump
+
+Write the current profile as CSV, called at intermission
+================
+*/
+void G_FrameProfDump( void )
+{
+  fileHandle_t  f;
+  char          map[ MAX_QPATH ];
+  char          *s;
+  qtime_t       qt;
+  int           i, min, p99, max;
+  float         avg, count;
+
+  if( !g_frameProf.integer || !g_frameProfLog.string[ 0 ] || !numFrames )
+    return;
+
+  trap_Cvar_VariableStringBuffer( "mapname", map, sizeof( map ) );
+  trap_RealTime( &qt );
+
+  s = va( "%s/%04i%02i%02i-%02i%02i%02i-%s.csv", g_frameProfLog.string,
+          qt.tm_year + 1900, qt.tm_mon + 1, qt.tm_mday,
+          qt.tm_hour, qt.tm_min, qt.tm_sec, map );
+
+  if( trap_FS_FOpenFile( s, &f, FS_WRITE ) < 0 || !f )
+  {
+    G_Printf( "G_FrameProfDump: could not open %s\n", s );
+    return;
+  }
+
+  s = "phase,frames,count,min,avg,p99,max,total,worst,worsttime\n";
+  trap_FS_Write( s, strlen( s ), f );
+
+  for( i = 0; i < FP_NUM_PHASES; i++ )
+  {
+    G_FrameProfStats( i, &min, &avg, &p99, &max, &count );
+
+    s = va( "%s,%d,%.2f,%d,%.3f,%d,%d,%d,%d,%d\n",
+            phaseNames[ i ],
+            numFrames, count, min, avg, p99, max,
+            phases[ i ].total, phases[ i ].worst, phases[ i ].worstTime );
+    trap_FS_Write( s, strlen( s ), f );
+  }
+
+  trap_FS_FCloseFile( f );
+}
+
+/*
+================
+Svcmd_FrameProf_f
+
+frameprof [reset]
+================
+*/
+void Svcmd_FrameProf_f( void )
+{
+  char  arg[ MAX_TOKEN_CHARS ];
+  int   i, min, p99, max;
+  float avg, count;
+
+  trap_Argv( 1, arg, sizeof( arg ) );
+
+  if( !Q_stricmp( arg, "reset" ) )
+  {
+    G_FrameProfReset( );
+    G_Printf( "frameprof: timings reset\n" );
+    return;
+  }
+
+  if( !g_frameProf.integer )
+  {
+    G_Printf( "frameprof: set g_frameProf 1 to enable frame profiling\n" );
+    return;
+  }
+
+  G_Printf( "frame profile over the last %d of %d frames (msec)\n",
+            numFrames < FRAMEPROF_WINDOW ? numFrames : FRAMEPROF_WINDOW,
+            numFrames );
+  G_Printf( "%-22s   %7s %4s %7s %4s %4s %8s %5s\n",
+            "phase", "count", "min", "avg", "p99", "max", "total", "worst" );
+
+  for( i = 0; i < FP_NUM_PHASES; i++ )
+  {
+    G_FrameProfStats( i, &min, &avg, &p99, &max, &count );
+
+    // per eType breakdown of the entity loop is indented
+    G_Printf( "%s%-22s %7.1f %4d %7.3f %4d %4d %8d %5d\n",
+              ( i > FP_ENTITIES && i <= FP_THINKERS ) ? "  " : "",
+              phaseNames[ i ], count, min, avg, p99, max,
+              phases[ i ].total, phases[ i ].worst );
+  }
+}
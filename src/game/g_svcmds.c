@@ -606,6 +606,42 @@ qboolean  ConsoleCommand( void )
     return qtrue;
   }
 
+  if( Q_stricmp( cmd, "frameprof" ) == 0 )
+  {
+    Svcmd_FrameProf_f( );
+    return qtrue;
+  }
+
+  if( Q_stricmp( cmd, "unlaggedstats" ) == 0 )
+  {
+    Svcmd_UnlaggedStats_f( );
+    return qtrue;
+  }
+
+  if( Q_stricmp( cmd, "entitystats" ) == 0 )
+  {
+    Svcmd_EntityStats_f( );
+    return qtrue;
+  }
+
+  if( Q_stricmp( cmd, "csstats" ) == 0 )
+  {
+    Svcmd_ConfigstringStats_f( );
+    return qtrue;
+  }
+
+  if( Q_stricmp( cmd, "logstats" ) == 0 )
+  {
+    Svcmd_LogStats_f( );
+    return qtrue;
+  }
+
+  if( Q_stricmp( cmd, "cmdstats" ) == 0 )
+  {
+    Svcmd_CmdStats_f( );
+    return qtrue;
+  }
+
   if( Q_stricmp( cmd, "addip" ) == 0 )
   {
     Svcmd_AddIP_f( );
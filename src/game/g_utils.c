@@ -79,6 +79,113 @@ const char *BuildShaderStateConfig( void )
 }
 
 
+/*
+=========================================================================
+
+cached configstrings
+
+Some configstrings are republished every frame even though their value
+rarely changes. G_SetConfigstringCached keeps the last value sent for a
+handful of such indexes and only calls the trap when it differs.
+
+=========================================================================
+*/
+
+#define CS_CACHE_SLOTS    16
+#define CS_CACHE_LENGTH   64
+
+typedef struct
+{
+  int   num;
+  char  value[ CS_CACHE_LENGTH ];
+} csCacheSlot_t;
+
+static csCacheSlot_t  csCache[ CS_CACHE_SLOTS ];
+static int            csCacheUsed;
+static int            csCacheSets;        // calls to G_SetConfigstringCached
+static int            csCacheSuppressed;  // ...that didn't reach the engine
+
+/*
+================
+G_InitConfigstringCache
+
+Forget all cached values, the next set of each index always goes through
+================
+*/
+void G_InitConfigstringCache( void )
+{
+  memset( csCache, 0, sizeof( csCache ) );
+  csCacheUsed = 0;
+  csCacheSets = csCacheSuppressed = 0;
+}
+
+/*
+================
+G_SetConfigstringCached
+
+trap_SetConfigstring that is skipped if the value hasn't changed since the
+last call for the same index
+================
+*/
+void G_SetConfigstringCached( int num, const char *string )
+{
+  csCacheSlot_t *slot = NULL;
+  int           i;
+
+  csCacheSets++;
+
+  for( i = 0; i < csCacheUsed; i++ )
+  {
+    if( csCache[ i ].num == num )
+    {
+      slot = &csCache[ i ];
+      break;
+    }
+  }
+
+  if( !slot && csCacheUsed < CS_CACHE_SLOTS )
+  {
+    slot = &csCache[ csCacheUsed++ ];
+    slot->num = num;
+    slot->value[ 0 ] = '\0';
+    trap_SetConfigstring( num, string );
+  }
+  else if( slot && !strcmp( slot->value, string ) )
+  {
+    csCacheSuppressed++;
+    return;
+  }
+  else
+    trap_SetConfigstring( num, string );
+
+  // values that don't fit are never cached
+  if( slot )
+  {
+    if( strlen( string ) < CS_CACHE_LENGTH )
+      Q_strncpyz( slot->value, string, sizeof( slot->value ) );
+    else
+      slot->value[ 0 ] = '\0';
+  }
+}
+
+/*
+================
+Svcmd_ConfigstringStats_f
+
+csstats
+================
+*/
+void Svcmd_ConfigstringStats_f( void )
+{
+  int i;
+
+  G_Printf( "cached configstrings: %d sets, %d suppressed\n",
+            csCacheSets, csCacheSuppressed );
+
+  for( i = 0; i < csCacheUsed; i++ )
+    G_Printf( "  %4d: %s\n", csCache[ i ].num, csCache[ i ].value );
+}
+
 /*
 =========================================================================
 
@@ -187,15 +294,8 @@ gentity_t *G_Find( gentity_t *from, int fieldofs, const char *match )
 {
   char  *s;
 
-  if( !from )
-    from = g_entities;
-  else
-    from++;
-
-  for( ; from < &g_entities[ level.num_entities ]; from++ )
+  for( from = G_NextEntity( from ); from; from = G_NextEntity( from ) )
   {
-    if( !from->inuse )
-      continue;
     s = *(char **)( (byte *)from + fieldofs );
 
     if( !s )
@@ -405,14 +505,300 @@ float vectoyaw( const vec3_t vec )
 }
 
 
+/*
+=================
+G_HighestBit
+
+Index of the highest set bit, bits must not be 0
+=================
+*/
+static int G_HighestBit( unsigned int bits )
+{
+  int n = 0;
+
+  if( bits >= 0x10000 )
+  {
+    n += 16;
+    bits >>= 16;
+  }
+  if( bits >= 0x100 )
+  {
+    n += 8;
+    bits >>= 8;
+  }
+  if( bits >= 0x10 )
+  {
+    n += 4;
+    bits >>= 4;
+  }
+  if( bits >= 0x4 )
+  {
+    n += 2;
+    bits >>= 2;
+  }
+  if( bits >= 0x2 )
+    n++;
+
+  return n;
+}
+
+/*
+=================
+G_LowestBit
+
+Index of the lowest set bit, bits must not be 0
+=================
+*/
+static int G_LowestBit( unsigned int bits )
+{
+  return G_HighestBit( bits & ( ~bits + 1 ) );
+}
+
+static void G_SetEntityBit( entityBits_t *bits, int n )
+{
+  bits->words[ n >> 5 ] |= 1U << ( n & 31 );
+  bits->summary |= 1U << ( n >> 5 );
+}
+
+static void G_ClearEntityBit( entityBits_t *bits, int n )
+{
+  bits->words[ n >> 5 ] &= ~( 1U << ( n & 31 ) );
+  if( !bits->words[ n >> 5 ] )
+    bits->summary &= ~( 1U << ( n >> 5 ) );
+}
+
+/*
+=================
+G_PrevEntityBit
+
+The highest set slot below n, or -1
+=================
+*/
+static int G_PrevEntityBit( entityBits_t *bits, int n )
+{
+  int           w = n >> 5;
+  unsigned int  mask;
+
+  mask = bits->words[ w ] & ( ( 1U << ( n & 31 ) ) - 1 );
+  if( mask )
+    return ( w << 5 ) + G_HighestBit( mask );
+
+  mask = bits->summary & ( ( 1U << w ) - 1 );
+  if( !mask )
+    return -1;
+
+  w = G_HighestBit( mask );
+  return ( w << 5 ) + G_HighestBit( bits->words[ w ] );
+}
+
+/*
+=================
+G_NextEntityBit
+
+The lowest set slot from n up, or -1
+=================
+*/
+static int G_NextEntityBit( entityBits_t *bits, int n )
+{
+  int           w = n >> 5;
+  unsigned int  mask;
+
+  if( n >= MAX_GENTITIES )
+    return -1;
+
+  mask = bits->words[ w ] & ~( ( 1U << ( n & 31 ) ) - 1 );
+  if( mask )
+    return ( w << 5 ) + G_LowestBit( mask );
+
+  // 2U << 31 wraps to 0, leaving no words above the last
+  mask = bits->summary & ~( ( 2U << w ) - 1 );
+  if( !mask )
+    return -1;
+
+  w = G_LowestBit( mask );
+  return ( w << 5 ) + G_LowestBit( bits->words[ w ] );
+}
+
+/*
+=================
+G_AddToEntityList
+
+Insert a slot into the run list after the previous slot on it, found from
+level.runEntityBits, so walks visit entities the same way a scan of
+g_entities would
+=================
+*/
+static void G_AddToEntityList( gentity_t *e )
+{
+  int       n = e - g_entities;
+  gentity_t *prev = NULL;
+
+  n = G_PrevEntityBit( &level.runEntityBits, n );
+  if( n >= 0 )
+    prev = &g_entities[ n ];
+
+  if( !prev )
+  {
+    e->entityPrev = NULL;
+    e->entityNext = level.firstEntity;
+    level.firstEntity = e;
+  }
+  else
+  {
+    e->entityPrev = prev;
+    e->entityNext = prev->entityNext;
+    prev->entityNext = e;
+  }
+
+  if( e->entityNext )
+    e->entityNext->entityPrev = e;
+
+  G_SetEntityBit( &level.runEntityBits, e - g_entities );
+}
+
+/*
+=================
+G_RemoveFromEntityList
+
+Unlink a slot from the run list or the temp entity list, stepping G_RunFrame
+back if it is the entity being run
+=================
+*/
+static void G_RemoveFromEntityList( gentity_t *e )
+{
+  if( level.runEntity == e )
+    level.runEntity = e->entityPrev;
+
+  if( e->entityPrev )
+    e->entityPrev->entityNext = e->entityNext;
+  else if( e->freeAfterEvent )
+    level.firstTempEntity = e->entityNext;
+  else
+    level.firstEntity = e->entityNext;
+
+  if( e->entityNext )
+    e->entityNext->entityPrev = e->entityPrev;
+
+  e->entityNext = e->entityPrev = NULL;
+
+  if( !e->freeAfterEvent )
+    G_ClearEntityBit( &level.runEntityBits, e - g_entities );
+}
+
+/*
+=================
+G_FreeAfterEvent
+
+Have an entity freed once its event has expired. It is moved from the run
+list to the temp entity list, which G_RunFrame only checks for expired events
+=================
+*/
+void G_FreeAfterEvent( gentity_t *ent )
+{
+  if( ent->freeAfterEvent )
+    return;
+
+  if( ent >= &g_entities[ MAX_CLIENTS ] && ent->inuse )
+  {
+    G_RemoveFromEntityList( ent );
+
+    ent->entityNext = level.firstTempEntity;
+    if( ent->entityNext )
+      ent->entityNext->entityPrev = ent;
+    level.firstTempEntity = ent;
+  }
+
+  ent->freeAfterEvent = qtrue;
+}
+
+/*
+=================
+G_NextEntity
+
+The next in-use entity after from in entity number order, or the first if
+from is NULL. Free slots above the clients are skipped without being looked at.
+=================
+*/
+gentity_t *G_NextEntity( gentity_t *from )
+{
+  int n = from ? from - g_entities + 1 : 0;
+
+  for( ; n < level.maxclients; n++ )
+  {
+    if( g_entities[ n ].inuse )
+      return &g_entities[ n ];
+  }
+
+  if( n < MAX_CLIENTS )
+    n = MAX_CLIENTS;
+
+  n = G_NextEntityBit( &level.usedEntityBits, n );
+  if( n < 0 )
+    return NULL;
+
+  return &g_entities[ n ];
+}
+
 void G_InitGentity( gentity_t *e )
 {
+  if( !e->inuse && e >= &g_entities[ MAX_CLIENTS ] )
+  {
+    G_AddToEntityList( e );
+    G_SetEntityBit( &level.usedEntityBits, e - g_entities );
+
+    level.numUsedEntities++;
+    if( level.numUsedEntities > level.peakUsedEntities )
+      level.peakUsedEntities = level.numUsedEntities;
+  }
+
   e->inuse = qtrue;
   e->classname = "noclass";
   e->s.number = e - g_entities;
   e->r.ownerNum = ENTITYNUM_NONE;
 }
 
+/*
+=================
+G_QueueFreeEntity
+
+Append a freed slot to the free queue. Slots are freed in level.time order
+so the queue stays sorted by freetime.
+=================
+*/
+static void G_QueueFreeEntity( gentity_t *e )
+{
+  e->freeNext = NULL;
+
+  if( level.freeTail )
+    level.freeTail->freeNext = e;
+  else
+    level.freeHead = e;
+
+  level.freeTail = e;
+  level.numFreeEntities++;
+}
+
+/*
+=================
+G_PopFreeEntity
+
+Take the slot at the head of the free queue
+=================
+*/
+static gentity_t *G_PopFreeEntity( void )
+{
+  gentity_t *e = level.freeHead;
+
+  level.freeHead = e->freeNext;
+  if( !level.freeHead )
+    level.freeTail = NULL;
+
+  e->freeNext = NULL;
+  level.numFreeEntities--;
+
+  return e;
+}
+
 /*
 =================
 G_Spawn
@@ -430,39 +816,33 @@ angles and bad trails.
 */
 gentity_t *G_Spawn( void )
 {
-  int       i, force;
+  int       i;
   gentity_t *e;
 
-  e = NULL; // shut up warning
-  i = 0;    // shut up warning
-
-  for( force = 0; force < 2; force++ )
+  // the free queue is oldest first, so if its head was freed too recently
+  // to reuse then so was every other free slot. The first couple seconds
+  // of server time can involve a lot of freeing and allocating, so relax
+  // the replacement policy then
+  e = level.freeHead;
+  if( e && ( e->freetime <= level.startTime + 2000 || level.time - e->freetime >= 1000 ) )
   {
-    // if we go through all entities and can't find one to free,
-    // override the normal minimum times before use
-    e = &g_entities[ MAX_CLIENTS ];
+    // reuse this slot
+    e = G_PopFreeEntity( );
+    G_InitGentity( e );
+    return e;
+  }
 
-    for( i = MAX_CLIENTS; i < level.num_entities; i++, e++ )
+  if( level.num_entities == ENTITYNUM_MAX_NORMAL )
+  {
+    // out of new slots, override the normal minimum times before use
+    if( level.freeHead )
     {
-      if( e->inuse )
-        continue;
-
-      // the first couple seconds of server time can involve a lot of
-      // freeing and allocating, so relax the replacement policy
-      if( !force && e->freetime > level.startTime + 2000 && level.time - e->freetime < 1000 )
-        continue;
-
-      // reuse this slot
+      level.forcedEntityReuses++;
+      e = G_PopFreeEntity( );
       G_InitGentity( e );
       return e;
     }
 
-    if( i != MAX_GENTITIES )
-      break;
-  }
-
-  if( i == ENTITYNUM_MAX_NORMAL )
-  {
     for( i = 0; i < MAX_GENTITIES; i++ )
       G_Printf( "%4i: %s\n", i, g_entities[ i ].classname );
 
@@ -470,6 +850,7 @@ gentity_t *G_Spawn( void )
   }
 
   // open up a new slot
+  e = &g_entities[ level.num_entities ];
   level.num_entities++;
 
   // let the server system know that there are more entities
@@ -488,21 +869,24 @@ G_EntitiesFree
 */
 qboolean G_EntitiesFree( void )
 {
-  int     i;
-  gentity_t *e;
-
-  e = &g_entities[ MAX_CLIENTS ];
-
-  for( i = MAX_CLIENTS; i < level.num_entities; i++, e++ )
-  {
-    if( e->inuse )
-      continue;
+  // every free slot below level.num_entities is on the free queue
+  return level.freeHead != NULL;
+}
 
-    // slot available
-    return qtrue;
-  }
+/*
+=================
+Svcmd_EntityStats_f
 
-  return qfalse;
+entitystats
+=================
+*/
+void Svcmd_EntityStats_f( void )
+{
+  G_Printf( "entities: %d slots of %d, %d in use, peak %d\n",
+            level.num_entities - MAX_CLIENTS, ENTITYNUM_MAX_NORMAL - MAX_CLIENTS,
+            level.numUsedEntities, level.peakUsedEntities );
+  G_Printf( "free queue: %d slots, %d reused early\n",
+            level.numFreeEntities, level.forcedEntityReuses );
 }
 
 
@@ -520,10 +904,26 @@ void G_FreeEntity( gentity_t *ent )
   if( ent->neverFree )
     return;
 
+  G_UnlinkBuildable( ent );
+
+  if( ent >= &g_entities[ MAX_CLIENTS ] )
+  {
+    // a free slot is already on the free queue
+    if( !ent->inuse )
+      return;
+
+    G_RemoveFromEntityList( ent );
+    G_ClearEntityBit( &level.usedEntityBits, ent - g_entities );
+    level.numUsedEntities--;
+  }
+
   memset( ent, 0, sizeof( *ent ) );
   ent->classname = "freent";
   ent->freetime = level.time;
   ent->inuse = qfalse;
+
+  if( ent >= &g_entities[ MAX_CLIENTS ] )
+    G_QueueFreeEntity( ent );
 }
 
 /*
@@ -545,7 +945,7 @@ gentity_t *G_TempEntity( vec3_t origin, int event )
 
   e->classname = "tempEntity";
   e->eventTime = level.time;
-  e->freeAfterEvent = qtrue;
+  G_FreeAfterEvent( e );
 
   VectorCopy( origin, snapped );
   SnapVector( snapped );    // save network bandwidth
@@ -738,6 +1138,9 @@ void G_SetOrigin( gentity_t *ent, vec3_t origin )
 
   VectorCopy( origin, ent->r.currentOrigin );
   VectorCopy( origin, ent->s.origin ); //TA: if shit breaks - blame this line
+
+  if( ent->s.eType == ET_BUILDABLE )
+    G_LinkBuildable( ent );
 }
 
 //TA: from quakestyle.telefragged.com
@@ -748,16 +1151,8 @@ gentity_t *G_FindRadius( gentity_t *from, vec3_t org, float rad )
   vec3_t  eorg;
   int j;
 
-  if( !from )
-    from = g_entities;
-  else
-    from++;
-
-  for( ; from < &g_entities[ level.num_entities ]; from++ )
+  for( from = G_NextEntity( from ); from; from = G_NextEntity( from ) )
   {
-    if( !from->inuse )
-      continue;
-
     for( j = 0; j < 3; j++ )
       eorg[ j ] = org[ j ] - ( from->r.currentOrigin[ j ] + ( from->r.mins[ j ] + from->r.maxs[ j ] ) * 0.5 );
 
@@ -770,6 +1165,42 @@ gentity_t *G_FindRadius( gentity_t *from, vec3_t org, float rad )
   return NULL;
 }
 
+/*
+===============
+G_ClientsInBox
+
+Fill list with the linked clients on a team (PTE_NONE for any team) whose
+bounds touch a box, the same clients trap_EntitiesInBox would return. There
+are never more than MAX_CLIENTS of them so a scan beats hashing clients that
+move between server frames.
+===============
+*/
+int G_ClientsInBox( const vec3_t mins, const vec3_t maxs, pTeam_t team,
+                    gentity_t **list, int maxcount )
+{
+  int       i;
+  int       count = 0;
+  gentity_t *ent;
+
+  for( i = 0, ent = g_entities; i < level.maxclients && count < maxcount; i++, ent++ )
+  {
+    if( !ent->inuse || !ent->client || !ent->r.linked )
+      continue;
+
+    if( team != PTE_NONE && ent->client->ps.stats[ STAT_PTEAM ] != team )
+      continue;
+
+    if( ent->r.absmin[ 0 ] > maxs[ 0 ] || ent->r.absmax[ 0 ] < mins[ 0 ] ||
+        ent->r.absmin[ 1 ] > maxs[ 1 ] || ent->r.absmax[ 1 ] < mins[ 1 ] ||
+        ent->r.absmin[ 2 ] > maxs[ 2 ] || ent->r.absmax[ 2 ] < mins[ 2 ] )
+      continue;
+
+    list[ count++ ] = ent;
+  }
+
+  return count;
+}
+
 /*
 ===============
 G_Visible
@@ -164,7 +164,7 @@ static void G_WideTrace( trace_t *tr, gentity_t *ent, float range, float width,
   CalcMuzzlePoint( ent, forward, right, up, muzzle );
   VectorMA( muzzle, range, forward, end );
 
-  G_UnlaggedOn( ent, muzzle, range );
+  G_UnlaggedOnTrace( ent, muzzle, end, width * M_ROOT3 );
 
   // Trace against entities
   trap_Trace( tr, muzzle, mins, maxs, end, ent->s.number, CONTENTS_BODY );
@@ -233,7 +233,7 @@ void meleeAttack( gentity_t *ent, float range, float width, int damage, meansOfD
 
   VectorMA( muzzle, range, forward, end );
 
-  G_UnlaggedOn( ent, muzzle, range );
+  G_UnlaggedOnTrace( ent, muzzle, end, width * M_ROOT3 );
   trap_Trace( &tr, muzzle, mins, maxs, end, ent->s.number, MASK_SHOT );
   G_UnlaggedOff( );
 
@@ -283,7 +283,7 @@ void bulletFire( gentity_t *ent, float spread, int damage, int mod )
   // don't use unlagged if this is not a client (e.g. turret)
   if( ent->client )
   {
-    G_UnlaggedOn( ent, muzzle, 8192 * 16 );
+    G_UnlaggedOnTrace( ent, muzzle, end, 0.0f );
     trap_Trace( &tr, muzzle, NULL, NULL, end, ent->s.number, MASK_SHOT );
     G_UnlaggedOff( );
   }
@@ -396,7 +396,7 @@ void massDriverFire( gentity_t *ent )
 
   VectorMA( muzzle, 8192 * 16, forward, end );
 
-  G_UnlaggedOn( ent, muzzle, 8192 * 16 );
+  G_UnlaggedOnTrace( ent, muzzle, end, 0.0f );
   trap_Trace( &tr, muzzle, NULL, NULL, end, ent->s.number, MASK_SHOT );
   G_UnlaggedOff( );
 
@@ -552,7 +552,7 @@ void lasGunFire( gentity_t *ent )
 
   VectorMA( muzzle, 8192 * 16, forward, end );
 
-  G_UnlaggedOn( ent, muzzle, 8192 * 16 );
+  G_UnlaggedOnTrace( ent, muzzle, end, 0.0f );
   trap_Trace( &tr, muzzle, NULL, NULL, end, ent->s.number, MASK_SHOT );
   G_UnlaggedOff( );
 
@@ -607,7 +607,7 @@ void painSawFire( gentity_t *ent )
 
   VectorMA( muzzle, PAINSAW_RANGE, forward, end );
 
-  G_UnlaggedOn( ent, muzzle, PAINSAW_RANGE );
+  G_UnlaggedOnTrace( ent, muzzle, end, 0.0f );
   trap_Trace( &tr, muzzle, NULL, NULL, end, ent->s.number, MASK_SHOT );
   G_UnlaggedOff( );
 
@@ -887,7 +887,7 @@ qboolean CheckVenomAttack( gentity_t *ent )
 
   VectorMA( muzzle, LEVEL0_BITE_RANGE, forward, end );
 
-  G_UnlaggedOn( ent, muzzle, LEVEL0_BITE_RANGE );
+  G_UnlaggedOnTrace( ent, muzzle, end, LEVEL0_BITE_WIDTH * M_ROOT3 );
   trap_Trace( &tr, muzzle, mins, maxs, end, ent->s.number, MASK_SHOT );
   G_UnlaggedOff( );
 
@@ -1013,7 +1013,7 @@ poisonCloud
 */
 void poisonCloud( gentity_t *ent )
 {
-  int       entityList[ MAX_GENTITIES ];
+  gentity_t *entityList[ MAX_CLIENTS ];
   vec3_t    range = { LEVEL1_PCLOUD_RANGE, LEVEL1_PCLOUD_RANGE, LEVEL1_PCLOUD_RANGE };
   vec3_t    mins, maxs;
   int       i, num;
@@ -1024,10 +1024,10 @@ void poisonCloud( gentity_t *ent )
   VectorSubtract( ent->client->ps.origin, range, mins );
 
   G_UnlaggedOn( ent, ent->client->ps.origin, LEVEL1_PCLOUD_RANGE );
-  num = trap_EntitiesInBox( mins, maxs, entityList, MAX_GENTITIES );
+  num = G_ClientsInBox( mins, maxs, PTE_HUMANS, entityList, MAX_CLIENTS );
   for( i = 0; i < num; i++ )
   {
-    humanPlayer = &g_entities[ entityList[ i ] ];
+    humanPlayer = entityList[ i ];
 
     if( humanPlayer->client && humanPlayer->client->ps.stats[ STAT_PTEAM ] == PTE_HUMANS )
     {
@@ -1068,6 +1068,42 @@ LEVEL2
 
 static zap_t  zaps[ MAX_CLIENTS ];
 
+/*
+===============
+G_IsNewZapTarget
+
+Whether a zap from ent can reach enemy and nothing is zapping it yet
+===============
+*/
+static qboolean G_IsNewZapTarget( gentity_t *ent, gentity_t *enemy )
+{
+  int       j, k;
+  trace_t   tr;
+
+  if( enemy->health <= 0 )
+    return qfalse;
+
+  trap_Trace( &tr, muzzle, NULL, NULL, enemy->s.origin, ent->s.number, MASK_SHOT );
+
+  //can't see target from here
+  if( tr.entityNum == ENTITYNUM_WORLD )
+    return qfalse;
+
+  for( j = 0; j < MAX_ZAPS; j++ )
+  {
+    zap_t *zap = &zaps[ j ];
+
+    for( k = 0; k < zap->numTargets; k++ )
+    {
+      // enemy is already targetted
+      if( zap->targets[ k ] == enemy )
+        return qfalse;
+    }
+  }
+
+  return qtrue;
+}
+
 /*
 ===============
 G_FindNewZapTarget
@@ -1075,59 +1111,40 @@ G_FindNewZapTarget
 */
 static gentity_t *G_FindNewZapTarget( gentity_t *ent )
 {
-  int       entityList[ MAX_GENTITIES ];
+  gentity_t *entityList[ MAX_CLIENTS ];
   vec3_t    range = { LEVEL2_AREAZAP_RANGE, LEVEL2_AREAZAP_RANGE, LEVEL2_AREAZAP_RANGE };
   vec3_t    mins, maxs;
-  int       i, j, k, num;
+  int       i, num, after;
   gentity_t *enemy;
-  trace_t   tr;
 
   VectorScale( range, 1.0f / M_ROOT3, range );
   VectorAdd( ent->s.origin, range, maxs );
   VectorSubtract( ent->s.origin, range, mins );
 
-  num = trap_EntitiesInBox( mins, maxs, entityList, MAX_GENTITIES );
-
+  num = G_ClientsInBox( mins, maxs, PTE_HUMANS, entityList, MAX_CLIENTS );
   for( i = 0; i < num; i++ )
   {
-    enemy = &g_entities[ entityList[ i ] ];
+    if( G_IsNewZapTarget( ent, entityList[ i ] ) )
+      return entityList[ i ];
+  }
 
-    if( ( ( enemy->client && enemy->client->ps.stats[ STAT_PTEAM ] == PTE_HUMANS ) ||
-        ( enemy->s.eType == ET_BUILDABLE &&
-          BG_FindTeamForBuildable( enemy->s.modelindex ) == BIT_HUMANS ) ) && enemy->health > 0 )
+  // buildables are walked a list's worth at a time
+  after = -1;
+  do
+  {
+    num = G_BuildablesInBox( mins, maxs, after, entityList, MAX_CLIENTS );
+    for( i = 0; i < num; i++ )
     {
-      qboolean foundOldTarget = qfalse;
-
-      trap_Trace( &tr, muzzle, NULL, NULL, enemy->s.origin, ent->s.number, MASK_SHOT );
-
-      //can't see target from here
-      if( tr.entityNum == ENTITYNUM_WORLD )
-        continue;
-
-      for( j = 0; j < MAX_ZAPS; j++ )
-      {
-        zap_t *zap = &zaps[ j ];
-
-        for( k = 0; k < zap->numTargets; k++ )
-        {
-          if( zap->targets[ k ] == enemy )
-          {
-            foundOldTarget = qtrue;
-            break;
-          }
-        }
-
-        if( foundOldTarget )
-          break;
-      }
-
-      // enemy is already targetted
-      if( foundOldTarget )
-        continue;
+      enemy = entityList[ i ];
 
-      return enemy;
+      if( BG_FindTeamForBuildable( enemy->s.modelindex ) == BIT_HUMANS &&
+          G_IsNewZapTarget( ent, enemy ) )
+        return enemy;
     }
-  }
+
+    if( num )
+      after = entityList[ num - 1 ]->s.number;
+  } while( num == MAX_CLIENTS );
 
   return NULL;
 }
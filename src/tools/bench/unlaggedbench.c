@@ -0,0 +1,491 @@
+/*
+===========================================================================
+Copyright (C) 1999-2005 Id Software, Inc.
+Copyright (C) 2000-2006 Tim Angus
+
+This file is part of Tremulous.
+
+Tremulous is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the License,
+or (at your option) any later version.
+
+Tremulous is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Tremulous; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+===========================================================================
+*/
+
+// unlaggedbench.c -- replays synthetic shots through the unlagged code
+//
+// The native game module is linked into a standalone program and handed a
+// fake engine through dllEntry: linking an entity just sets its absolute
+// bounds and a trace only tests the linked client boxes. Clients run round
+// circles while shooters at varied pings fire at where a target was on
+// their screen, so most shots only hit if the rewind is right.
+//
+// The shots are fired twice from the same seed. The reference pass rewinds
+// every client for every shot, as G_UnlaggedOn always did before traces were
+// culled; the timed pass uses the same calls the weapons do. Any shot that
+// hits something different in the two is counted as a mismatch and makes
+// the program exit non-zero, so a change can be checked for both speed and
+// behaviour.
+//
+// usage: unlaggedbench [clients] [shots] [seed]
+
+#include "../../game/g_local.h"
+
+#include <time.h>
+
+// not exported by g_local.h
+extern gclient_t  g_clients[ MAX_CLIENTS ];
+void dllEntry( intptr_t (QDECL *syscallptr)( intptr_t arg,... ) );
+
+#define BENCH_FRAME_MSEC  50
+#define BENCH_VIEWHEIGHT  26
+#define BENCH_JITTER      24.0f
+
+static const int benchPings[ ] = { 0, 30, 80, 120, 180, 250, 350, 500 };
+#define BENCH_NUM_PINGS   ( sizeof( benchPings ) / sizeof( benchPings[ 0 ] ) )
+
+typedef struct
+{
+  vec2_t  center;
+  float   radius;
+  float   speed;    // radians per second
+  float   phase;
+} benchPath_t;
+
+static benchPath_t  benchPaths[ MAX_CLIENTS ];
+static unsigned int benchSeed;
+
+/*
+===============
+BenchRand
+
+Deterministic so runs with the same seed fire the same shots
+===============
+*/
+static unsigned int BenchRand( void )
+{
+  benchSeed = benchSeed * 1103515245 + 12345;
+  return ( benchSeed >> 16 ) & 0x7fff;
+}
+
+static float BenchRandom( void )
+{
+  return (float)BenchRand( ) / 0x7fff;
+}
+
+static float BenchCrandom( void )
+{
+  return 2.0f * ( BenchRandom( ) - 0.5f );
+}
+
+/*
+===============
+BenchNanoseconds
+===============
+*/
+static long long BenchNanoseconds( void )
+{
+  struct timespec ts;
+
+  clock_gettime( CLOCK_MONOTONIC, &ts );
+  return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/*
+===============
+BenchLinkEntity
+
+What SV_LinkEntity does to the bounds of an unrotated entity
+===============
+*/
+static void BenchLinkEntity( gentity_t *ent )
+{
+  int i;
+
+  for( i = 0; i < 3; i++ )
+  {
+    ent->r.absmin[ i ] = ent->r.currentOrigin[ i ] + ent->r.mins[ i ] - 1;
+    ent->r.absmax[ i ] = ent->r.currentOrigin[ i ] + ent->r.maxs[ i ] + 1;
+  }
+
+  ent->r.linked = qtrue;
+  ent->r.linkcount++;
+}
+
+/*
+===============
+BenchTrace
+
+Sweep a box against the linked clients. There is no world to hit.
+===============
+*/
+static void BenchTrace( trace_t *results, const float *start, const float *mins,
+                        const float *maxs, const float *end, int passEntityNum,
+                        int contentmask )
+{
+  int       i, j;
+  gentity_t *ent;
+  vec3_t    dir;
+  float     best = 1.0f;
+  float     enter, leave, lo, hi, t0, t1;
+
+  memset( results, 0, sizeof( *results ) );
+  results->entityNum = ENTITYNUM_NONE;
+  VectorSubtract( end, start, dir );
+
+  for( i = 0, ent = g_entities; i < level.maxclients; i++, ent++ )
+  {
+    if( !ent->r.linked || i == passEntityNum || !( ent->r.contents & contentmask ) )
+      continue;
+
+    // slab test against the client box grown by the trace box
+    enter = 0.0f;
+    leave = best;
+    for( j = 0; j < 3 && enter <= leave; j++ )
+    {
+      lo = ent->r.currentOrigin[ j ] + ent->r.mins[ j ] - ( maxs ? maxs[ j ] : 0.0f );
+      hi = ent->r.currentOrigin[ j ] + ent->r.maxs[ j ] - ( mins ? mins[ j ] : 0.0f );
+
+      if( dir[ j ] == 0.0f )
+      {
+        if( start[ j ] < lo || start[ j ] > hi )
+          leave = -1.0f;
+        continue;
+      }
+
+      t0 = ( lo - start[ j ] ) / dir[ j ];
+      t1 = ( hi - start[ j ] ) / dir[ j ];
+      if( t0 > t1 )
+      {
+        float t = t0;
+        t0 = t1;
+        t1 = t;
+      }
+
+      if( t0 > enter )
+        enter = t0;
+      if( t1 < leave )
+        leave = t1;
+    }
+
+    if( enter <= leave && enter < best )
+    {
+      best = enter;
+      results->entityNum = i;
+      results->contents = ent->r.contents;
+    }
+  }
+
+  results->fraction = best;
+  VectorMA( start, best, dir, results->endpos );
+}
+
+/*
+===============
+BenchSyscall
+
+The engine side of the trap_* calls the unlagged code makes
+===============
+*/
+static intptr_t QDECL BenchSyscall( intptr_t arg, ... )
+{
+  va_list   ap;
+  intptr_t  args[ 7 ];
+  int       i;
+
+  va_start( ap, arg );
+
+  switch( arg )
+  {
+    case G_PRINT:
+      fputs( (const char *)va_arg( ap, intptr_t ), stdout );
+      break;
+
+    case G_ERROR:
+      fprintf( stderr, "%s", (const char *)va_arg( ap, intptr_t ) );
+      exit( 1 );
+
+    case G_MILLISECONDS:
+      va_end( ap );
+      return (intptr_t)( BenchNanoseconds( ) / 1000000 );
+
+    case G_LINKENTITY:
+      BenchLinkEntity( (gentity_t *)va_arg( ap, intptr_t ) );
+      break;
+
+    case G_UNLINKENTITY:
+      ( (gentity_t *)va_arg( ap, intptr_t ) )->r.linked = qfalse;
+      break;
+
+    case G_TRACE:
+    case G_TRACECAPSULE:
+      for( i = 0; i < 7; i++ )
+        args[ i ] = va_arg( ap, intptr_t );
+
+      BenchTrace( (trace_t *)args[ 0 ], (const float *)args[ 1 ],
+                  (const float *)args[ 2 ], (const float *)args[ 3 ],
+                  (const float *)args[ 4 ], (int)args[ 5 ], (int)args[ 6 ] );
+      break;
+
+    default:
+      break;
+  }
+
+  va_end( ap );
+  return 0;
+}
+
+/*
+===============
+BenchPosition
+
+Where a client's path puts it at a time
+===============
+*/
+static void BenchPosition( int clientNum, int time, vec3_t origin )
+{
+  benchPath_t *path = &benchPaths[ clientNum ];
+  float       angle = path->phase + path->speed * time * 0.001f;
+
+  origin[ 0 ] = path->center[ 0 ] + path->radius * cos( angle );
+  origin[ 1 ] = path->center[ 1 ] + path->radius * sin( angle );
+  origin[ 2 ] = 0.0f;
+}
+
+/*
+===============
+BenchInit
+
+Set up just enough of level and the clients for the unlagged code
+===============
+*/
+static void BenchInit( int numClients )
+{
+  int       i;
+  gentity_t *ent;
+  gclient_t *client;
+
+  dllEntry( BenchSyscall );
+
+  memset( &level, 0, sizeof( level ) );
+  memset( g_entities, 0, sizeof( g_entities ) );
+  memset( g_clients, 0, sizeof( g_clients ) );
+
+  level.clients = g_clients;
+  level.maxclients = numClients;
+  level.num_entities = MAX_CLIENTS;
+  level.time = 1000;
+
+  g_unlagged.integer = 1;
+
+  for( i = 0; i < numClients; i++ )
+  {
+    ent = &g_entities[ i ];
+    client = &g_clients[ i ];
+
+    ent->client = client;
+    ent->inuse = qtrue;
+    ent->s.number = i;
+    ent->r.contents = CONTENTS_BODY;
+    VectorSet( ent->r.mins, -15, -15, -24 );
+    VectorSet( ent->r.maxs, 15, 15, 32 );
+
+    client->ps.clientNum = i;
+    client->pers.connected = CON_CONNECTED;
+    client->pers.useUnlagged = qtrue;
+
+    benchPaths[ i ].center[ 0 ] = BenchCrandom( ) * 1024.0f;
+    benchPaths[ i ].center[ 1 ] = BenchCrandom( ) * 1024.0f;
+    benchPaths[ i ].radius = 64.0f + BenchRandom( ) * 512.0f;
+    benchPaths[ i ].speed = 0.5f + BenchRandom( ) * 2.5f;
+    benchPaths[ i ].phase = BenchRandom( ) * 2.0f * M_PI;
+  }
+}
+
+/*
+===============
+BenchFrame
+
+Move every client along its path and store an unlagged marker
+===============
+*/
+static void BenchFrame( void )
+{
+  int       i;
+  gentity_t *ent;
+
+  level.previousTime = level.time;
+  level.time += BENCH_FRAME_MSEC;
+
+  for( i = 0, ent = g_entities; i < level.maxclients; i++, ent++ )
+  {
+    BenchPosition( i, level.time, ent->r.currentOrigin );
+    VectorCopy( ent->r.currentOrigin, ent->s.pos.trBase );
+    VectorCopy( ent->r.currentOrigin, ent->client->ps.origin );
+    trap_LinkEntity( ent );
+  }
+
+  G_UnlaggedStore( );
+}
+
+typedef struct
+{
+  int           hits;
+  unsigned int  checksum;
+  long long     calcTime;
+  long long     onTime;
+  long long     traceTime;
+  long long     offTime;
+} benchResult_t;
+
+/*
+===============
+BenchRun
+
+Fire numShots seeded shots, recording what each one hit in entityNums.  With
+reference set every client is rewound for every shot.
+===============
+*/
+static void BenchRun( int numClients, int numShots, unsigned int seed,
+                      qboolean reference, int *entityNums, benchResult_t *result )
+{
+  int         shot;
+  int         shooter, target, viewTime;
+  long long   t0, t1, t2, t3, t4;
+  vec3_t      muzzle, aim, dir, end;
+  gentity_t   *attacker;
+  trace_t     tr;
+
+  memset( result, 0, sizeof( *result ) );
+  benchSeed = seed;
+
+  BenchInit( numClients );
+
+  for( shot = 0; shot < MAX_UNLAGGED_MARKERS; shot++ )
+    BenchFrame( );
+
+  for( shot = 0; shot < numShots; shot++ )
+  {
+    // a few shots from every client each frame
+    if( shot % numClients == 0 )
+      BenchFrame( );
+
+    shooter = shot % numClients;
+    target = ( shooter + 1 + BenchRand( ) % ( numClients - 1 ) ) % numClients;
+    attacker = &g_entities[ shooter ];
+    viewTime = level.time - benchPings[ BenchRand( ) % BENCH_NUM_PINGS ];
+
+    // aim at the target's chest as the shooter saw it, give or take
+    VectorCopy( attacker->r.currentOrigin, muzzle );
+    muzzle[ 2 ] += BENCH_VIEWHEIGHT;
+    BenchPosition( target, viewTime, aim );
+    aim[ 0 ] += BenchCrandom( ) * BENCH_JITTER;
+    aim[ 1 ] += BenchCrandom( ) * BENCH_JITTER;
+    aim[ 2 ] += 16.0f + BenchCrandom( ) * BENCH_JITTER;
+    VectorSubtract( aim, muzzle, dir );
+    VectorNormalize( dir );
+    VectorMA( muzzle, 8192 * 16, dir, end );
+
+    t0 = BenchNanoseconds( );
+    G_UnlaggedCalc( viewTime, attacker );
+    t1 = BenchNanoseconds( );
+
+    // one in eight shots takes the range sphere path, like the shotgun
+    if( reference || shot % 8 == 7 )
+      G_UnlaggedOn( attacker, muzzle, 8192 * 16 );
+    else
+      G_UnlaggedOnTrace( attacker, muzzle, end, 0.0f );
+    t2 = BenchNanoseconds( );
+
+    trap_Trace( &tr, muzzle, NULL, NULL, end, shooter, MASK_SHOT );
+    t3 = BenchNanoseconds( );
+
+    G_UnlaggedOff( );
+    t4 = BenchNanoseconds( );
+
+    result->calcTime += t1 - t0;
+    result->onTime += t2 - t1;
+    result->traceTime += t3 - t2;
+    result->offTime += t4 - t3;
+
+    if( tr.entityNum != ENTITYNUM_NONE )
+      result->hits++;
+
+    result->checksum = result->checksum * 31 + tr.entityNum;
+    entityNums[ shot ] = tr.entityNum;
+  }
+}
+
+int main( int argc, char **argv )
+{
+  int           numClients = 24;
+  int           numShots = 200000;
+  unsigned int  seed;
+  int           shot, mismatches = 0;
+  int           *refNums, *entityNums;
+  benchResult_t ref, res;
+
+  if( argc > 1 )
+    numClients = atoi( argv[ 1 ] );
+  if( argc > 2 )
+    numShots = atoi( argv[ 2 ] );
+  seed = ( argc > 3 ) ? atoi( argv[ 3 ] ) : 1;
+
+  if( numClients < 2 || numClients > MAX_CLIENTS || numShots < 1 )
+  {
+    fprintf( stderr, "usage: %s [clients 2-%d] [shots] [seed]\n", argv[ 0 ], MAX_CLIENTS );
+    return 1;
+  }
+
+  refNums = malloc( numShots * sizeof( int ) );
+  entityNums = malloc( numShots * sizeof( int ) );
+  if( !refNums || !entityNums )
+  {
+    fprintf( stderr, "out of memory\n" );
+    return 1;
+  }
+
+  printf( "unlaggedbench: %d clients, %d shots, seed %u\n",
+          numClients, numShots, seed );
+
+  BenchRun( numClients, numShots, seed, qtrue, refNums, &ref );
+  BenchRun( numClients, numShots, seed, qfalse, entityNums, &res );
+
+  for( shot = 0; shot < numShots; shot++ )
+  {
+    if( entityNums[ shot ] != refNums[ shot ] )
+      mismatches++;
+  }
+
+  printf( "hits:     %d of %d (%.1f%%), reference %d\n", res.hits, numShots,
+          100.0f * res.hits / numShots, ref.hits );
+  printf( "checksum: %08x, reference %08x\n", res.checksum, ref.checksum );
+  printf( "calc:     %6.1f ns/shot\n", (double)res.calcTime / numShots );
+  printf( "on:       %6.1f ns/shot, reference %.1f\n",
+          (double)res.onTime / numShots, (double)ref.onTime / numShots );
+  printf( "off:      %6.1f ns/shot, reference %.1f\n",
+          (double)res.offTime / numShots, (double)ref.offTime / numShots );
+  printf( "trace:    %6.1f ns/shot (fake engine, not unlagged)\n",
+          (double)res.traceTime / numShots );
+  printf( "unlagged: %6.1f ns/shot, reference %.1f\n",
+          (double)( res.calcTime + res.onTime + res.offTime ) / numShots,
+          (double)( ref.calcTime + ref.onTime + ref.offTime ) / numShots );
+  printf( "relinks:  %.2f per shot, %.2f clients lerped per shot\n",
+          (double)level.unlagged.relinks / numShots,
+          (double)level.unlagged.lerps / numShots );
+  printf( "mismatches: %d\n", mismatches );
+
+  free( refNums );
+  free( entityNums );
+
+  return mismatches ? 1 : 0;
+}